@@ -0,0 +1,286 @@
+/**
+ * @file AdParserCheck.cpp
+ * @brief Fuzz-Test und Benchmark für parseAdStructures()
+ */
+
+#include "AdParserCheck.h"
+#include <BLEAdvertisedDevice.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "AdvertisementParser.h"
+#include "AllocCounter.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    uint64_t xorshift64(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // =================== Referenz: eine Suche pro Feld ===================
+
+    struct RefField {
+        const uint8_t* data;
+        size_t length;
+        uint8_t type;
+    };
+
+    // Erste Struktur, deren Typ zu types passt und die minLength Datenbytes hat
+    template <typename Match>
+    RefField refFirst(const uint8_t* payload, size_t length, Match match) {
+        size_t pos = 0;
+        while (pos < length) {
+            uint8_t fieldLength = payload[pos];
+            if (fieldLength == 0 || pos + 1 + fieldLength > length) break;
+            uint8_t type = payload[pos + 1];
+            if (match(type, (size_t)(fieldLength - 1))) {
+                return RefField{payload + pos + 2, (size_t)(fieldLength - 1), type};
+            }
+            pos += 1 + fieldLength;
+        }
+        return RefField{nullptr, 0, 0};
+    }
+
+    uint8_t serviceDataUuidBytes(uint8_t type) {
+        return type == AD_TYPE_SERVICE_DATA16 ? 2 : (type == AD_TYPE_SERVICE_DATA32 ? 4 : 16);
+    }
+
+    bool sameView(const AdView& view, const RefField& ref) {
+        if (!ref.data) return !view.present();
+        return view.data == ref.data && view.length == ref.length;
+    }
+
+    bool inside(const AdView& view, const uint8_t* payload, size_t length) {
+        if (!view.present()) return true;
+        return view.data >= payload && view.data + view.length <= payload + length;
+    }
+
+    // Liefert eine Beschreibung der ersten Abweichung oder nullptr
+    const char* compareWithReference(const uint8_t* payload, size_t length) {
+        AdFields ad;
+        bool ok = parseAdStructures(payload, length, ad);
+
+        // Strukturen zählen und fehlerhaftes Ende erkennen
+        size_t pos = 0;
+        int structures = 0;
+        bool malformed = false;
+        while (pos < length) {
+            uint8_t fieldLength = payload[pos];
+            if (fieldLength == 0) break;
+            if (pos + 1 + fieldLength > length) {
+                malformed = true;
+                break;
+            }
+            structures++;
+            pos += 1 + fieldLength;
+        }
+        if (ok == malformed || ad.malformed != malformed) return "malformed";
+        if (ad.structureCount != structures) return "structureCount";
+
+        const AdView* views[] = {&ad.flags, &ad.name, &ad.manufacturerData, &ad.serviceUuids16,
+                                 &ad.serviceUuids32, &ad.serviceUuids128, &ad.serviceData};
+        for (const AdView* view : views) {
+            if (!inside(*view, payload, length)) return "Sicht außerhalb des Payloads";
+        }
+
+        RefField flags = refFirst(payload, length, [](uint8_t t, size_t n) { return t == AD_TYPE_FLAGS && n >= 1; });
+        if (!sameView(ad.flags, flags)) return "flags";
+
+        RefField name = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_NAME_COMPLETE; });
+        bool complete = name.data != nullptr;
+        if (!name.data) name = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_NAME_SHORT; });
+        if (!sameView(ad.name, name) || ad.nameComplete != complete) return "name";
+
+        RefField manufacturer = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_MANUFACTURER_DATA; });
+        if (!sameView(ad.manufacturerData, manufacturer)) return "manufacturerData";
+
+        RefField uuid16 = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_UUID16_INCOMPLETE || t == AD_TYPE_UUID16_COMPLETE; });
+        RefField uuid32 = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_UUID32_INCOMPLETE || t == AD_TYPE_UUID32_COMPLETE; });
+        RefField uuid128 = refFirst(payload, length, [](uint8_t t, size_t) { return t == AD_TYPE_UUID128_INCOMPLETE || t == AD_TYPE_UUID128_COMPLETE; });
+        if (!sameView(ad.serviceUuids16, uuid16) || !sameView(ad.serviceUuids32, uuid32) ||
+            !sameView(ad.serviceUuids128, uuid128)) {
+            return "serviceUuids";
+        }
+
+        RefField serviceData = refFirst(payload, length, [](uint8_t t, size_t n) {
+            return (t == AD_TYPE_SERVICE_DATA16 || t == AD_TYPE_SERVICE_DATA32 || t == AD_TYPE_SERVICE_DATA128) &&
+                   n >= serviceDataUuidBytes(t);
+        });
+        if (!sameView(ad.serviceData, serviceData)) return "serviceData";
+        if (serviceData.data && ad.serviceDataUuidBytes != serviceDataUuidBytes(serviceData.type)) return "serviceDataUuidBytes";
+
+        RefField tx = refFirst(payload, length, [](uint8_t t, size_t n) { return t == AD_TYPE_TX_POWER && n >= 1; });
+        if (ad.haveTxPower != (tx.data != nullptr) || (tx.data && ad.txPower != (int8_t)tx.data[0])) return "txPower";
+
+        RefField appearance = refFirst(payload, length, [](uint8_t t, size_t n) { return t == AD_TYPE_APPEARANCE && n >= 2; });
+        if (ad.haveAppearance != (appearance.data != nullptr) ||
+            (appearance.data && ad.appearance != (uint16_t)(appearance.data[0] | (appearance.data[1] << 8)))) {
+            return "appearance";
+        }
+        return nullptr;
+    }
+
+    // =================== Eingaben ===================
+
+    size_t randomPayload(uint64_t& state, uint8_t* out) {
+        size_t length = xorshift64(state) % (TRACE_MAX_PAYLOAD + 1);
+        for (size_t i = 0; i < length; i++) out[i] = (uint8_t)xorshift64(state);
+        return length;
+    }
+
+    size_t structuredPayload(uint64_t& state, uint8_t* out) {
+        // Gültige Strukturen der ausgewerteten Typen; die letzte darf über das Ende reichen
+        static const uint8_t types[] = {
+            AD_TYPE_FLAGS, AD_TYPE_UUID16_INCOMPLETE, AD_TYPE_UUID16_COMPLETE, AD_TYPE_UUID32_INCOMPLETE,
+            AD_TYPE_UUID32_COMPLETE, AD_TYPE_UUID128_INCOMPLETE, AD_TYPE_UUID128_COMPLETE, AD_TYPE_NAME_SHORT,
+            AD_TYPE_NAME_COMPLETE, AD_TYPE_TX_POWER, AD_TYPE_SERVICE_DATA16, AD_TYPE_APPEARANCE,
+            AD_TYPE_SERVICE_DATA32, AD_TYPE_SERVICE_DATA128, AD_TYPE_MANUFACTURER_DATA, 0x24, 0x2A};
+        size_t limit = 1 + xorshift64(state) % TRACE_MAX_PAYLOAD;
+        size_t pos = 0;
+        while (pos < limit) {
+            uint8_t dataLength = (uint8_t)(xorshift64(state) % 20);
+            uint8_t type = types[xorshift64(state) % sizeof(types)];
+            out[pos++] = (uint8_t)(dataLength + 1);
+            if (pos < limit) out[pos++] = type;
+            for (uint8_t i = 0; i < dataLength && pos < limit; i++) out[pos++] = (uint8_t)xorshift64(state);
+        }
+        // Gelegentlich Auffüllung mit Nullen wie im Advertising-PDU
+        if ((xorshift64(state) & 7) == 0 && pos < TRACE_MAX_PAYLOAD) {
+            size_t pad = xorshift64(state) % (TRACE_MAX_PAYLOAD - pos + 1);
+            memset(out + pos, 0, pad);
+            pos += pad;
+        }
+        return pos;
+    }
+
+    size_t mutatedPayload(uint64_t& state, const Trace& trace, uint8_t* out) {
+        const TraceEvent& event = trace.events[xorshift64(state) % trace.events.size()];
+        size_t length = event.payloadLen;
+        memcpy(out, event.payload, length);
+        int mutations = 1 + (int)(xorshift64(state) % 4);
+        for (int m = 0; m < mutations && length > 0; m++) {
+            size_t at = xorshift64(state) % length;
+            switch (xorshift64(state) % 4) {
+                case 0: out[at] ^= (uint8_t)(1u << (xorshift64(state) % 8)); break;  // Bit kippen
+                case 1: out[at] = (uint8_t)xorshift64(state); break;                // Byte ersetzen
+                case 2: out[at] = (uint8_t)(out[at] + 1); break;                    // Länge um eins daneben
+                default: length = at; break;                                       // abschneiden
+            }
+        }
+        return length;
+    }
+}
+
+bool fuzzAdParser(uint32_t iterations, uint64_t seed, const Trace* seeds) {
+    uint64_t state = seed ? seed : 1;
+    uint8_t scratch[TRACE_MAX_PAYLOAD];
+    uint32_t failures = 0, malformed = 0;
+    uint32_t perKind[3] = {0, 0, 0};
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        int kind = (int)(xorshift64(state) % 3);
+        if (kind == 2 && (!seeds || seeds->events.empty())) kind = 1;
+        size_t length = kind == 0 ? randomPayload(state, scratch)
+                      : kind == 1 ? structuredPayload(state, scratch)
+                                  : mutatedPayload(state, *seeds, scratch);
+        perKind[kind]++;
+
+        // Exakt großer Block: jeder Zugriff hinter dem Ende trifft die Redzone
+        std::unique_ptr<uint8_t[]> payload(new uint8_t[length ? length : 1]);
+        memcpy(payload.get(), scratch, length);
+        const char* mismatch = compareWithReference(payload.get(), length);
+
+        AdFields ad;
+        if (!parseAdStructures(payload.get(), length, ad)) malformed++;
+        if (mismatch) {
+            if (failures < 5) {
+                printf("Abweichung bei %s, Payload:", mismatch);
+                for (size_t b = 0; b < length; b++) printf(" %02x", payload[b]);
+                printf("\n");
+            }
+            failures++;
+        }
+    }
+    AdFields empty;
+    if (!parseAdStructures(nullptr, 0, empty) || empty.structureCount != 0) failures++;
+
+    printf("fuzz:                  %u Payloads (%u zufällig, %u strukturiert, %u mutiert), %u fehlerhaft endend, %u Abweichungen\n",
+           iterations, perKind[0], perKind[1], perKind[2], malformed, failures);
+    return failures == 0;
+}
+
+void benchAdParser(const Trace& trace) {
+    if (trace.events.empty()) return;
+    const size_t rounds = std::max<size_t>(1, 200000 / trace.events.size());
+    const double total = (double)(rounds * trace.events.size());
+    volatile uint32_t sink = 0;
+
+    // 1) Bibliothek parst (std::string je Feld), Ingest liest über die Accessoren
+    AllocSnapshot allocStart = AllocCounter::snapshot();
+    Clock::time_point start = Clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const TraceEvent& ev : trace.events) {
+            BLEAdvertisedDevice device;
+            device.parseAdvertisement(ev.payload, ev.payloadLen);
+            uint32_t acc = 0;
+            if (device.haveName()) acc += (uint32_t)device.getName().size();
+            if (device.haveManufacturerData()) acc += (uint32_t)device.getManufacturerData().size();
+            if (device.haveServiceUUID()) acc += (uint32_t)device.getServiceUUIDCount();
+            if (device.haveServiceData()) acc += (uint32_t)device.getServiceData().size();
+            if (device.haveTXPower()) acc += (uint32_t)device.getTXPower();
+            if (device.haveAppearance()) acc += device.getAppearance();
+            sink = sink + acc;
+        }
+    }
+    double accessorNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / total;
+    double accessorAllocs = (AllocCounter::snapshot().count - allocStart.count) / total;
+
+    // 2) Eine Suche pro Feld über den Roh-Payload (bisheriger Ingest-Pfad)
+    static const uint8_t lookups[] = {
+        AD_TYPE_NAME_COMPLETE, AD_TYPE_NAME_SHORT,
+        AD_TYPE_UUID16_INCOMPLETE, AD_TYPE_UUID16_COMPLETE, AD_TYPE_UUID32_INCOMPLETE,
+        AD_TYPE_UUID32_COMPLETE, AD_TYPE_UUID128_INCOMPLETE, AD_TYPE_UUID128_COMPLETE,
+        AD_TYPE_MANUFACTURER_DATA, AD_TYPE_SERVICE_DATA16, AD_TYPE_SERVICE_DATA32, AD_TYPE_SERVICE_DATA128,
+        AD_TYPE_TX_POWER, AD_TYPE_APPEARANCE};
+    allocStart = AllocCounter::snapshot();
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const TraceEvent& ev : trace.events) {
+            uint32_t acc = 0;
+            for (uint8_t type : lookups) {
+                RefField field = refFirst(ev.payload, ev.payloadLen, [type](uint8_t t, size_t) { return t == type; });
+                if (field.data) acc += (uint32_t)field.length;
+            }
+            sink = sink + acc;
+        }
+    }
+    double lookupNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / total;
+    double lookupAllocs = (AllocCounter::snapshot().count - allocStart.count) / total;
+
+    // 3) Ein Durchlauf, nur Sichten
+    allocStart = AllocCounter::snapshot();
+    start = Clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const TraceEvent& ev : trace.events) {
+            AdFields ad;
+            parseAdStructures(ev.payload, ev.payloadLen, ad);
+            sink = sink + ad.name.length + ad.manufacturerData.length + ad.serviceData.length +
+                   (uint32_t)ad.hasServiceUuids() + (uint32_t)ad.txPower + ad.appearance;
+        }
+    }
+    double parserNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / total;
+    double parserAllocs = (AllocCounter::snapshot().count - allocStart.count) / total;
+
+    printf("%-22s %12s %12s\n", "pfad", "ns/advert", "allocs");
+    printf("%-22s %12.1f %12.2f\n", "accessor (string)", accessorNs, accessorAllocs);
+    printf("%-22s %12.1f %12.2f\n", "findAdField x14", lookupNs, lookupAllocs);
+    printf("%-22s %12.1f %12.2f\n", "parseAdStructures", parserNs, parserAllocs);
+    (void)sink;
+}
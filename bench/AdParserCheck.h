@@ -0,0 +1,25 @@
+/**
+ * @file AdParserCheck.h
+ * @brief Fuzz-Test und Benchmark für parseAdStructures()
+ *
+ * Der Fuzz-Test vergleicht den Ein-Durchlauf-Parser mit einer naiven
+ * Referenz (eine Suche pro Feld) auf zufälligen, strukturierten und
+ * mutierten Payloads und prüft, dass jede Sicht im Payload liegt. Jeder
+ * Payload liegt in einem exakt großen Heap-Block, damit ein Build mit
+ * -DBENCH_SANITIZE=ON jeden Lesezugriff hinter dem Ende meldet.
+ *
+ * Der Benchmark misst auf den Payloads eines Traces drei Wege: die
+ * Accessoren von BLEAdvertisedDevice (Parsen mit std::string-Kopien),
+ * eine Suche pro Feld und den Parser.
+ */
+
+#ifndef AD_PARSER_CHECK_H
+#define AD_PARSER_CHECK_H
+
+#include <cstdint>
+#include "Trace.h"
+
+bool fuzzAdParser(uint32_t iterations, uint64_t seed, const Trace* seeds);
+void benchAdParser(const Trace& trace);
+
+#endif // AD_PARSER_CHECK_H
@@ -0,0 +1,75 @@
+/**
+ * @file AllocCounter.cpp
+ * @brief Globale operator new/delete mit Zählern
+ *
+ * Jede Allokation trägt einen kleinen Header mit ihrer Größe, damit
+ * auch die aktuell belegte Menge (liveBytes) verfolgt werden kann.
+ */
+
+#include "AllocCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocCount(0);
+    std::atomic<uint64_t> allocBytes(0);
+    std::atomic<uint64_t> live(0);
+    std::atomic<uint64_t> peak(0);
+
+    const size_t HEADER = alignof(std::max_align_t);
+
+    void* countedAlloc(size_t size) {
+        void* raw = malloc(size + HEADER);
+        if (!raw) throw std::bad_alloc();
+        *(size_t*)raw = size;
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+        uint64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t prev = peak.load(std::memory_order_relaxed);
+        while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {
+        }
+        return (char*)raw + HEADER;
+    }
+
+    void countedFree(void* ptr) {
+        if (!ptr) return;
+        void* raw = (char*)ptr - HEADER;
+        live.fetch_sub(*(size_t*)raw, std::memory_order_relaxed);
+        free(raw);
+    }
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+AllocSnapshot AllocCounter::snapshot() {
+    AllocSnapshot s;
+    s.count = allocCount.load(std::memory_order_relaxed);
+    s.bytes = allocBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+uint64_t AllocCounter::liveBytes() {
+    return live.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocCounter::peakLiveBytes() {
+    return peak.load(std::memory_order_relaxed);
+}
+
+void AllocCounter::resetPeak() {
+    peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
@@ -0,0 +1,28 @@
+/**
+ * @file AllocCounter.h
+ * @brief Zählt Heap-Allokationen des Benchmark-Prozesses
+ *
+ * Ersetzt die globalen operator new/delete. Auf dem ESP32 gehen
+ * String- und std::string-Puffer ebenfalls über den Heap, daher
+ * ist die Anzahl hier direkt mit der Fragmentierung dort vergleichbar.
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct AllocSnapshot {
+    uint64_t count;   // Anzahl new-Aufrufe
+    uint64_t bytes;   // Summe der angeforderten Bytes
+};
+
+namespace AllocCounter {
+    AllocSnapshot snapshot();
+    uint64_t liveBytes();      // aktuell belegt (new - delete)
+    uint64_t peakLiveBytes();  // Höchststand seit resetPeak()
+    void resetPeak();
+}
+
+#endif // ALLOC_COUNTER_H
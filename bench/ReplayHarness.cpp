@@ -0,0 +1,528 @@
+/**
+ * @file ReplayHarness.cpp
+ * @brief Replay-Treiber für den Host-Benchmark
+ */
+
+#include "ReplayHarness.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "AllocCounter.h"
+#include "BluetoothScanner.h"
+#include "DeviceManager.h"
+#include "PresenceRelay.h"
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // Zustand des laufenden Replays für die Callback-Probe
+    struct ProbeState {
+        std::vector<uint32_t> samples;
+        Clock::time_point start;
+        AllocSnapshot allocStart;
+        uint64_t nanos;
+        uint64_t allocs;
+        uint64_t allocBytes;
+        uint64_t copyAllocs;
+        uint64_t copyAllocBytes;
+    };
+
+    ProbeState probe;
+
+    void callbackProbe(HostProbePhase phase, bool enter) {
+        if (enter) {
+            probe.allocStart = AllocCounter::snapshot();
+            probe.start = Clock::now();
+            return;
+        }
+        Clock::time_point end = Clock::now();
+        AllocSnapshot allocEnd = AllocCounter::snapshot();
+        if (phase == HOST_PROBE_COPY) {
+            probe.copyAllocs += allocEnd.count - probe.allocStart.count;
+            probe.copyAllocBytes += allocEnd.bytes - probe.allocStart.bytes;
+            return;
+        }
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - probe.start).count();
+        probe.nanos += ns;
+        probe.allocs += allocEnd.count - probe.allocStart.count;
+        probe.allocBytes += allocEnd.bytes - probe.allocStart.bytes;
+        probe.samples.push_back((uint32_t)std::min<uint64_t>(ns, UINT32_MAX));
+    }
+
+    // Ersatz für den Relais-Task aus main_modular.cpp: eigener Thread, per Wecker angestoßen
+    struct RelayWorker {
+        PresenceRelay relay;
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool pending = false;
+        bool busy = false;
+        bool stop = false;
+        std::thread thread;
+
+        void start() {
+            thread = std::thread([this]() {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (true) {
+                    changed.wait(lock, [this]() { return pending || stop; });
+                    if (stop) break;
+                    pending = false;
+                    busy = true;
+                    lock.unlock();
+                    relay.process();
+                    lock.lock();
+                    busy = false;
+                    changed.notify_all();
+                }
+            });
+        }
+
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            changed.notify_all();
+            thread.join();
+        }
+
+        // Wartet, bis der Thread alle Weckrufe abgearbeitet hat
+        void waitIdle() {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return !pending && !busy; });
+        }
+
+        static void wakeup(void* context) {
+            RelayWorker* worker = (RelayWorker*)context;
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+                worker->pending = true;
+            }
+            worker->changed.notify_all();
+        }
+    };
+
+    // Zustand für den PresenceListener
+    struct ListenerState {
+        ReplayResult* result;
+        PresenceRelay* relay;
+        BluetoothScanner* scanner;
+        bool level;                  // irgendein bekanntes Gerät anwesend
+        unsigned long levelChangeMs; // virtuelle Zeit des letzten Wechsels (für die Polling-Latenz)
+    };
+
+    ListenerState listener;
+
+    void presenceListener(int triggerIndex, bool fromAdvertisement, void* context) {
+        ListenerState* state = (ListenerState*)context;
+        state->result->presenceEvents++;
+        if (fromAdvertisement) {
+            state->relay->post(triggerIndex, state->scanner->getCurrentAdvertMicros());
+        }
+        bool level = triggerIndex >= 0;
+        if (level != state->level) {
+            state->level = level;
+            state->levelChangeMs = millis();
+        }
+    }
+
+    // Referenz für die inkrementell gepflegten Zähler
+    bool aggregateMatches(const DeviceManager& deviceManager) {
+        const DeviceHot* table = deviceManager.getDeviceTable();
+        int active = 0, present = 0;
+        for (int i = 0; i < deviceManager.getDeviceCount(); i++) {
+            if (table[i].isActive()) active++;
+            if (table[i].isPresent()) present++;
+        }
+        int trigger = deviceManager.getPresenceTrigger();
+        bool triggerOk = (present == 0) ? trigger < 0 : (trigger >= 0 && table[trigger].isPresent());
+        return active == deviceManager.getActiveCount() && present == deviceManager.getPresentCount() && triggerOk;
+    }
+
+    uint64_t percentile(std::vector<uint32_t>& samples, double p) {
+        if (samples.empty()) return 0;
+        size_t idx = (size_t)(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+        return samples[idx];
+    }
+
+    const int KNOWN_FILTER_PROBES = 1 << 16;
+
+    // Gerätetabelle wie in main_modular.cpp statisch angelegt
+    DeviceHot deviceTable[MAX_DEVICES];
+    DeviceCold deviceDetails[MAX_DEVICES];
+}
+
+ReplayHarness::ReplayHarness() : capacity(MAX_DEVICES), scanMode(BT_SCAN_MODE), streaming(BT_SCAN_STREAMING),
+      gapIngest(BT_GAP_INGEST), knownFilter(KNOWN_FILTER), presenceTuning(defaultPresenceTuning()) {
+}
+
+bool ReplayHarness::run(const Trace& trace, ReplayResult& result) {
+    memset(&result, 0, sizeof(result));
+    Clock::time_point wallStart = Clock::now();
+
+    // Frischer Zustand: leerer NVS, virtuelle Uhr bei 0
+    Preferences::eraseAll();
+    hostSetMillis(0);
+    memset(deviceTable, 0, sizeof(deviceTable));
+    memset(deviceDetails, 0, sizeof(deviceDetails));
+
+    DeviceManager* deviceManager = new DeviceManager();
+    deviceManager->begin(deviceTable, deviceDetails, capacity);
+
+    // Relais-Pfad wie in setup(): Ereignis aus dem Callback, Schalten im eigenen Thread
+    digitalWrite(RELAY_OUTPUT_PIN, LOW);
+    digitalWrite(LED_BUILTIN_PIN, HIGH);
+    unsigned long relayWritesBefore = hostPinWrites(RELAY_OUTPUT_PIN);
+    RelayWorker* worker = new RelayWorker();
+    worker->relay.begin(deviceManager, RELAY_OUTPUT_PIN, LED_BUILTIN_PIN);
+    worker->relay.setWakeup(RelayWorker::wakeup, worker);
+    worker->start();
+    listener = ListenerState();
+    listener.result = &result;
+    listener.relay = &worker->relay;
+    deviceManager->setPresenceListener(presenceListener, &listener);
+    deviceManager->setKnownFilter(knownFilter);
+    for (const TraceKnownDevice& known : trace.known) {
+        deviceManager->addKnownDevice(known.address.c_str(), known.comment.c_str(), known.rssiThreshold, &presenceTuning);
+    }
+
+    BluetoothScanner* scanner = new BluetoothScanner();
+    listener.scanner = scanner;
+    scanner->setScanMode(scanMode);
+    scanner->setStreaming(streaming);
+    scanner->setGapIngest(gapIngest);
+    if (!scanner->begin(deviceManager)) {
+        worker->finish();
+        delete worker;
+        delete scanner;
+        delete deviceManager;
+        return false;
+    }
+
+    BLEScan* scan = BLEDevice::getScan();
+    probe = ProbeState();
+    probe.samples.reserve(trace.events.size());
+    scan->hostSetCallbackProbe(callbackProbe);
+
+    std::vector<uint32_t> evictSamples;
+    std::vector<uint32_t> pollLatencySamples;
+    std::vector<uint32_t> consumerSamples;
+    bool outputState = false;
+    unsigned long nextLoopTick = 0;
+
+    // Entspricht einem Durchlauf von loop() im Scanner-Modus
+    // Erkennungslatenz: bekanntes Gerät sendet über seinem Grenzwert, ist aber noch nicht anwesend
+    struct Arrival {
+        std::string address;
+        int rssiThreshold;
+        bool pending;
+        unsigned long since;       // erstes Advertisement über dem Grenzwert
+        unsigned long lastHeard;   // letztes Advertisement über dem Grenzwert
+    };
+    std::map<MacKey, Arrival> arrivals;
+    for (const TraceKnownDevice& known : trace.known) {
+        MacKey key;
+        if (parseMacKey(known.address.c_str(), key)) {
+            arrivals[key] = Arrival{known.address, known.rssiThreshold, false, 0, 0};
+        }
+    }
+    std::vector<uint32_t> detectSamples;
+    int pendingArrivals = 0;
+    auto isPresent = [&](const Arrival& arrival) {
+        int idx = deviceManager->findDevice(arrival.address.c_str());
+        return idx >= 0 && deviceManager->getDeviceTable()[idx].isPresent();
+    };
+    auto checkArrivals = [&](unsigned long now) {
+        if (pendingArrivals == 0) return;
+        for (auto& entry : arrivals) {
+            Arrival& arrival = entry.second;
+            if (!arrival.pending) continue;
+            if (isPresent(arrival)) {
+                detectSamples.push_back((uint32_t)(now - arrival.since));
+                arrival.pending = false;
+                pendingArrivals--;
+            } else if (now - arrival.lastHeard > DEVICE_TIMEOUT_MS) {
+                result.missedArrivals++;
+                arrival.pending = false;
+                pendingArrivals--;
+            }
+        }
+    };
+
+    auto loopTick = [&](unsigned long now) {
+        hostSetMillis(now);
+        Clock::time_point loopStart = Clock::now();
+        scanner->performAutomaticScanCycle();
+        scanner->processPending();  // Ingest-Task wacht spätestens nach INGEST_IDLE_MS auf und bereinigt
+        result.loopNanos += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - loopStart).count();
+        checkArrivals(now);
+        bool present = deviceManager->getPresenceTrigger() >= 0;
+        if (!aggregateMatches(*deviceManager)) {
+            result.aggregateMismatches++;
+        }
+        if (present != outputState) {
+            // Bisheriger Pfad: Ausgang folgt erst beim nächsten loop()-Durchlauf
+            outputState = present;
+            result.relayTransitions++;
+            pollLatencySamples.push_back((uint32_t)(now - listener.levelChangeMs));
+        }
+        // updateLEDStatus(): Timeouts und Known-Liste über wake(), dann muss der Ausgang stimmen
+        if (worker->relay.getOutputState() != present) {
+            worker->relay.wake();
+        }
+        worker->waitIdle();
+        if (worker->relay.getOutputState() != present) {
+            result.relayMismatches++;
+        }
+    };
+
+    // Heap-Spitze nur über das Replay; eigene Messpuffer vorher reservieren
+    evictSamples.reserve(trace.events.size());
+    pollLatencySamples.reserve(trace.events.size());
+    detectSamples.reserve(trace.events.size());
+    consumerSamples.reserve(trace.events.size());
+    uint64_t heapBaseline = AllocCounter::liveBytes();
+    AllocCounter::resetPeak();
+
+    for (const TraceEvent& ev : trace.events) {
+        while (nextLoopTick <= ev.timeMs) {
+            loopTick(nextLoopTick);
+            nextLoopTick += LOOP_DELAY_MS;
+        }
+        hostSetMillis(ev.timeMs);
+        uint64_t before = probe.samples.size();
+        uint32_t evictionsBefore = deviceManager->getEvictionCount();
+        auto arrival = arrivals.find(macKeyFromBytes(ev.address));
+        if (arrival != arrivals.end() && ev.rssi >= arrival->second.rssiThreshold) {
+            if (!arrival->second.pending && !isPresent(arrival->second)) {
+                arrival->second.pending = true;
+                arrival->second.since = ev.timeMs;
+                pendingArrivals++;
+            }
+            arrival->second.lastHeard = ev.timeMs;
+        }
+        AllocSnapshot deliverAllocStart = AllocCounter::snapshot();
+        Clock::time_point injectStart = Clock::now();
+        BLEDevice::hostDeliverScanResult(ev.address, ev.rssi, ev.payload, ev.payloadLen);
+        result.ingestNanos += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - injectStart).count();
+        AllocSnapshot deliverAllocEnd = AllocCounter::snapshot();
+        result.deliverAllocs += deliverAllocEnd.count - deliverAllocStart.count;
+        result.deliverAllocBytes += deliverAllocEnd.bytes - deliverAllocStart.bytes;
+        result.peakRetainedResults = std::max<uint64_t>(result.peakRetainedResults, scan->hostRetainedResults());
+
+        // Ingest-Task läuft direkt nach dem Callback (höhere Priorität als loop())
+        AllocSnapshot consumerAllocStart = AllocCounter::snapshot();
+        Clock::time_point consumerStart = Clock::now();
+        int consumed = scanner->processPending();
+        uint64_t consumerNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - consumerStart).count();
+        if (consumed > 0) {
+            AllocSnapshot consumerAllocEnd = AllocCounter::snapshot();
+            result.consumerNanos += consumerNs;
+            result.consumerAllocs += consumerAllocEnd.count - consumerAllocStart.count;
+            consumerSamples.push_back((uint32_t)std::min<uint64_t>(consumerNs, UINT32_MAX));
+        }
+        checkArrivals(ev.timeMs);
+        worker->waitIdle();  // Relais-Task hat höhere Priorität als der Rest und läuft sofort
+        if (probe.samples.size() != before) {
+            result.peakDeviceCount = std::max(result.peakDeviceCount, deviceManager->getDeviceCount());
+            if (deviceManager->getEvictionCount() != evictionsBefore) {
+                evictSamples.push_back((uint32_t)std::min<uint64_t>(consumerNs, UINT32_MAX));
+                result.evictNanos += consumerNs;
+            }
+        }
+    }
+    loopTick(nextLoopTick);
+
+    result.heapPeakBytes = AllocCounter::peakLiveBytes() - heapBaseline;
+    scan->hostSetCallbackProbe(nullptr);
+    worker->finish();
+
+    LatencyHistogram latency = worker->relay.getLatency();
+    result.relayEventSwitches = latency.count;
+    result.relayEventP50Micros = latency.percentile(0.50f);
+    result.relayEventP99Micros = latency.percentile(0.99f);
+    result.relayEventMaxMicros = latency.maxMicros;
+    result.relayEventOverflows = worker->relay.getOverflowCount();
+    result.relayPinWrites = hostPinWrites(RELAY_OUTPUT_PIN) - relayWritesBefore;
+    result.relayPollP50Ms = percentile(pollLatencySamples, 0.50);
+    result.relayPollP99Ms = percentile(pollLatencySamples, 0.99);
+    result.relayPollMaxMs = pollLatencySamples.empty() ? 0 : *std::max_element(pollLatencySamples.begin(), pollLatencySamples.end());
+
+    result.advertsInTrace = trace.events.size();
+    result.advertsDelivered = probe.samples.size();
+    result.callbackNanos = probe.nanos;
+    result.callbackAllocs = probe.allocs;
+    result.callbackAllocBytes = probe.allocBytes;
+    result.byValueCopyAllocs = probe.copyAllocs;
+    result.byValueCopyAllocBytes = probe.copyAllocBytes;
+    result.callbackP50Nanos = percentile(probe.samples, 0.50);
+    result.callbackP99Nanos = percentile(probe.samples, 0.99);
+    result.consumerP50Nanos = percentile(consumerSamples, 0.50);
+    result.consumerP99Nanos = percentile(consumerSamples, 0.99);
+    result.ringDrops = scanner->getRingDropCount();
+    result.tableCapacity = deviceManager->getCapacity();
+    result.evictions = deviceManager->getEvictionCount();
+    result.evictP99Nanos = percentile(evictSamples, 0.99);
+    result.droppedAdverts = deviceManager->getDroppedCount();
+    result.finalDeviceCount = deviceManager->getDeviceCount();
+    result.devicesEver = deviceManager->getTotalEverSeen();
+
+    // /api/devices: Zeilen aus dem Snapshot zusammensetzen, Payload-Text entsteht erst hier
+    {
+        DeviceManager::Snapshot snapshot(*deviceManager);
+        SafeDevice entry;
+        const int passes = 100;
+        auto renderStart = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (int i = 0; i < snapshot->deviceCount; i++) deviceManager->getDevice(*snapshot, i, entry);
+        }
+        result.apiRows = (uint64_t)snapshot->deviceCount * passes;
+        result.apiRenderNanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - renderStart).count();
+    }
+    // Known-Vorfilter: Falsch-Positive über alle unbekannten Adressen des Traces, dann reine Suchzeit
+    {
+        std::set<MacKey> addresses;
+        for (const TraceEvent& ev : trace.events) addresses.insert(macKeyFromBytes(ev.address));
+        for (const auto& entry : arrivals) addresses.insert(entry.first);
+        const KnownFilter& filter = deviceManager->getKnownFilter();
+        std::vector<MacKey> keys;  // unbekannte Adressen, der Fall für den der Filter da ist
+        for (MacKey key : addresses) {
+            if (arrivals.count(key) == 0) {
+                keys.push_back(key);
+                if (filter.mayContain(key)) result.knownFilterPasses++;
+            } else if (!filter.mayContain(key)) {
+                result.knownFilterMisses++;
+            }
+        }
+        result.unknownAddresses = keys.size();
+        // Der Trace hat nur wenige hundert Adressen; feste Zufallsadressen geben eine stabile Rate
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (int i = 0; i < KNOWN_FILTER_PROBES; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            MacKey key = state & 0xFFFFFFFFFFFFULL;
+            if (arrivals.count(key) == 0 && filter.mayContain(key)) result.knownFilterProbePasses++;
+        }
+        const int passes = keys.empty() ? 0 : (int)std::max<size_t>(1, 200000 / keys.size());
+        volatile int sink = 0;
+        auto lookupStart = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            for (MacKey key : keys) sink = sink + deviceManager->findKnown(key);
+        }
+        result.knownLookupNanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - lookupStart).count();
+        result.knownLookups = (uint64_t)keys.size() * passes;
+        result.knownFilter = deviceManager->isKnownFilter();
+        result.knownFilterBytes = filter.sizeBytes();
+    }
+    result.scanMode = scanner->getScanMode();
+    result.streaming = scanner->isStreaming();
+    result.gapIngest = scanner->isGapIngest();
+    result.traceDurationMs = trace.durationMs();
+    result.detections = (int)detectSamples.size();
+    result.detectP50Ms = percentile(detectSamples, 0.50);
+    result.detectP99Ms = percentile(detectSamples, 0.99);
+    result.detectMaxMs = detectSamples.empty() ? 0 : *std::max_element(detectSamples.begin(), detectSamples.end());
+
+    scanner->end();
+    delete scanner;
+    delete deviceManager;
+    delete worker;
+
+    result.wallNanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - wallStart).count();
+    return true;
+}
+
+void ReplayHarness::printResult(const char* title, const ReplayResult& r) {
+    double delivered = r.advertsDelivered > 0 ? (double)r.advertsDelivered : 1.0;
+    printf("== %s ==\n", title);
+    printf("adverts_in_trace:      %llu\n", (unsigned long long)r.advertsInTrace);
+    printf("adverts_delivered:     %llu\n", (unsigned long long)r.advertsDelivered);
+    printf("ns_per_advert:         %.0f (p50 %llu, p99 %llu)\n", r.callbackNanos / delivered,
+           (unsigned long long)r.callbackP50Nanos, (unsigned long long)r.callbackP99Nanos);
+    printf("allocs_per_advert:     %.2f (%.0f Bytes)\n", r.callbackAllocs / delivered, r.callbackAllocBytes / delivered);
+    printf("ingest_ns_per_advert:  %.0f (p50 %llu, p99 %llu), allocs %.2f, ring_drops %u (Ingest-Task)\n",
+           r.consumerNanos / delivered, (unsigned long long)r.consumerP50Nanos, (unsigned long long)r.consumerP99Nanos,
+           r.consumerAllocs / delivered, r.ringDrops);
+    printf("byvalue_copy_allocs:   %.2f (%.0f Bytes, Übergabe an onResult)\n",
+           r.byValueCopyAllocs / delivered, r.byValueCopyAllocBytes / delivered);
+    printf("deliver_allocs:        %.2f (%.0f Bytes, GAP-Ereignis bis Ring, %s)\n", r.deliverAllocs / delivered,
+           r.deliverAllocBytes / delivered, r.gapIngest ? "GAP-Handler" : "BLEScan + onResult");
+    printf("peak_table_size:       %d / %d\n", r.peakDeviceCount, r.tableCapacity);
+    printf("table_bytes:           %zu hot + %zu cold pro Gerät, %zu gesamt (Snapshots: 2 * %zu)\n", sizeof(DeviceHot), sizeof(DeviceCold),
+           (sizeof(DeviceHot) + sizeof(DeviceCold)) * (size_t)r.tableCapacity, sizeof(DeviceSnapshot));
+    printf("final_table_size:      %d\n", r.finalDeviceCount);
+    printf("api_row_ns:            %.0f (/api/devices-Zeile inkl. Payload-Text, %llu Zeilen)\n",
+           r.apiRows > 0 ? (double)r.apiRenderNanos / r.apiRows : 0.0, (unsigned long long)r.apiRows);
+    printf("heap_peak:             %llu Bytes über dem Ausgangswert (%s, max. %llu Ergebnisse in BLEScan)\n",
+           (unsigned long long)r.heapPeakBytes, r.streaming ? "streaming" : "BLEScan sammelt",
+           (unsigned long long)r.peakRetainedResults);
+    printf("evictions:             %llu (ns_per_eviction %.0f, p99 %llu), dropped %llu\n", (unsigned long long)r.evictions,
+           r.evictions > 0 ? (double)r.evictNanos / r.evictions : 0.0, (unsigned long long)r.evictP99Nanos,
+           (unsigned long long)r.droppedAdverts);
+    printf("devices_ever:          %d\n", r.devicesEver);
+    printf("relay_transitions:     %d\n", r.relayTransitions);
+    printf("presence_events:       %d (aggregate_mismatches %d)\n", r.presenceEvents, r.aggregateMismatches);
+    printf("relay_latency_poll:    p50 %llu ms, p99 %llu ms, max %llu ms (loop()-Polling)\n",
+           (unsigned long long)r.relayPollP50Ms, (unsigned long long)r.relayPollP99Ms, (unsigned long long)r.relayPollMaxMs);
+    printf("relay_latency_event:   p50 %u us, p99 %u us, max %u us (%u von %llu Schaltungen per Ereignis, overflow %u)\n",
+           r.relayEventP50Micros, r.relayEventP99Micros, r.relayEventMaxMicros, r.relayEventSwitches,
+           (unsigned long long)r.relayPinWrites, r.relayEventOverflows);
+    printf("relay_mismatches:      %d\n", r.relayMismatches);
+    double seconds = r.traceDurationMs > 0 ? r.traceDurationMs / 1000.0 : 1.0;
+    printf("scan_mode:             %s\n", r.scanMode == SCAN_MODE_CONTINUOUS ? "continuous (passiv)" : "duty_cycle (2s/10s aktiv)");
+    printf("adverts_per_sec:       %.1f erfasst von %.1f gesendet\n", r.advertsDelivered / seconds, r.advertsInTrace / seconds);
+    printf("detect_latency:        p50 %llu ms, p99 %llu ms, max %llu ms (%d erkannt, %d verpasst)\n",
+           (unsigned long long)r.detectP50Ms, (unsigned long long)r.detectP99Ms, (unsigned long long)r.detectMaxMs,
+           r.detections, r.missedArrivals);
+    printf("cpu_load:              %.4f%% (Callback %.1f ms + Ingest %.1f ms + loop() %.1f ms über %.0f s Trace)\n",
+           cpuLoadPercent(r), r.ingestNanos / 1e6, r.consumerNanos / 1e6, r.loopNanos / 1e6, seconds);
+    printf("known_filter:          %s, %llu Bytes, %llu von %llu unbekannten Adressen passieren (%.2f%%), bekannte abgewiesen %llu\n",
+           r.knownFilter ? "an" : "aus", (unsigned long long)r.knownFilterBytes, (unsigned long long)r.knownFilterPasses,
+           (unsigned long long)r.unknownAddresses, r.unknownAddresses > 0 ? 100.0 * r.knownFilterPasses / r.unknownAddresses : 0.0,
+           (unsigned long long)r.knownFilterMisses);
+    printf("known_filter_probe:    %.3f%% falsch positiv (%d Zufallsadressen)\n",
+           100.0 * r.knownFilterProbePasses / KNOWN_FILTER_PROBES, KNOWN_FILTER_PROBES);
+    printf("known_lookup_ns:       %.1f (findKnown für die unbekannten Adressen des Traces)\n",
+           r.knownLookups > 0 ? (double)r.knownLookupNanos / r.knownLookups : 0.0);
+    printf("replay_wall_ms:        %.1f\n", r.wallNanos / 1e6);
+}
+
+void ReplayHarness::printKnownFilterComparison(const ReplayResult& f, const ReplayResult& u) {
+    double fDelivered = f.advertsDelivered > 0 ? (double)f.advertsDelivered : 1.0;
+    double uDelivered = u.advertsDelivered > 0 ? (double)u.advertsDelivered : 1.0;
+    double fLookup = f.knownLookups > 0 ? (double)f.knownLookupNanos / f.knownLookups : 0.0;
+    double uLookup = u.knownLookups > 0 ? (double)u.knownLookupNanos / u.knownLookups : 0.0;
+    printf("== Known-Vorfilter ==\n");
+    printf("%-22s %14s %14s\n", "", "ohne Filter", "mit Filter");
+    printf("%-22s %14.1f %14.1f  (%.1fx)\n", "known_lookup_ns", uLookup, fLookup, fLookup > 0 ? uLookup / fLookup : 0.0);
+    printf("%-22s %14.0f %14.0f\n", "ingest_ns_per_advert", u.consumerNanos / uDelivered, f.consumerNanos / fDelivered);
+    printf("%-22s %14s %13.3f%%\n", "false_positive_rate", "-", 100.0 * f.knownFilterProbePasses / KNOWN_FILTER_PROBES);
+}
+
+double ReplayHarness::cpuLoadPercent(const ReplayResult& r) {
+    // Nur Host-Messung des Scanner-Codes (BLE-Ersatz + Ingest + loop()), ohne Funk und Bluetooth-Stack
+    if (r.traceDurationMs == 0) return 0.0;
+    return 100.0 * (double)(r.ingestNanos + r.consumerNanos + r.loopNanos) / (r.traceDurationMs * 1e6);
+}
+
+void ReplayHarness::printScanModeComparison(const ReplayResult& d, const ReplayResult& c) {
+    double dSec = d.traceDurationMs > 0 ? d.traceDurationMs / 1000.0 : 1.0;
+    double cSec = c.traceDurationMs > 0 ? c.traceDurationMs / 1000.0 : 1.0;
+    printf("== Vergleich ==\n");
+    printf("%-22s %14s %14s\n", "", "duty_cycle", "continuous");
+    printf("%-22s %14.1f %14.1f\n", "adverts_per_sec", d.advertsDelivered / dSec, c.advertsDelivered / cSec);
+    printf("%-22s %14llu %14llu\n", "detect_p50_ms", (unsigned long long)d.detectP50Ms, (unsigned long long)c.detectP50Ms);
+    printf("%-22s %14llu %14llu\n", "detect_p99_ms", (unsigned long long)d.detectP99Ms, (unsigned long long)c.detectP99Ms);
+    printf("%-22s %14llu %14llu\n", "detect_max_ms", (unsigned long long)d.detectMaxMs, (unsigned long long)c.detectMaxMs);
+    printf("%-22s %14d %14d\n", "missed_arrivals", d.missedArrivals, c.missedArrivals);
+    printf("%-22s %14.4f %14.4f\n", "cpu_load_percent", cpuLoadPercent(d), cpuLoadPercent(c));
+    printf("%-22s %14d %14d\n", "relay_transitions", d.relayTransitions, c.relayTransitions);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file ReplayHarness.h
+ * @brief Spielt einen Advertisement-Trace durch den echten Scanner-Code
+ *
+ * Der Treiber bildet loop() aus main_modular.cpp nach: alle
+ * LOOP_DELAY_MS läuft performAutomaticScanCycle() und die
+ * Anwesenheitslogik, dazwischen werden die Advertisements des Traces
+ * wie vom Bluetooth-Stack an den GAP-Handler bzw. BLEScan geliefert.
+ * PresenceRelay läuft wie der Relais-Task in einem eigenen Thread.
+ */
+
+#ifndef REPLAY_HARNESS_H
+#define REPLAY_HARNESS_H
+
+#include <cstdint>
+#include <vector>
+#include "Config.h"
+#include "DeviceManager.h"
+#include "Trace.h"
+
+struct ReplayResult {
+    uint64_t advertsInTrace;
+    uint64_t advertsDelivered;     // tatsächlich an onResult() übergeben
+    uint64_t callbackNanos;        // Summe über alle onResult()-Aufrufe
+    uint64_t callbackP50Nanos;
+    uint64_t callbackP99Nanos;
+    uint64_t callbackAllocs;       // Heap-Allokationen innerhalb von onResult() (Ingest-Pfad)
+    uint64_t callbackAllocBytes;
+    uint64_t consumerNanos;        // Ingest-Task: Ring leeren und Tabelle aktualisieren
+    uint64_t consumerP50Nanos;
+    uint64_t consumerP99Nanos;
+    uint64_t consumerAllocs;
+    uint32_t ringDrops;            // Advertisement-Ring voll
+    uint64_t byValueCopyAllocs;    // Kopie des BLEAdvertisedDevice für onResult()
+    uint64_t byValueCopyAllocBytes;
+    uint64_t deliverAllocs;        // Heap-Allokationen vom GAP-Ereignis bis in den Ring (BLEScan-Pfad inkl. BLEAdvertisedDevice)
+    uint64_t deliverAllocBytes;
+    uint64_t evictions;            // LRU-Verdrängungen unbekannter Geräte
+    uint64_t evictNanos;           // Summe der Ingest-Zeiten mit Verdrängung
+    uint64_t evictP99Nanos;
+    uint64_t droppedAdverts;       // verworfen, weil nur bekannte Geräte in der Tabelle
+    int peakDeviceCount;           // größte Belegung der Gerätetabelle
+    int tableCapacity;
+    int finalDeviceCount;
+    uint64_t apiRows;              // für api_row_ns zusammengesetzte /api/devices-Zeilen
+    uint64_t apiRenderNanos;
+    int devicesEver;               // devices_ever aus der Status-API
+    int relayTransitions;          // Schaltvorgänge des Ausgangs
+    int presenceEvents;            // Auslöser-Wechsel direkt aus dem Ingest-Pfad
+    int aggregateMismatches;       // inkrementelle Zähler != vollständige Neuzählung
+    uint64_t relayPollP50Ms;       // Anwesenheitswechsel bis Ausgang, Schalten aus loop()
+    uint64_t relayPollP99Ms;
+    uint64_t relayPollMaxMs;
+    uint32_t relayEventSwitches;   // vom Relais-Thread per Ereignis geschaltet (mit Latenz)
+    uint32_t relayEventP50Micros;  // Advertisement bis Relais, PresenceRelay-Histogramm
+    uint32_t relayEventP99Micros;
+    uint32_t relayEventMaxMicros;
+    uint32_t relayEventOverflows;
+    uint64_t relayPinWrites;       // Pegelwechsel an RELAY_OUTPUT_PIN
+    int relayMismatches;           // Relais nach loop()-Durchlauf nicht auf dem aktuellen Stand
+    int scanMode;                  // ScanMode des Laufs
+    bool streaming;                // BLEScan behält keine Ergebnisse
+    bool gapIngest;                // eigener GAP-Handler statt BLEScan/onResult()
+    uint64_t heapPeakBytes;        // höchster Heap-Zuwachs während des Replays
+    uint64_t peakRetainedResults;  // größte Ergebnis-Map der BLE-Bibliothek
+    uint32_t traceDurationMs;
+    uint64_t ingestNanos;          // BLE-Ersatz + Callback (in den Ring legen) über alle Advertisements
+    uint64_t loopNanos;            // performAutomaticScanCycle() über alle loop()-Durchläufe
+    int detections;                // bekanntes Gerät über Grenzwert bis als anwesend erkannt
+    int missedArrivals;            // über Grenzwert gesendet, aber nie erkannt (wieder gegangen)
+    uint64_t detectP50Ms;
+    uint64_t detectP99Ms;
+    uint64_t detectMaxMs;
+    bool knownFilter;              // Bloom-Vorfilter vor der Known-Suche aktiv
+    uint64_t knownFilterBytes;
+    uint64_t unknownAddresses;     // verschiedene Adressen im Trace, die nicht bekannt sind
+    uint64_t knownFilterPasses;    // davon vom Filter durchgelassen (falsch positiv)
+    uint64_t knownFilterProbePasses;  // von festen Zufallsadressen durchgelassen
+    uint64_t knownFilterMisses;    // bekannte Adressen, die der Filter abweist (muss 0 sein)
+    uint64_t knownLookups;         // findKnown() über die unbekannten Adressen, mehrfach
+    uint64_t knownLookupNanos;
+    uint64_t wallNanos;            // Gesamtlaufzeit des Replays
+};
+
+class ReplayHarness {
+public:
+    ReplayHarness();
+
+    // Laufzeit-Kapazität der Gerätetabelle (höchstens MAX_DEVICES)
+    void setCapacity(int capacity) { this->capacity = capacity; }
+    void setScanMode(ScanMode mode) { scanMode = mode; }
+    void setStreaming(bool enabled) { streaming = enabled; }
+    void setGapIngest(bool enabled) { gapIngest = enabled; }
+    void setKnownFilter(bool enabled) { knownFilter = enabled; }
+    // Glättung/Hysterese für die bekannten Geräte des Traces (sonst Standard aus Config.h)
+    void setPresenceTuning(const PresenceTuning& tuning) { presenceTuning = tuning; }
+
+    bool run(const Trace& trace, ReplayResult& result);
+    static void printResult(const char* title, const ReplayResult& result);
+    static void printScanModeComparison(const ReplayResult& dutyCycle, const ReplayResult& continuous);
+    static void printKnownFilterComparison(const ReplayResult& filtered, const ReplayResult& unfiltered);
+    static double cpuLoadPercent(const ReplayResult& result);
+
+private:
+    int capacity;
+    ScanMode scanMode;
+    bool streaming;
+    bool gapIngest;
+    bool knownFilter;
+    PresenceTuning presenceTuning;
+};
+
+#endif // REPLAY_HARNESS_H
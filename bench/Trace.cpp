@@ -0,0 +1,403 @@
+/**
+ * @file Trace.cpp
+ * @brief Trace-Datei-Format und Generator für synthetische Umgebungen
+ */
+
+#include "Trace.h"
+#include "Config.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// =================== Datei-Format ===================
+
+namespace {
+    bool parseMac(const char* text, uint8_t out[6]) {
+        unsigned int b[6];
+        if (sscanf(text, "%2x:%2x:%2x:%2x:%2x:%2x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+        for (int i = 0; i < 6; i++) out[i] = (uint8_t)b[i];
+        return true;
+    }
+
+    int hexNibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+bool loadTrace(const char* path, Trace& trace, std::string& error) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        error = std::string("Kann Trace nicht öffnen: ") + path;
+        return false;
+    }
+
+    char line[512];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineNo++;
+        if (line[0] == '\n' || line[0] == '\0') continue;
+        if (line[0] == '#') {
+            char mac[32];
+            int threshold;
+            int consumed = 0;
+            if (sscanf(line, "# known %31s %d %n", mac, &threshold, &consumed) == 2) {
+                TraceKnownDevice known;
+                known.address = mac;
+                known.rssiThreshold = threshold;
+                known.comment = consumed > 0 ? std::string(line + consumed) : std::string();
+                while (!known.comment.empty() && (known.comment.back() == '\n' || known.comment.back() == '\r')) {
+                    known.comment.pop_back();
+                }
+                trace.known.push_back(known);
+            }
+            continue;
+        }
+
+        unsigned long timeMs;
+        char mac[32];
+        int rssi;
+        char hex[2 * TRACE_MAX_PAYLOAD + 8];
+        if (sscanf(line, "%lu %31s %d %131s", &timeMs, mac, &rssi, hex) != 4) {
+            error = "Ungültige Zeile " + std::to_string(lineNo);
+            fclose(f);
+            return false;
+        }
+
+        TraceEvent ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.timeMs = (uint32_t)timeMs;
+        ev.rssi = (int8_t)rssi;
+        if (!parseMac(mac, ev.address)) {
+            error = "Ungültige Adresse in Zeile " + std::to_string(lineNo);
+            fclose(f);
+            return false;
+        }
+        if (strcmp(hex, "-") != 0) {
+            size_t hexLen = strlen(hex);
+            if (hexLen % 2 != 0 || hexLen / 2 > TRACE_MAX_PAYLOAD) {
+                error = "Ungültiger Payload in Zeile " + std::to_string(lineNo);
+                fclose(f);
+                return false;
+            }
+            for (size_t i = 0; i < hexLen / 2; i++) {
+                int hi = hexNibble(hex[2 * i]);
+                int lo = hexNibble(hex[2 * i + 1]);
+                if (hi < 0 || lo < 0) {
+                    error = "Ungültiger Payload in Zeile " + std::to_string(lineNo);
+                    fclose(f);
+                    return false;
+                }
+                ev.payload[i] = (uint8_t)((hi << 4) | lo);
+            }
+            ev.payloadLen = (uint8_t)(hexLen / 2);
+        }
+        trace.events.push_back(ev);
+    }
+
+    fclose(f);
+    std::stable_sort(trace.events.begin(), trace.events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.timeMs < b.timeMs; });
+    return true;
+}
+
+bool saveTrace(const char* path, const Trace& trace) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "# ESP32 BT-Scanner Advertisement-Trace\n");
+    fprintf(f, "# <t_ms> <address> <rssi> <adv+scan_rsp payload hex>\n");
+    for (const TraceKnownDevice& known : trace.known) {
+        fprintf(f, "# known %s %d %s\n", known.address.c_str(), known.rssiThreshold, known.comment.c_str());
+    }
+    for (const TraceEvent& ev : trace.events) {
+        fprintf(f, "%u %02x:%02x:%02x:%02x:%02x:%02x %d ", ev.timeMs,
+                ev.address[0], ev.address[1], ev.address[2], ev.address[3], ev.address[4], ev.address[5], ev.rssi);
+        if (ev.payloadLen == 0) {
+            fputc('-', f);
+        }
+        for (int i = 0; i < ev.payloadLen; i++) {
+            fprintf(f, "%02x", ev.payload[i]);
+        }
+        fputc('\n', f);
+    }
+
+    fclose(f);
+    return true;
+}
+
+// =================== Generator ===================
+
+namespace {
+    // Deterministischer Zufallsgenerator (xorshift32), unabhängig von der Standardbibliothek
+    struct Rng {
+        uint32_t state;
+        explicit Rng(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+        uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+        float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+        int range(int lo, int hi) { return lo + (int)(next() % (uint32_t)(hi - lo + 1)); }
+        float gaussian() {
+            float u1 = uniform() + 1e-7f;
+            float u2 = uniform();
+            return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+        }
+    };
+
+    enum DeviceProfile {
+        PROFILE_IPHONE,
+        PROFILE_AIRPODS,
+        PROFILE_IBEACON,
+        PROFILE_SAMSUNG,
+        PROFILE_FAST_PAIR,
+        PROFILE_TILE,
+        PROFILE_THERMOMETER,
+        PROFILE_MICROSOFT,
+        PROFILE_BT_BEACON,
+        PROFILE_PLAIN,
+        PROFILE_COUNT
+    };
+
+    struct SimDevice {
+        uint8_t address[6];
+        DeviceProfile profile;
+        uint32_t intervalMs;
+        uint32_t startMs;
+        uint32_t endMs;
+        float baseRssi;
+        float peakRssi;      // nur für vorbeilaufende Geräte
+        bool transient;
+        uint8_t payload[TRACE_MAX_PAYLOAD];
+        uint8_t payloadLen;
+    };
+
+    void appendAd(SimDevice& d, uint8_t type, const uint8_t* data, uint8_t len) {
+        if (d.payloadLen + 2 + len > TRACE_MAX_PAYLOAD) return;
+        d.payload[d.payloadLen++] = (uint8_t)(len + 1);
+        d.payload[d.payloadLen++] = type;
+        memcpy(d.payload + d.payloadLen, data, len);
+        d.payloadLen += len;
+    }
+
+    void buildPayload(SimDevice& d, Rng& rng) {
+        uint8_t buf[32];
+        const uint8_t flags[] = { 0x1A };
+        const uint8_t flagsLe[] = { 0x06 };
+        d.payloadLen = 0;
+
+        switch (d.profile) {
+            case PROFILE_IPHONE: {
+                appendAd(d, 0x01, flags, 1);
+                uint8_t m[] = { 0x4C, 0x00, 0x10, 0x05, 0x01, 0x18, 0x00, 0x00, 0x00 };
+                for (int i = 6; i < 9; i++) m[i] = (uint8_t)rng.next();
+                appendAd(d, 0xFF, m, sizeof(m));
+                const uint8_t tx[] = { 0x0C };
+                appendAd(d, 0x0A, tx, 1);
+                break;
+            }
+            case PROFILE_AIRPODS: {
+                uint8_t m[27] = { 0x4C, 0x00, 0x07, 0x19, 0x01, 0x0E, 0x20 };
+                for (size_t i = 7; i < sizeof(m); i++) m[i] = (uint8_t)rng.next();
+                appendAd(d, 0xFF, m, sizeof(m));
+                break;
+            }
+            case PROFILE_IBEACON: {
+                appendAd(d, 0x01, flagsLe, 1);
+                uint8_t m[25] = { 0x4C, 0x00, 0x02, 0x15 };
+                for (int i = 4; i < 20; i++) m[i] = (uint8_t)(0xE2 + i);
+                m[20] = 0x00; m[21] = (uint8_t)rng.range(1, 9);
+                m[22] = 0x00; m[23] = (uint8_t)rng.range(1, 200);
+                m[24] = 0xC5;
+                appendAd(d, 0xFF, m, sizeof(m));
+                break;
+            }
+            case PROFILE_SAMSUNG: {
+                appendAd(d, 0x01, flags, 1);
+                uint8_t m[] = { 0x75, 0x00, 0x42, 0x04, 0x01, 0x80, 0x60, 0x00, 0x00, 0x00, 0x00, 0x01 };
+                for (int i = 7; i < 11; i++) m[i] = (uint8_t)rng.next();
+                appendAd(d, 0xFF, m, sizeof(m));
+                int n = snprintf((char*)buf, sizeof(buf), "Galaxy S2%d", rng.range(1, 4));
+                appendAd(d, 0x09, buf, (uint8_t)n);
+                break;
+            }
+            case PROFILE_FAST_PAIR: {
+                appendAd(d, 0x01, flagsLe, 1);
+                const uint8_t uuid[] = { 0x2C, 0xFE };
+                appendAd(d, 0x03, uuid, 2);
+                uint8_t sd[] = { 0x2C, 0xFE, 0x00, 0x00, 0x00 };
+                for (int i = 2; i < 5; i++) sd[i] = (uint8_t)rng.next();
+                appendAd(d, 0x16, sd, sizeof(sd));
+                const uint8_t tx[] = { 0xF6 };
+                appendAd(d, 0x0A, tx, 1);
+                break;
+            }
+            case PROFILE_TILE: {
+                appendAd(d, 0x01, flagsLe, 1);
+                const uint8_t uuid[] = { 0xED, 0xFE };
+                appendAd(d, 0x03, uuid, 2);
+                uint8_t sd[10] = { 0xED, 0xFE, 0x02, 0x00 };
+                for (int i = 4; i < 10; i++) sd[i] = (uint8_t)rng.next();
+                appendAd(d, 0x16, sd, sizeof(sd));
+                break;
+            }
+            case PROFILE_THERMOMETER: {
+                appendAd(d, 0x01, flagsLe, 1);
+                uint8_t sd[15] = { 0x1A, 0x18 };
+                memcpy(sd + 2, d.address, 6);
+                sd[8] = 0x00; sd[9] = (uint8_t)rng.range(180, 240);
+                sd[10] = (uint8_t)rng.range(30, 70); sd[11] = 0x5F;
+                sd[12] = 0x0B; sd[13] = 0xB8; sd[14] = 0x01;
+                appendAd(d, 0x16, sd, sizeof(sd));
+                int n = snprintf((char*)buf, sizeof(buf), "ATC_%02X%02X%02X", d.address[3], d.address[4], d.address[5]);
+                appendAd(d, 0x09, buf, (uint8_t)n);
+                break;
+            }
+            case PROFILE_MICROSOFT: {
+                uint8_t m[27] = { 0x06, 0x00, 0x01, 0x09, 0x20, 0x02 };
+                for (size_t i = 6; i < sizeof(m); i++) m[i] = (uint8_t)rng.next();
+                appendAd(d, 0xFF, m, sizeof(m));
+                break;
+            }
+            case PROFILE_BT_BEACON: {
+                appendAd(d, 0x01, flagsLe, 1);
+                int n = snprintf((char*)buf, sizeof(buf), "BT-beacon_%02X%02X", d.address[4], d.address[5]);
+                appendAd(d, 0x09, buf, (uint8_t)n);
+                break;
+            }
+            case PROFILE_PLAIN:
+            default:
+                appendAd(d, 0x01, flagsLe, 1);
+                const uint8_t appearance[] = { 0xC1, 0x03 };
+                appendAd(d, 0x19, appearance, 2);
+                break;
+        }
+    }
+
+    uint32_t profileInterval(DeviceProfile profile, Rng& rng) {
+        switch (profile) {
+            case PROFILE_IPHONE:      return (uint32_t)rng.range(180, 1100);
+            case PROFILE_AIRPODS:     return (uint32_t)rng.range(200, 400);
+            case PROFILE_IBEACON:     return (uint32_t)rng.range(100, 1000);
+            case PROFILE_SAMSUNG:     return (uint32_t)rng.range(500, 1300);
+            case PROFILE_FAST_PAIR:   return (uint32_t)rng.range(800, 1200);
+            case PROFILE_TILE:        return (uint32_t)rng.range(1800, 2200);
+            case PROFILE_THERMOMETER: return (uint32_t)rng.range(2500, 10000);
+            case PROFILE_MICROSOFT:   return (uint32_t)rng.range(900, 1100);
+            case PROFILE_BT_BEACON:   return BEACON_DEFAULT_INTERVAL_MS;
+            case PROFILE_PLAIN:
+            default:                  return (uint32_t)rng.range(1000, 5000);
+        }
+    }
+
+    void randomAddress(uint8_t out[6], Rng& rng) {
+        for (int i = 0; i < 6; i++) out[i] = (uint8_t)rng.next();
+        out[0] |= 0xC0;  // Random Static Address
+    }
+}
+
+TraceGeneratorConfig defaultGeneratorConfig() {
+    TraceGeneratorConfig config;
+    config.devices = 40;
+    config.durationSec = 120;
+    config.knownDevices = 3;
+    config.churn = 0.3f;
+    config.rssiNoiseDb = 4.0f;
+    config.seed = 1;
+    return config;
+}
+
+void generateTrace(const TraceGeneratorConfig& config, Trace& trace) {
+    Rng rng(config.seed);
+    const uint32_t durationMs = (uint32_t)config.durationSec * 1000u;
+    const float lossRate = 0.15f;           // Kollisionen / Kanalwechsel
+    const uint32_t avgTransientMs = 30000;  // Verweildauer vorbeilaufender Geräte
+
+    std::vector<SimDevice> sim;
+    int stable = (int)(config.devices * (1.0f - config.churn) + 0.5f);
+    int transients = (int)((config.devices - stable) * (float)durationMs / avgTransientMs + 0.5f);
+
+    for (int i = 0; i < stable + transients; i++) {
+        SimDevice d;
+        memset(&d, 0, sizeof(d));
+        randomAddress(d.address, rng);
+        d.transient = i >= stable;
+        d.profile = (DeviceProfile)(rng.next() % PROFILE_COUNT);
+        if (i < config.knownDevices) {
+            // Bekannte Geräte: eigene Beacons bzw. Telefone
+            d.profile = (i % 2 == 0) ? PROFILE_BT_BEACON : PROFILE_IPHONE;
+        }
+        d.intervalMs = profileInterval(d.profile, rng);
+        d.baseRssi = -55.0f - rng.uniform() * 40.0f;
+        if (d.transient) {
+            uint32_t stay = (uint32_t)(avgTransientMs * (0.3f + 1.4f * rng.uniform()));
+            d.startMs = (uint32_t)(rng.uniform() * durationMs);
+            d.endMs = std::min(durationMs, d.startMs + stay);
+            d.peakRssi = -50.0f - rng.uniform() * 25.0f;
+        } else if (i < config.knownDevices) {
+            // Bekannte Geräte kommen und gehen innerhalb des Traces
+            d.startMs = (uint32_t)(durationMs * (0.1f + 0.2f * rng.uniform()));
+            d.endMs = (uint32_t)(durationMs * (0.6f + 0.3f * rng.uniform()));
+            d.baseRssi = -62.0f - rng.uniform() * 10.0f;
+        } else {
+            d.startMs = 0;
+            d.endMs = durationMs;
+        }
+        buildPayload(d, rng);
+        sim.push_back(d);
+
+        if (i < config.knownDevices) {
+            char mac[18];
+            snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+                     d.address[0], d.address[1], d.address[2], d.address[3], d.address[4], d.address[5]);
+            TraceKnownDevice known;
+            known.address = mac;
+            known.rssiThreshold = -75;
+            known.comment = "Bekannt " + std::to_string(i + 1);
+            trace.known.push_back(known);
+        }
+    }
+
+    for (const SimDevice& d : sim) {
+        uint32_t t = d.startMs + (uint32_t)(rng.uniform() * d.intervalMs);
+        float drift = 0.0f;
+        while (t < d.endMs) {
+            if (rng.uniform() >= lossRate) {
+                float rssi;
+                if (d.transient) {
+                    // Annähern und wieder entfernen (Dreiecksprofil)
+                    float phase = (float)(t - d.startMs) / (float)(d.endMs - d.startMs);
+                    float closeness = 1.0f - fabsf(2.0f * phase - 1.0f);
+                    rssi = -98.0f + (d.peakRssi + 98.0f) * closeness;
+                } else {
+                    drift += rng.gaussian() * 0.2f;
+                    drift = std::max(-6.0f, std::min(6.0f, drift));
+                    rssi = d.baseRssi + drift;
+                }
+                rssi += rng.gaussian() * config.rssiNoiseDb;
+                rssi = std::max(-105.0f, std::min(-30.0f, rssi));
+
+                TraceEvent ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.timeMs = t;
+                memcpy(ev.address, d.address, 6);
+                ev.rssi = (int8_t)lroundf(rssi);
+                ev.payloadLen = d.payloadLen;
+                memcpy(ev.payload, d.payload, d.payloadLen);
+                trace.events.push_back(ev);
+            }
+            // BLE advDelay: 0-10 ms Zufallsversatz pro Advertising-Event
+            t += d.intervalMs + (uint32_t)rng.range(0, 10);
+        }
+    }
+
+    std::stable_sort(trace.events.begin(), trace.events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.timeMs < b.timeMs; });
+}
@@ -0,0 +1,61 @@
+/**
+ * @file Trace.h
+ * @brief Aufgezeichnete Advertisement-Traces laden, speichern und erzeugen
+ *
+ * Format (eine Zeile pro Advertisement, Zeitstempel aufsteigend):
+ *
+ *   <t_ms> <aa:bb:cc:dd:ee:ff> <rssi> <payload_hex|->
+ *
+ * Der Payload enthält Advertising- und Scan-Response-Daten hintereinander,
+ * so wie sie der BLE-Stack im Scan-Ergebnis liefert. Zeilen mit
+ * "# known <mac> <threshold> <kommentar>" legen bekannte Geräte an,
+ * alle anderen Zeilen mit '#' sind Kommentare.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define TRACE_MAX_PAYLOAD 62  // 31 Byte Advertising + 31 Byte Scan Response
+
+struct TraceEvent {
+    uint32_t timeMs;
+    uint8_t address[6];
+    int8_t rssi;
+    uint8_t payloadLen;
+    uint8_t payload[TRACE_MAX_PAYLOAD];
+};
+
+struct TraceKnownDevice {
+    std::string address;
+    int rssiThreshold;
+    std::string comment;
+};
+
+struct Trace {
+    std::vector<TraceKnownDevice> known;
+    std::vector<TraceEvent> events;
+    uint32_t durationMs() const { return events.empty() ? 0 : events.back().timeMs; }
+};
+
+/**
+ * @brief Parameter für synthetische Traces
+ */
+struct TraceGeneratorConfig {
+    int devices;           // gleichzeitig anwesende Geräte (Mittelwert)
+    int durationSec;       // Länge des Traces
+    int knownDevices;      // davon als bekannt markiert
+    float churn;           // Anteil kurzzeitig vorbeilaufender Geräte
+    float rssiNoiseDb;     // Standardabweichung des RSSI-Rauschens
+    uint32_t seed;
+};
+
+bool loadTrace(const char* path, Trace& trace, std::string& error);
+bool saveTrace(const char* path, const Trace& trace);
+void generateTrace(const TraceGeneratorConfig& config, Trace& trace);
+TraceGeneratorConfig defaultGeneratorConfig();
+
+#endif // TRACE_H
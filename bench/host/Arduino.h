@@ -0,0 +1,47 @@
+/**
+ * @file Arduino.h
+ * @brief Host-Ersatz für den Arduino-Core (nur Benchmark-Build)
+ *
+ * millis() läuft auf einer virtuellen Uhr, die der Replay-Treiber
+ * aus den Zeitstempeln des Traces setzt. GPIO-Aufrufe werden
+ * protokolliert statt ausgeführt.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "WString.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// =================== Host-Steuerung (nicht Teil der Arduino-API) ===================
+void hostSetMillis(unsigned long ms);
+void hostAdvanceMillis(unsigned long ms);
+unsigned long hostPinWrites(uint8_t pin);  // Anzahl Pegelwechsel eines Pins
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,114 @@
+/**
+ * @file BLEAdvertisedDevice.h
+ * @brief Host-Ersatz für BLEAdvertisedDevice der ESP32 BLE Arduino Bibliothek
+ *
+ * parseAdvertisement() legt wie das Original für Name, Hersteller-
+ * und Service-Daten eigene std::string Kopien an. Nur so misst der
+ * Replay-Benchmark dieselben Kopierkosten wie auf dem Gerät.
+ */
+
+#ifndef HOST_BLE_ADVERTISED_DEVICE_H
+#define HOST_BLE_ADVERTISED_DEVICE_H
+
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+typedef uint8_t esp_bd_addr_t[6];
+
+class BLEScan;
+
+/**
+ * @brief BLE-Adresse (6 Byte, Anzeige wie im Original klein geschrieben)
+ */
+class BLEAddress {
+private:
+    esp_bd_addr_t m_address;
+
+public:
+    BLEAddress();
+    explicit BLEAddress(const uint8_t* address);
+    esp_bd_addr_t* getNative() { return &m_address; }
+    bool equals(const BLEAddress& other) const;
+    std::string toString() const;
+};
+
+/**
+ * @brief UUID mit 16, 32 oder 128 Bit
+ */
+class BLEUUID {
+private:
+    uint8_t m_uuid[16];
+    uint8_t m_len;
+
+public:
+    BLEUUID() : m_uuid{0}, m_len(0) {}
+    BLEUUID(const uint8_t* data, uint8_t len);
+    uint8_t bitSize() const { return m_len * 8; }
+};
+
+class BLEAdvertisedDevice {
+private:
+    BLEAddress m_address;
+    int m_rssi;
+    uint8_t m_adFlag;
+    uint16_t m_appearance;
+    int8_t m_txPower;
+    std::string m_name;
+    std::string m_manufacturerData;
+    std::vector<BLEUUID> m_serviceUUIDs;
+    std::vector<BLEUUID> m_serviceDataUUIDs;
+    std::vector<std::string> m_serviceData;
+    std::string m_payload;
+    BLEScan* m_pScan;
+
+    bool m_haveAppearance;
+    bool m_haveManufacturerData;
+    bool m_haveName;
+    bool m_haveRSSI;
+    bool m_haveTXPower;
+
+public:
+    BLEAdvertisedDevice();
+
+    BLEAddress getAddress() { return m_address; }
+    uint16_t getAppearance() { return m_appearance; }
+    std::string getManufacturerData() { return m_manufacturerData; }
+    std::string getName() { return m_name; }
+    int getRSSI() { return m_rssi; }
+    BLEScan* getScan() { return m_pScan; }
+    std::string getServiceData(int i = 0) { return i < (int)m_serviceData.size() ? m_serviceData[i] : std::string(); }
+    int getServiceDataCount() { return (int)m_serviceData.size(); }
+    BLEUUID getServiceUUID(int i = 0) { return i < (int)m_serviceUUIDs.size() ? m_serviceUUIDs[i] : BLEUUID(); }
+    int getServiceUUIDCount() { return (int)m_serviceUUIDs.size(); }
+    int8_t getTXPower() { return m_txPower; }
+    uint8_t* getPayload() { return (uint8_t*)m_payload.data(); }
+    size_t getPayloadLength() { return m_payload.size(); }
+
+    bool haveAppearance() { return m_haveAppearance; }
+    bool haveManufacturerData() { return m_haveManufacturerData; }
+    bool haveName() { return m_haveName; }
+    bool haveRSSI() { return m_haveRSSI; }
+    bool haveServiceData() { return !m_serviceData.empty(); }
+    bool haveServiceUUID() { return !m_serviceUUIDs.empty(); }
+    bool haveTXPower() { return m_haveTXPower; }
+
+    // Im Original private (friend BLEScan), hier für den Replay-Treiber offen
+    void setAddress(BLEAddress address) { m_address = address; }
+    void setRSSI(int rssi) { m_rssi = rssi; m_haveRSSI = true; }
+    void setAdFlag(uint8_t flag) { m_adFlag = flag; }
+    void setScan(BLEScan* pScan) { m_pScan = pScan; }
+    void setPayload(const uint8_t* payload, size_t len);
+    void parseAdvertisement(const uint8_t* payload, size_t len);
+};
+
+/**
+ * @brief Callback-Schnittstelle wie im Original (Übergabe per Wert!)
+ */
+class BLEAdvertisedDeviceCallbacks {
+public:
+    virtual ~BLEAdvertisedDeviceCallbacks() {}
+    virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+#endif // HOST_BLE_ADVERTISED_DEVICE_H
@@ -0,0 +1,36 @@
+/**
+ * @file BLEDevice.h
+ * @brief Host-Ersatz für BLEDevice der ESP32 BLE Arduino Bibliothek
+ */
+
+#ifndef HOST_BLE_DEVICE_H
+#define HOST_BLE_DEVICE_H
+
+#include <string>
+#include "BLEScan.h"
+#include "esp_bt.h"
+#include "esp_gap_ble_api.h"
+
+typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+
+class BLEDevice {
+private:
+    static bool initialized;
+    static BLEScan* m_pScan;
+    static gap_event_handler m_customGapHandler;
+
+public:
+    static void init(std::string deviceName);
+    static void deinit(bool releaseMemory = false);
+    static bool getInitialized() { return initialized; }
+    static BLEScan* getScan();
+    static void setCustomGapHandler(gap_event_handler handler) { m_customGapHandler = handler; }
+
+    // =================== Host-Steuerung ===================
+    // Entspricht BLEDevice::gapEventHandler() für ein Scan-Ergebnis: der Stack füllt
+    // esp_ble_gap_cb_param_t, dann folgen der eigene GAP-Handler und BLEScan
+    static void hostDeliverScanResult(const uint8_t* bda, int rssi, const uint8_t* payload, size_t len);
+    static bool hostIsGapScanning();  // per esp_ble_gap_start_scanning() gestartet
+};
+
+#endif // HOST_BLE_DEVICE_H
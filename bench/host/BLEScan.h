@@ -0,0 +1,80 @@
+/**
+ * @file BLEScan.h
+ * @brief Host-Ersatz für BLEScan der ESP32 BLE Arduino Bibliothek
+ *
+ * hostInjectResult() entspricht dem ESP_GAP_SEARCH_INQ_RES_EVT Zweig
+ * von BLEScan::handleGAPEvent() (gestoppt: Ergebnis ignorieren), Duplikatfilter, Ergebnis-Map und
+ * Callback verhalten sich wie im Original. start() blockiert nicht,
+ * das Scan-Fenster wird über die virtuelle Uhr abgebildet. Beim passiven
+ * Scan fehlt die Scan-Response (siehe hostInjectResult()).
+ */
+
+#ifndef HOST_BLE_SCAN_H
+#define HOST_BLE_SCAN_H
+
+#include <map>
+#include <string>
+#include "BLEAdvertisedDevice.h"
+
+class BLEScan;
+
+// Passiver Scan: nur die AD-Strukturen der Advertising-PDU (erste 31 Byte). Näherung,
+// der Trace trennt Advertising-Daten und Scan-Response nicht.
+size_t hostAdvertisingPartLength(const uint8_t* payload, size_t len);
+
+// Messphasen pro Advertisement: Kopie für die Übergabe per Wert, dann onResult()
+enum HostProbePhase {
+    HOST_PROBE_COPY,
+    HOST_PROBE_CALLBACK
+};
+
+// Wird vor (enter = true) und nach (enter = false) jeder Phase gerufen
+typedef void (*HostCallbackProbe)(HostProbePhase phase, bool enter);
+
+class BLEScanResults {
+private:
+    friend BLEScan;
+    std::map<std::string, BLEAdvertisedDevice*> m_vectorAdvertisedDevices;
+
+public:
+    int getCount() { return (int)m_vectorAdvertisedDevices.size(); }
+};
+
+class BLEScan {
+private:
+    BLEAdvertisedDeviceCallbacks* m_pAdvertisedDeviceCallbacks;
+    bool m_wantDuplicates;
+    bool m_shouldParse;
+    bool m_activeScan;
+    bool m_stopped;
+    unsigned long m_endMillis;     // 0 = ohne Zeitbegrenzung
+    void (*m_scanCompleteCB)(BLEScanResults);
+    BLEScanResults m_scanResults;
+    HostCallbackProbe m_probe;
+
+    void finishIfExpired();
+
+public:
+    BLEScan();
+
+    void setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* pCallbacks, bool wantDuplicates = false, bool shouldParse = true);
+    void setActiveScan(bool active) { m_activeScan = active; }
+    void setInterval(uint16_t intervalMSecs) { (void)intervalMSecs; }
+    void setWindow(uint16_t windowMSecs) { (void)windowMSecs; }
+
+    bool start(uint32_t duration, void (*scanCompleteCB)(BLEScanResults), bool is_continue = false);
+    BLEScanResults start(uint32_t duration, bool is_continue = false);
+    void stop();
+    void clearResults();
+    BLEScanResults getResults() { return m_scanResults; }
+
+    // =================== Host-Steuerung ===================
+    bool hostIsScanning();
+    bool hostIsActiveScan() const { return m_activeScan; }
+    size_t hostRetainedResults() const { return m_scanResults.m_vectorAdvertisedDevices.size(); }
+    void hostSetCallbackProbe(HostCallbackProbe probe) { m_probe = probe; }
+    HostCallbackProbe hostCallbackProbe() const { return m_probe; }
+    void hostInjectResult(const uint8_t* bda, int rssi, const uint8_t* payload, size_t len);
+};
+
+#endif // HOST_BLE_SCAN_H
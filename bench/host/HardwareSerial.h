@@ -0,0 +1,12 @@
+/**
+ * @file HardwareSerial.h
+ * @brief Host-Ersatz: Config.h bindet den Header ein, der Benchmark
+ *        baut mit deaktivierten Debug-Makros und braucht kein Serial.
+ */
+
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include "Arduino.h"
+
+#endif // HOST_HARDWARE_SERIAL_H
@@ -0,0 +1,74 @@
+/**
+ * @file HostArduino.cpp
+ * @brief Virtuelle Uhr und GPIO-Attrappe für den Host-Build
+ */
+
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // Atomar, weil der Relais-Thread des Replays micros() parallel liest
+    std::atomic<unsigned long> virtualMillis(0);
+    std::atomic<int64_t> millisSetAt(0);  // reale Zeit (ns) der letzten Uhr-Änderung
+    uint8_t pinLevels[64] = {0};
+    unsigned long pinToggles[64] = {0};
+
+    int64_t realNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+}
+
+unsigned long millis() {
+    return virtualMillis.load();
+}
+
+unsigned long micros() {
+    // Virtuelle Millisekunde plus real vergangene Zeit darin (höchstens 999 µs),
+    // damit Latenzen zwischen Threads auch auf dem Host messbar sind
+    int64_t elapsed = (realNanos() - millisSetAt.load()) / 1000;
+    if (elapsed > 999) elapsed = 999;
+    if (elapsed < 0) elapsed = 0;
+    return virtualMillis.load() * 1000UL + (unsigned long)elapsed;
+}
+
+void delay(unsigned long ms) {
+    hostAdvanceMillis(ms);
+}
+
+void yield() {
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= 64) return;
+    if (pinLevels[pin] != val) {
+        pinLevels[pin] = val;
+        pinToggles[pin]++;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < 64 ? pinLevels[pin] : LOW;
+}
+
+void hostSetMillis(unsigned long ms) {
+    if (virtualMillis.load() == ms) return;
+    virtualMillis.store(ms);
+    millisSetAt.store(realNanos());
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+    virtualMillis += ms;
+    millisSetAt.store(realNanos());
+}
+
+unsigned long hostPinWrites(uint8_t pin) {
+    return pin < 64 ? pinToggles[pin] : 0;
+}
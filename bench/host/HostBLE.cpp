@@ -0,0 +1,284 @@
+/**
+ * @file HostBLE.cpp
+ * @brief BLE-Attrappen für den Host-Build
+ */
+
+#include "BLEDevice.h"
+
+// =================== BLEAddress / BLEUUID ===================
+
+BLEAddress::BLEAddress() : m_address{0} {
+}
+
+BLEAddress::BLEAddress(const uint8_t* address) {
+    memcpy(m_address, address, sizeof(m_address));
+}
+
+bool BLEAddress::equals(const BLEAddress& other) const {
+    return memcmp(m_address, other.m_address, sizeof(m_address)) == 0;
+}
+
+std::string BLEAddress::toString() const {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+             m_address[0], m_address[1], m_address[2], m_address[3], m_address[4], m_address[5]);
+    return std::string(buf);
+}
+
+BLEUUID::BLEUUID(const uint8_t* data, uint8_t len) : m_uuid{0}, m_len(len > 16 ? 16 : len) {
+    memcpy(m_uuid, data, m_len);
+}
+
+// =================== BLEAdvertisedDevice ===================
+
+BLEAdvertisedDevice::BLEAdvertisedDevice()
+    : m_rssi(-9999), m_adFlag(0), m_appearance(0), m_txPower(0), m_pScan(nullptr),
+      m_haveAppearance(false), m_haveManufacturerData(false), m_haveName(false),
+      m_haveRSSI(false), m_haveTXPower(false) {
+}
+
+void BLEAdvertisedDevice::setPayload(const uint8_t* payload, size_t len) {
+    m_payload.assign((const char*)payload, len);
+}
+
+void BLEAdvertisedDevice::parseAdvertisement(const uint8_t* payload, size_t len) {
+    setPayload(payload, len);
+
+    size_t pos = 0;
+    while (pos < len) {
+        uint8_t length = payload[pos];
+        if (length == 0 || pos + 1 + length > len) break;
+        uint8_t adType = payload[pos + 1];
+        const uint8_t* data = payload + pos + 2;
+        size_t dataLen = length - 1;
+
+        switch (adType) {
+            case 0x01:  // Flags
+                if (dataLen >= 1) m_adFlag = data[0];
+                break;
+            case 0x02: case 0x03:  // 16-Bit Service UUIDs
+                for (size_t i = 0; i + 2 <= dataLen; i += 2) m_serviceUUIDs.push_back(BLEUUID(data + i, 2));
+                break;
+            case 0x04: case 0x05:  // 32-Bit Service UUIDs
+                for (size_t i = 0; i + 4 <= dataLen; i += 4) m_serviceUUIDs.push_back(BLEUUID(data + i, 4));
+                break;
+            case 0x06: case 0x07:  // 128-Bit Service UUIDs
+                for (size_t i = 0; i + 16 <= dataLen; i += 16) m_serviceUUIDs.push_back(BLEUUID(data + i, 16));
+                break;
+            case 0x08: case 0x09:  // Name
+                m_name = std::string((const char*)data, dataLen);
+                m_haveName = true;
+                break;
+            case 0x0A:  // TX Power
+                if (dataLen >= 1) { m_txPower = (int8_t)data[0]; m_haveTXPower = true; }
+                break;
+            case 0x19:  // Appearance
+                if (dataLen >= 2) { m_appearance = (uint16_t)(data[0] | (data[1] << 8)); m_haveAppearance = true; }
+                break;
+            case 0x16:  // Service Data 16-Bit
+                if (dataLen >= 2) {
+                    m_serviceDataUUIDs.push_back(BLEUUID(data, 2));
+                    m_serviceData.push_back(std::string((const char*)data + 2, dataLen - 2));
+                }
+                break;
+            case 0x20:  // Service Data 32-Bit
+                if (dataLen >= 4) {
+                    m_serviceDataUUIDs.push_back(BLEUUID(data, 4));
+                    m_serviceData.push_back(std::string((const char*)data + 4, dataLen - 4));
+                }
+                break;
+            case 0x21:  // Service Data 128-Bit
+                if (dataLen >= 16) {
+                    m_serviceDataUUIDs.push_back(BLEUUID(data, 16));
+                    m_serviceData.push_back(std::string((const char*)data + 16, dataLen - 16));
+                }
+                break;
+            case 0xFF:  // Manufacturer Specific Data
+                m_manufacturerData = std::string((const char*)data, dataLen);
+                m_haveManufacturerData = true;
+                break;
+            default:
+                break;
+        }
+        pos += 1 + length;
+    }
+}
+
+// =================== BLEScan ===================
+
+size_t hostAdvertisingPartLength(const uint8_t* payload, size_t len) {
+    if (len <= ESP_BLE_ADV_DATA_LEN_MAX) return len;
+    size_t pos = 0;
+    while (pos < len && pos + 1 + payload[pos] <= ESP_BLE_ADV_DATA_LEN_MAX && payload[pos] != 0) pos += 1 + payload[pos];
+    return pos;
+}
+
+BLEScan::BLEScan()
+    : m_pAdvertisedDeviceCallbacks(nullptr), m_wantDuplicates(false), m_shouldParse(true),
+      m_activeScan(false), m_stopped(true), m_endMillis(0), m_scanCompleteCB(nullptr), m_probe(nullptr) {
+}
+
+void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* pCallbacks, bool wantDuplicates, bool shouldParse) {
+    m_pAdvertisedDeviceCallbacks = pCallbacks;
+    m_wantDuplicates = wantDuplicates;
+    m_shouldParse = shouldParse;
+}
+
+bool BLEScan::start(uint32_t duration, void (*scanCompleteCB)(BLEScanResults), bool is_continue) {
+    m_scanCompleteCB = scanCompleteCB;
+    if (!is_continue) clearResults();
+    m_stopped = false;
+    m_endMillis = duration > 0 ? millis() + duration * 1000UL : 0;
+    return true;
+}
+
+BLEScanResults BLEScan::start(uint32_t duration, bool is_continue) {
+    start(duration, nullptr, is_continue);
+    return m_scanResults;
+}
+
+void BLEScan::stop() {
+    m_stopped = true;
+}
+
+void BLEScan::clearResults() {
+    for (auto& entry : m_scanResults.m_vectorAdvertisedDevices) {
+        delete entry.second;
+    }
+    m_scanResults.m_vectorAdvertisedDevices.clear();
+}
+
+void BLEScan::finishIfExpired() {
+    if (!m_stopped && m_endMillis != 0 && millis() >= m_endMillis) {
+        m_stopped = true;
+        if (m_scanCompleteCB) m_scanCompleteCB(m_scanResults);
+    }
+}
+
+bool BLEScan::hostIsScanning() {
+    finishIfExpired();
+    return !m_stopped;
+}
+
+void BLEScan::hostInjectResult(const uint8_t* bda, int rssi, const uint8_t* payload, size_t len) {
+    if (!hostIsScanning()) return;
+
+    // Passiv gibt es keine Scan-Response
+    if (!m_activeScan) len = hostAdvertisingPartLength(payload, len);
+
+    BLEAddress advertisedAddress(bda);
+    bool found = false;
+    bool shouldDelete = true;
+
+    if (!m_wantDuplicates) {
+        if (m_scanResults.m_vectorAdvertisedDevices.count(advertisedAddress.toString()) != 0) {
+            found = true;
+        }
+        if (found) return;  // Bereits gesehen, Original ignoriert das Advertisement
+    }
+
+    BLEAdvertisedDevice* advertisedDevice = new BLEAdvertisedDevice();
+    advertisedDevice->setAddress(advertisedAddress);
+    advertisedDevice->setRSSI(rssi);
+    if (m_shouldParse) {
+        advertisedDevice->parseAdvertisement(payload, len);
+    } else {
+        advertisedDevice->setPayload(payload, len);
+    }
+    advertisedDevice->setScan(this);
+
+    if (m_pAdvertisedDeviceCallbacks) {
+        // Die Kopie für die Übergabe per Wert entsteht auf dem Gerät beim Aufruf
+        // von onResult(); hier wird sie getrennt gemessen und dann verschoben.
+        if (m_probe) m_probe(HOST_PROBE_COPY, true);
+        BLEAdvertisedDevice byValue(*advertisedDevice);
+        if (m_probe) m_probe(HOST_PROBE_COPY, false);
+        if (m_probe) m_probe(HOST_PROBE_CALLBACK, true);
+        m_pAdvertisedDeviceCallbacks->onResult(std::move(byValue));
+        if (m_probe) m_probe(HOST_PROBE_CALLBACK, false);
+    }
+    if (!m_wantDuplicates && !found) {
+        m_scanResults.m_vectorAdvertisedDevices.insert(std::pair<std::string, BLEAdvertisedDevice*>(advertisedAddress.toString(), advertisedDevice));
+        shouldDelete = false;
+    }
+    if (shouldDelete) {
+        delete advertisedDevice;
+    }
+}
+
+// =================== GAP (Controller-Zustand) ===================
+
+namespace {
+    bool gapScanning = false;
+    bool gapActiveScan = true;
+    unsigned long gapEndMillis = 0;  // 0 = ohne Zeitbegrenzung
+}
+
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t* scan_params) {
+    gapActiveScan = scan_params->scan_type == BLE_SCAN_TYPE_ACTIVE;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_scanning(uint32_t duration) {
+    gapScanning = true;
+    gapEndMillis = duration > 0 ? millis() + duration * 1000UL : 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_scanning() {
+    gapScanning = false;
+    return ESP_OK;
+}
+
+// =================== BLEDevice ===================
+
+bool BLEDevice::initialized = false;
+BLEScan* BLEDevice::m_pScan = nullptr;
+gap_event_handler BLEDevice::m_customGapHandler = nullptr;
+
+void BLEDevice::init(std::string deviceName) {
+    (void)deviceName;
+    initialized = true;
+}
+
+void BLEDevice::deinit(bool releaseMemory) {
+    (void)releaseMemory;
+    initialized = false;
+}
+
+BLEScan* BLEDevice::getScan() {
+    if (!m_pScan) m_pScan = new BLEScan();
+    return m_pScan;
+}
+
+bool BLEDevice::hostIsGapScanning() {
+    if (gapScanning && gapEndMillis != 0 && millis() >= gapEndMillis) gapScanning = false;
+    return gapScanning;
+}
+
+void BLEDevice::hostDeliverScanResult(const uint8_t* bda, int rssi, const uint8_t* payload, size_t len) {
+    // Der Stack legt das Ergebnis auf seinem Stack an; ein eigener Handler sieht jedes
+    // Ergebnis (auch aus einem BLEScan-Scan), BLEScan ignoriert es, wenn er gestoppt ist
+    bool gapScan = hostIsGapScanning();
+    if (m_customGapHandler && (gapScan || getScan()->hostIsScanning())) {
+        bool active = gapScan ? gapActiveScan : getScan()->hostIsActiveScan();
+        size_t resultLen = active ? len : hostAdvertisingPartLength(payload, len);
+        esp_ble_gap_cb_param_t param;
+        memset(&param, 0, sizeof(param));
+        param.scan_rst.search_evt = ESP_GAP_SEARCH_INQ_RES_EVT;
+        memcpy(param.scan_rst.bda, bda, ESP_BD_ADDR_LEN);
+        param.scan_rst.ble_addr_type = BLE_ADDR_TYPE_PUBLIC;
+        param.scan_rst.rssi = rssi;
+        if (resultLen > sizeof(param.scan_rst.ble_adv)) resultLen = sizeof(param.scan_rst.ble_adv);
+        memcpy(param.scan_rst.ble_adv, payload, resultLen);
+        param.scan_rst.adv_data_len = (uint8_t)(resultLen < ESP_BLE_ADV_DATA_LEN_MAX ? resultLen : ESP_BLE_ADV_DATA_LEN_MAX);
+        param.scan_rst.scan_rsp_len = (uint8_t)(resultLen - param.scan_rst.adv_data_len);
+        param.scan_rst.ble_evt_type = param.scan_rst.scan_rsp_len > 0 ? ESP_BLE_EVT_SCAN_RSP : ESP_BLE_EVT_CONN_ADV;
+
+        HostCallbackProbe probe = gapScan ? getScan()->hostCallbackProbe() : nullptr;
+        if (probe) probe(HOST_PROBE_CALLBACK, true);
+        m_customGapHandler(ESP_GAP_BLE_SCAN_RESULT_EVT, &param);
+        if (probe) probe(HOST_PROBE_CALLBACK, false);
+    }
+    getScan()->hostInjectResult(bda, rssi, payload, len);
+}
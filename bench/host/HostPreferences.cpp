@@ -0,0 +1,181 @@
+/**
+ * @file HostPreferences.cpp
+ * @brief In-Memory NVS für den Host-Build
+ */
+
+#include "Preferences.h"
+#include <map>
+
+namespace {
+    typedef std::map<std::string, std::string> NvsNamespace;
+
+    std::map<std::string, NvsNamespace>& storage() {
+        static std::map<std::string, NvsNamespace> nvs;
+        return nvs;
+    }
+
+    HostNvsStats nvsStats = {0, 0, 0, 0};
+    long writeBudget = -1;
+
+    bool consumeWrite() {
+        if (writeBudget == 0) return false;
+        if (writeBudget > 0) writeBudget--;
+        return true;
+    }
+}
+
+Preferences::Preferences() : opened(false), readOnly(false), dirty(false) {
+}
+
+Preferences::~Preferences() {
+    end();
+}
+
+bool Preferences::begin(const char* name, bool ro, const char* partitionLabel) {
+    (void)partitionLabel;
+    if (opened) return false;
+    ns = name ? name : "";
+    readOnly = ro;
+    opened = true;
+    dirty = false;
+    return true;
+}
+
+void Preferences::end() {
+    if (!opened) return;
+    if (dirty) nvsStats.commits++;
+    opened = false;
+    dirty = false;
+}
+
+bool Preferences::putRaw(const char* key, const void* value, size_t len) {
+    if (!opened || readOnly || !key || !consumeWrite()) return false;
+    storage()[ns][key] = std::string((const char*)value, len);
+    nvsStats.writes++;
+    nvsStats.bytesWritten += len;
+    dirty = true;
+    return true;
+}
+
+bool Preferences::getRaw(const char* key, std::string& out) const {
+    if (!opened || !key) return false;
+    nvsStats.reads++;
+    auto nsIt = storage().find(ns);
+    if (nsIt == storage().end()) return false;
+    auto it = nsIt->second.find(key);
+    if (it == nsIt->second.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly || !consumeWrite()) return false;
+    storage()[ns].clear();
+    nvsStats.writes++;
+    dirty = true;
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || readOnly || !key || !consumeWrite()) return false;
+    nvsStats.writes++;
+    dirty = true;
+    return storage()[ns].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    std::string tmp;
+    return getRaw(key, tmp);
+}
+
+size_t Preferences::putBool(const char* key, bool value) {
+    uint8_t v = value ? 1 : 0;
+    return putRaw(key, &v, 1) ? 1 : 0;
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    return putRaw(key, &value, 1) ? 1 : 0;
+}
+
+size_t Preferences::putInt(const char* key, int32_t value) {
+    return putRaw(key, &value, sizeof(value)) ? sizeof(value) : 0;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    return putRaw(key, &value, sizeof(value)) ? sizeof(value) : 0;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    size_t len = value ? strlen(value) : 0;
+    return putRaw(key, value ? value : "", len) ? len : 0;
+}
+
+size_t Preferences::putString(const char* key, const String& value) {
+    return putString(key, value.c_str());
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    return putRaw(key, value, len) ? len : 0;
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() != 1) return defaultValue;
+    return raw[0] != 0;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() != 1) return defaultValue;
+    return (uint8_t)raw[0];
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() != sizeof(int32_t)) return defaultValue;
+    int32_t value;
+    memcpy(&value, raw.data(), sizeof(value));
+    return value;
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() != sizeof(uint32_t)) return defaultValue;
+    uint32_t value;
+    memcpy(&value, raw.data(), sizeof(value));
+    return value;
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+    std::string raw;
+    if (!getRaw(key, raw)) return defaultValue;
+    return String(raw.c_str());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    std::string raw;
+    return getRaw(key, raw) ? raw.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    std::string raw;
+    if (!getRaw(key, raw) || raw.size() > maxLen) return 0;
+    memcpy(buf, raw.data(), raw.size());
+    return raw.size();
+}
+
+HostNvsStats& Preferences::stats() {
+    return nvsStats;
+}
+
+void Preferences::resetStats() {
+    nvsStats = HostNvsStats{0, 0, 0, 0};
+}
+
+void Preferences::eraseAll() {
+    storage().clear();
+}
+
+void Preferences::setWriteBudget(long writes) {
+    writeBudget = writes;
+}
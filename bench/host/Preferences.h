@@ -0,0 +1,72 @@
+/**
+ * @file Preferences.h
+ * @brief Host-Ersatz für die ESP32 Preferences-Bibliothek (NVS)
+ *
+ * Alle Instanzen teilen sich einen prozessweiten In-Memory-Speicher,
+ * so dass Daten wie auf dem Gerät zwischen begin()/end() erhalten
+ * bleiben. Zusätzlich werden Schreibzugriffe gezählt.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <string>
+#include "Arduino.h"
+
+/**
+ * @brief Zähler für NVS-Zugriffe (nur Host)
+ */
+struct HostNvsStats {
+    unsigned long writes;        // put*/remove Aufrufe
+    unsigned long bytesWritten;  // Nutzdaten aller put* Aufrufe
+    unsigned long reads;         // get* Aufrufe
+    unsigned long commits;       // end() nach Schreibzugriffen
+};
+
+class Preferences {
+private:
+    std::string ns;
+    bool opened;
+    bool readOnly;
+    bool dirty;
+
+    bool putRaw(const char* key, const void* value, size_t len);
+    bool getRaw(const char* key, std::string& out) const;
+
+public:
+    Preferences();
+    ~Preferences();
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value);
+    size_t putUChar(const char* key, uint8_t value);
+    size_t putInt(const char* key, int32_t value);
+    size_t putUInt(const char* key, uint32_t value);
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value);
+    size_t putBytes(const char* key, const void* value, size_t len);
+
+    bool getBool(const char* key, bool defaultValue = false);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    String getString(const char* key, String defaultValue = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+    // =================== Host-Steuerung ===================
+    static HostNvsStats& stats();
+    static void resetStats();
+    static void eraseAll();  // Entspricht "nvs_flash_erase"
+    // Stromausfall: nach `writes` weiteren Schreibzugriffen erreicht nichts mehr den Speicher
+    // (put*/remove/clear liefern Fehler). -1 = unbegrenzt
+    static void setWriteBudget(long writes);
+};
+
+#endif // HOST_PREFERENCES_H
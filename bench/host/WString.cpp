@@ -0,0 +1,188 @@
+/**
+ * @file WString.cpp
+ * @brief Host-Ersatz für die Arduino String-Klasse
+ */
+
+#include "WString.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+String::String(const char* str) : buffer(nullptr), len(0), capacity(0) {
+    if (str) assign(str, strlen(str));
+}
+
+String::String(const String& other) : buffer(nullptr), len(0), capacity(0) {
+    assign(other.c_str(), other.len);
+}
+
+String::String(String&& other) noexcept : buffer(other.buffer), len(other.len), capacity(other.capacity) {
+    other.buffer = nullptr;
+    other.len = 0;
+    other.capacity = 0;
+}
+
+String::String(char c) : buffer(nullptr), len(0), capacity(0) {
+    char tmp[2] = { c, '\0' };
+    assign(tmp, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : buffer(nullptr), len(0), capacity(0) {
+    initFromNumber(value, base, false);
+}
+
+String::String(int value, unsigned char base) : buffer(nullptr), len(0), capacity(0) {
+    if (base == 10 && value < 0) {
+        initFromNumber((unsigned long)(-(long)value), base, true);
+    } else {
+        initFromNumber((unsigned int)value, base, false);
+    }
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(nullptr), len(0), capacity(0) {
+    initFromNumber(value, base, false);
+}
+
+String::String(long value, unsigned char base) : buffer(nullptr), len(0), capacity(0) {
+    if (base == 10 && value < 0) {
+        initFromNumber((unsigned long)(-value), base, true);
+    } else {
+        initFromNumber((unsigned long)value, base, false);
+    }
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), len(0), capacity(0) {
+    initFromNumber(value, base, false);
+}
+
+String::~String() {
+    delete[] buffer;
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) assign(other.c_str(), other.len);
+    return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+    if (this != &other) {
+        delete[] buffer;
+        buffer = other.buffer;
+        len = other.len;
+        capacity = other.capacity;
+        other.buffer = nullptr;
+        other.len = 0;
+        other.capacity = 0;
+    }
+    return *this;
+}
+
+String& String::operator=(const char* str) {
+    assign(str ? str : "", str ? strlen(str) : 0);
+    return *this;
+}
+
+bool String::reserveInternal(unsigned int size) {
+    if (buffer && capacity >= size) return true;
+    // Wie Arduino: Puffer wird exakt auf die neue Größe umkopiert
+    char* newBuffer = new char[size + 1];
+    if (buffer) {
+        memcpy(newBuffer, buffer, len + 1);
+        delete[] buffer;
+    } else {
+        newBuffer[0] = '\0';
+    }
+    buffer = newBuffer;
+    capacity = size;
+    return true;
+}
+
+void String::assign(const char* str, unsigned int length) {
+    reserveInternal(length);
+    memcpy(buffer, str, length);
+    buffer[length] = '\0';
+    len = length;
+}
+
+void String::initFromNumber(unsigned long value, unsigned char base, bool negative) {
+    char tmp[34];
+    char* p = tmp + sizeof(tmp) - 1;
+    *p = '\0';
+    if (base < 2) base = 10;
+    do {
+        unsigned long digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    if (negative) *--p = '-';
+    assign(p, (unsigned int)strlen(p));
+}
+
+bool String::concat(const char* str, unsigned int length) {
+    if (length == 0) return true;
+    reserveInternal(len + length);
+    memcpy(buffer + len, str, length);
+    len += length;
+    buffer[len] = '\0';
+    return true;
+}
+
+bool String::concat(const String& str) {
+    return concat(str.c_str(), str.len);
+}
+
+bool String::concat(const char* str) {
+    if (!str) return false;
+    return concat(str, (unsigned int)strlen(str));
+}
+
+bool String::concat(char c) {
+    return concat(&c, 1);
+}
+
+bool String::equals(const char* str) const {
+    return strcmp(c_str(), str ? str : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& str) const {
+    if (len != str.len) return false;
+    const char* a = c_str();
+    const char* b = str.c_str();
+    for (unsigned int i = 0; i < len; i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) return false;
+    }
+    return true;
+}
+
+int String::indexOf(const char* str) const {
+    const char* found = strstr(c_str(), str);
+    return found ? (int)(found - c_str()) : -1;
+}
+
+long String::toInt() const {
+    return atol(c_str());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
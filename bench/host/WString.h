@@ -0,0 +1,82 @@
+/**
+ * @file WString.h
+ * @brief Host-Ersatz für die Arduino String-Klasse
+ *
+ * Bildet nur die im Projekt verwendeten Teile der Arduino-API nach.
+ * Der Puffer wird wie im Original bei jeder Vergrößerung neu alloziert,
+ * damit der Allokations-Zähler des Benchmarks realistische Werte liefert.
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define DEC 10
+#define HEX 16
+
+class String {
+private:
+    char* buffer;
+    unsigned int len;
+    unsigned int capacity;
+
+    bool reserveInternal(unsigned int size);
+    void assign(const char* str, unsigned int length);
+    void initFromNumber(unsigned long value, unsigned char base, bool negative);
+
+public:
+    String(const char* str = "");
+    String(const String& other);
+    String(String&& other) noexcept;
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other) noexcept;
+    String& operator=(const char* str);
+
+    bool reserve(unsigned int size) { return reserveInternal(size); }
+    unsigned int length() const { return len; }
+    const char* c_str() const { return buffer ? buffer : ""; }
+
+    bool concat(const String& str);
+    bool concat(const char* str);
+    bool concat(const char* str, unsigned int length);
+    bool concat(char c);
+    String& operator+=(const String& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* rhs) { concat(rhs); return *this; }
+    String& operator+=(char rhs) { concat(rhs); return *this; }
+
+    bool equals(const char* str) const;
+    bool equalsIgnoreCase(const String& str) const;
+    bool operator==(const String& rhs) const { return equals(rhs.c_str()); }
+    bool operator==(const char* rhs) const { return equals(rhs); }
+    bool operator!=(const String& rhs) const { return !equals(rhs.c_str()); }
+    bool operator!=(const char* rhs) const { return !equals(rhs); }
+
+    int indexOf(const char* str) const;
+    int indexOf(const String& str) const { return indexOf(str.c_str()); }
+    long toInt() const;
+    char operator[](unsigned int index) const { return index < len ? buffer[index] : '\0'; }
+};
+
+// Arduino liefert bei Verkettungen einen StringSumHelper; ArduinoJson erwartet den Typ
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+
+#endif // HOST_WSTRING_H
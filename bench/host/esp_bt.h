@@ -0,0 +1,14 @@
+/**
+ * @file esp_bt.h
+ * @brief Host-Ersatz für den ESP-IDF BT-Controller
+ */
+
+#ifndef HOST_ESP_BT_H
+#define HOST_ESP_BT_H
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+inline esp_err_t esp_bt_controller_disable() { return ESP_OK; }
+
+#endif // HOST_ESP_BT_H
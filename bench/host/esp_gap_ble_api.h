@@ -0,0 +1,88 @@
+/**
+ * @file esp_gap_ble_api.h
+ * @brief Host-Ersatz für die GAP-Schnittstelle von ESP-IDF (nur Scan)
+ *
+ * Enthält die Typen und Aufrufe, die BluetoothScanner für den direkten
+ * Scan ohne BLEScan braucht. Der Scan-Zustand des "Controllers" läuft
+ * über die virtuelle Uhr; Ergebnisse liefert BLEDevice::hostDeliverScanResult().
+ */
+
+#ifndef HOST_ESP_GAP_BLE_API_H
+#define HOST_ESP_GAP_BLE_API_H
+
+#include <cstdint>
+#include "esp_bt.h"
+
+#define ESP_BLE_ADV_DATA_LEN_MAX 31
+#define ESP_BLE_SCAN_RSP_DATA_LEN_MAX 31
+#define ESP_BD_ADDR_LEN 6
+
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+    ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT = 2,
+    ESP_GAP_BLE_SCAN_RESULT_EVT = 3,
+    ESP_GAP_BLE_SCAN_START_COMPLETE_EVT = 7,
+    ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT = 18,
+} esp_gap_ble_cb_event_t;
+
+typedef enum {
+    ESP_GAP_SEARCH_INQ_RES_EVT = 0,
+    ESP_GAP_SEARCH_INQ_CMPL_EVT = 1,
+} esp_gap_search_evt_t;
+
+typedef enum {
+    ESP_BLE_EVT_CONN_ADV = 0x00,
+    ESP_BLE_EVT_SCAN_RSP = 0x04,
+} esp_ble_evt_type_t;
+
+typedef enum {
+    BLE_SCAN_TYPE_PASSIVE = 0x0,
+    BLE_SCAN_TYPE_ACTIVE = 0x1,
+} esp_ble_scan_type_t;
+
+typedef enum {
+    BLE_ADDR_TYPE_PUBLIC = 0x00,
+    BLE_ADDR_TYPE_RANDOM = 0x01,
+} esp_ble_addr_type_t;
+
+typedef enum {
+    BLE_SCAN_FILTER_ALLOW_ALL = 0x0,
+} esp_ble_scan_filter_t;
+
+typedef enum {
+    BLE_SCAN_DUPLICATE_DISABLE = 0x0,
+    BLE_SCAN_DUPLICATE_ENABLE = 0x1,
+} esp_ble_scan_duplicate_t;
+
+typedef struct {
+    esp_ble_scan_type_t scan_type;
+    esp_ble_addr_type_t own_addr_type;
+    esp_ble_scan_filter_t scan_filter_policy;
+    uint16_t scan_interval;   // Einheiten zu 0,625 ms
+    uint16_t scan_window;
+    esp_ble_scan_duplicate_t scan_duplicate;
+} esp_ble_scan_params_t;
+
+typedef union {
+    struct ble_scan_result_evt_param {
+        esp_gap_search_evt_t search_evt;
+        esp_bd_addr_t bda;
+        int dev_type;
+        esp_ble_addr_type_t ble_addr_type;
+        esp_ble_evt_type_t ble_evt_type;
+        int rssi;
+        uint8_t ble_adv[ESP_BLE_ADV_DATA_LEN_MAX + ESP_BLE_SCAN_RSP_DATA_LEN_MAX];
+        int flag;
+        int num_resps;
+        uint8_t adv_data_len;
+        uint8_t scan_rsp_len;
+        uint32_t num_dis;
+    } scan_rst;
+} esp_ble_gap_cb_param_t;
+
+esp_err_t esp_ble_gap_set_scan_params(esp_ble_scan_params_t* scan_params);
+esp_err_t esp_ble_gap_start_scanning(uint32_t duration);  // Sekunden, 0 = ohne Ende
+esp_err_t esp_ble_gap_stop_scanning();
+
+#endif // HOST_ESP_GAP_BLE_API_H
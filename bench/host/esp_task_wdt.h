@@ -0,0 +1,17 @@
+/**
+ * @file esp_task_wdt.h
+ * @brief Host-Ersatz für den ESP-IDF Task-Watchdog
+ */
+
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+#include "esp_bt.h"
+
+inline esp_err_t esp_task_wdt_init(unsigned int timeoutSec, bool panic) { (void)timeoutSec; (void)panic; return ESP_OK; }
+inline esp_err_t esp_task_wdt_add(void* task) { (void)task; return ESP_OK; }
+inline esp_err_t esp_task_wdt_delete(void* task) { (void)task; return ESP_OK; }
+inline esp_err_t esp_task_wdt_deinit() { return ESP_OK; }
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+
+#endif // HOST_ESP_TASK_WDT_H
@@ -0,0 +1,1650 @@
+/**
+ * @file main.cpp
+ * @brief Host-Benchmark des Scanner-Kerns (Einstiegspunkt)
+ *
+ * Aufruf:
+ *   bt_bench replay <trace>              Trace abspielen und Kennzahlen ausgeben (zusätzlich
+ *                                        ohne Bloom-Vorfilter der Known-Liste zum Vergleich)
+ *   bt_bench generate <datei> [optionen] Synthetischen Trace schreiben
+ *   bt_bench synth [optionen]            Synthetischen Trace erzeugen und abspielen
+ *   bt_bench scale [optionen]            Tabellen voll belegen (MAX_DEVICES aktive,
+ *                                        MAX_KNOWN bekannte Geräte) und abspielen, mit/ohne Known-Vorfilter
+ *   bt_bench evict [optionen]            LRU-Verdrängung bei 50/200/500 gleichzeitigen Geräten
+ *   bt_bench scanmode <trace>            Zyklus- und Dauer-Scan auf demselben Trace vergleichen
+ *   bt_bench gap <trace>                 BLEScan/onResult() gegen den eigenen GAP-Handler
+ *   bt_bench smoothing [optionen]        Verrauschter Trace: Rohwert gegen Glättung mit Hysterese
+ *   bt_bench heap [optionen]             Heap-Spitze im dichten Scan-Fenster: BLEScan sammelt vs. Streaming
+ *   bt_bench ring                        Advertisement-Ring mit echten Threads belasten
+ *   bt_bench snapshot                    Snapshot-Leser gegen laufenden Ingest prüfen
+ *   bt_bench adparse [trace] [--iterations N] [--seed X]
+ *                                        AD-Parser fuzzen und gegen die Accessoren messen
+ *   bt_bench vendors                     Company-ID-Suche und Hersteller-Decoder prüfen
+ *   bt_bench stats                       Empfangsstatistik pro Gerät gegen exakte Werte prüfen
+ *   bt_bench absence                     Abwesenheit nach Sendeintervall gegen festes Timeout
+ *   bt_bench expiry                      Aufwand der Bereinigung gegen Tabellengröße und Abgänge
+ *   bt_bench hll                         Fehlerschranken des devices_ever-Schätzers prüfen
+ *   bt_bench nvs                         Known-Liste laden/speichern: Einzel-Schlüssel gegen Blob
+ *   bt_bench journal                     Journal der Known-Liste: Schreibzugriffe und Stromausfall
+ *
+ * Generator-Optionen: --devices N --duration S --known K --churn F --noise DB --seed X
+ * Replay-Option:      --capacity N (Laufzeit-Kapazität der Gerätetabelle, höchstens MAX_DEVICES)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <BLEDevice.h>
+#include "BluetoothScanner.h"
+#include "AdParserCheck.h"
+#include "AllocCounter.h"
+#include "CompanyIdentifiers.h"
+#include "DeviceManager.h"
+#include "HyperLogLog.h"
+#include "ReplayHarness.h"
+#include "Trace.h"
+
+namespace {
+    void usage() {
+        fprintf(stderr,
+                "Aufruf:\n"
+                "  bt_bench replay <trace>\n"
+                "  bt_bench generate <datei> [--devices N] [--duration S] [--known K] [--churn F] [--noise DB] [--seed X]\n"
+                "  bt_bench synth [generator-optionen]\n"
+                "  bt_bench scale [generator-optionen]\n"
+                "  bt_bench evict [generator-optionen] [--capacity N]\n"
+                "  bt_bench scanmode <trace>\n"
+                "  bt_bench gap <trace>\n"
+                "  bt_bench smoothing [generator-optionen]\n"
+                "  bt_bench heap [generator-optionen]\n"
+                "  bt_bench ring\n"
+                "  bt_bench snapshot\n"
+                "  bt_bench adparse [trace] [--iterations N] [--seed X]\n"
+                "  bt_bench vendors\n"
+                "  bt_bench stats\n"
+                "  bt_bench absence\n"
+                "  bt_bench expiry\n"
+                "  bt_bench hll\n"
+                "  bt_bench nvs\n"
+                "  bt_bench journal\n");
+    }
+
+    bool parseGeneratorOptions(int argc, char** argv, int first, TraceGeneratorConfig& config, int* capacity = nullptr) {
+        for (int i = first; i < argc; i++) {
+            if (i + 1 >= argc) return false;
+            const char* opt = argv[i];
+            const char* val = argv[++i];
+            if (capacity && strcmp(opt, "--capacity") == 0) *capacity = atoi(val);
+            else if (strcmp(opt, "--devices") == 0) config.devices = atoi(val);
+            else if (strcmp(opt, "--duration") == 0) config.durationSec = atoi(val);
+            else if (strcmp(opt, "--known") == 0) config.knownDevices = atoi(val);
+            else if (strcmp(opt, "--churn") == 0) config.churn = (float)atof(val);
+            else if (strcmp(opt, "--noise") == 0) config.rssiNoiseDb = (float)atof(val);
+            else if (strcmp(opt, "--seed") == 0) config.seed = (uint32_t)strtoul(val, nullptr, 10);
+            else return false;
+        }
+        return true;
+    }
+
+    int compareKnownFilter(ReplayHarness& harness, const Trace& trace, const ReplayResult& result) {
+        // Gleicher Trace mit umgeschaltetem Bloom-Vorfilter, nur für den Vergleich der Known-Suche
+        ReplayResult other;
+        harness.setKnownFilter(!result.knownFilter);
+        if (!harness.run(trace, other)) {
+            fprintf(stderr, "Replay fehlgeschlagen\n");
+            return 1;
+        }
+        if (result.knownFilter) ReplayHarness::printKnownFilterComparison(result, other);
+        else ReplayHarness::printKnownFilterComparison(other, result);
+        // Der Filter darf nie ein bekanntes Gerät abweisen
+        return (result.knownFilterMisses == 0 && other.knownFilterMisses == 0) ? 0 : 1;
+    }
+
+    int cmdReplay(int argc, char** argv) {
+        if (argc < 3) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        std::string error;
+        if (!loadTrace(argv[2], trace, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        ReplayHarness harness;
+        ReplayResult result;
+        if (!harness.run(trace, result)) {
+            fprintf(stderr, "Replay fehlgeschlagen\n");
+            return 1;
+        }
+        ReplayHarness::printResult(argv[2], result);
+        return compareKnownFilter(harness, trace, result);
+    }
+
+    int cmdGenerate(int argc, char** argv) {
+        TraceGeneratorConfig config = defaultGeneratorConfig();
+        if (argc < 3 || !parseGeneratorOptions(argc, argv, 3, config)) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        generateTrace(config, trace);
+        if (!saveTrace(argv[2], trace)) {
+            fprintf(stderr, "Kann %s nicht schreiben\n", argv[2]);
+            return 1;
+        }
+        printf("%s: %zu Advertisements, %zu bekannte Geräte\n", argv[2], trace.events.size(), trace.known.size());
+        return 0;
+    }
+
+    int cmdSynth(int argc, char** argv) {
+        TraceGeneratorConfig config = defaultGeneratorConfig();
+        int capacity = MAX_DEVICES;
+        if (!parseGeneratorOptions(argc, argv, 2, config, &capacity)) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        generateTrace(config, trace);
+        ReplayHarness harness;
+        harness.setCapacity(capacity);
+        ReplayResult result;
+        if (!harness.run(trace, result)) {
+            fprintf(stderr, "Replay fehlgeschlagen\n");
+            return 1;
+        }
+        char title[96];
+        snprintf(title, sizeof(title), "synth devices=%d duration=%ds seed=%u",
+                 config.devices, config.durationSec, config.seed);
+        ReplayHarness::printResult(title, result);
+        return 0;
+    }
+
+    int cmdScale(int argc, char** argv) {
+        // Gleichzeitig anwesende Geräte = Kapazität der aktiven Tabelle
+        TraceGeneratorConfig config = defaultGeneratorConfig();
+        config.devices = MAX_DEVICES;
+        config.durationSec = 60;
+        if (!parseGeneratorOptions(argc, argv, 2, config)) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        generateTrace(config, trace);
+
+        // Known-Liste mit nie gesehenen Adressen auf MAX_KNOWN auffüllen
+        for (int i = (int)trace.known.size(); i < MAX_KNOWN; i++) {
+            char mac[18];
+            snprintf(mac, sizeof(mac), "00:1a:7d:%02x:%02x:%02x", (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF);
+            TraceKnownDevice known;
+            known.address = mac;
+            known.rssiThreshold = DEFAULT_RSSI_THRESHOLD;
+            known.comment = "Füllung";
+            trace.known.push_back(known);
+        }
+
+        ReplayHarness harness;
+        ReplayResult result;
+        if (!harness.run(trace, result)) {
+            fprintf(stderr, "Replay fehlgeschlagen\n");
+            return 1;
+        }
+        char title[96];
+        snprintf(title, sizeof(title), "scale MAX_DEVICES=%d MAX_KNOWN=%d seed=%u", MAX_DEVICES, MAX_KNOWN, config.seed);
+        ReplayHarness::printResult(title, result);
+        return compareKnownFilter(harness, trace, result);
+    }
+
+    int cmdEvict(int argc, char** argv) {
+        // Mehr gleichzeitige Geräte als Tabellenplätze: jede Runde verdrängt
+        static const int concurrentDevices[] = {50, 200, 500};
+        TraceGeneratorConfig base = defaultGeneratorConfig();
+        base.durationSec = 60;
+        int capacity = MAX_DEVICES;
+        if (!parseGeneratorOptions(argc, argv, 2, base, &capacity)) {
+            usage();
+            return 2;
+        }
+        for (int devices : concurrentDevices) {
+            TraceGeneratorConfig config = base;
+            config.devices = devices;
+            Trace trace;
+            generateTrace(config, trace);
+            ReplayHarness harness;
+            harness.setCapacity(capacity);
+            ReplayResult result;
+            if (!harness.run(trace, result)) {
+                fprintf(stderr, "Replay fehlgeschlagen\n");
+                return 1;
+            }
+            char title[96];
+            snprintf(title, sizeof(title), "evict devices=%d capacity=%d seed=%u", devices, result.tableCapacity, config.seed);
+            ReplayHarness::printResult(title, result);
+        }
+        return 0;
+    }
+
+    int cmdScanMode(int argc, char** argv) {
+        if (argc < 3) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        std::string error;
+        if (!loadTrace(argv[2], trace, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        static const ScanMode modes[] = {SCAN_MODE_DUTY_CYCLE, SCAN_MODE_CONTINUOUS};
+        ReplayResult results[2];
+        for (int i = 0; i < 2; i++) {
+            ReplayHarness harness;
+            harness.setScanMode(modes[i]);
+            if (!harness.run(trace, results[i])) {
+                fprintf(stderr, "Replay fehlgeschlagen\n");
+                return 1;
+            }
+            char title[160];
+            snprintf(title, sizeof(title), "%s (%s)", argv[2], modes[i] == SCAN_MODE_CONTINUOUS ? "continuous" : "duty_cycle");
+            ReplayHarness::printResult(title, results[i]);
+        }
+        ReplayHarness::printScanModeComparison(results[0], results[1]);
+        return 0;
+    }
+
+    int cmdGap(int argc, char** argv) {
+        // Gleicher Trace über BLEScan (BLEAdvertisedDevice, Kopie an onResult()) und über den
+        // eigenen GAP-Handler; die Gerätetabelle muss am Ende gleich aussehen
+        if (argc < 3) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        std::string error;
+        if (!loadTrace(argv[2], trace, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        ReplayResult results[2];
+        for (int i = 0; i < 2; i++) {
+            ReplayHarness harness;
+            harness.setStreaming(true);
+            harness.setGapIngest(i == 1);
+            if (!harness.run(trace, results[i])) {
+                fprintf(stderr, "Replay fehlgeschlagen\n");
+                return 1;
+            }
+            char title[160];
+            snprintf(title, sizeof(title), "%s (%s)", argv[2], i == 1 ? "GAP-Handler" : "BLEScan + onResult");
+            ReplayHarness::printResult(title, results[i]);
+        }
+
+        const ReplayResult& scan = results[0];
+        const ReplayResult& gap = results[1];
+        double scanDelivered = scan.advertsDelivered > 0 ? (double)scan.advertsDelivered : 1.0;
+        double gapDelivered = gap.advertsDelivered > 0 ? (double)gap.advertsDelivered : 1.0;
+        printf("== BLEScan -> GAP-Handler (pro Advertisement) ==\n");
+        printf("deliver_ns:            %.0f -> %.0f (Ereignis bis Ring, inkl. BLEAdvertisedDevice)\n",
+               scan.ingestNanos / scanDelivered, gap.ingestNanos / gapDelivered);
+        printf("callback_ns:           %.0f -> %.0f (onResult() bzw. Handler)\n",
+               scan.callbackNanos / scanDelivered, gap.callbackNanos / gapDelivered);
+        printf("deliver_allocs:        %.2f -> %.2f\n", scan.deliverAllocs / scanDelivered, gap.deliverAllocs / gapDelivered);
+        printf("deliver_alloc_bytes:   %.0f -> %.0f\n", scan.deliverAllocBytes / scanDelivered, gap.deliverAllocBytes / gapDelivered);
+        printf("heap_peak:             %llu -> %llu Bytes\n", (unsigned long long)scan.heapPeakBytes,
+               (unsigned long long)gap.heapPeakBytes);
+
+        bool same = scan.advertsDelivered == gap.advertsDelivered && scan.finalDeviceCount == gap.finalDeviceCount &&
+                    scan.devicesEver == gap.devicesEver && scan.relayTransitions == gap.relayTransitions &&
+                    scan.presenceEvents == gap.presenceEvents && scan.detections == gap.detections;
+        bool ok = same && gap.deliverAllocs == 0 && gap.relayMismatches == 0 && gap.aggregateMismatches == 0;
+        printf("%s\n", ok ? "OK" : same ? "FEHLER: GAP-Pfad allokiert" : "FEHLER: Ergebnisse weichen ab");
+        return ok ? 0 : 1;
+    }
+
+    int cmdSmoothing(int argc, char** argv) {
+        // Bekannte Geräte knapp über dem Grenzwert, starkes Rauschen: ohne Glättung flattert der Ausgang
+        TraceGeneratorConfig config = defaultGeneratorConfig();
+        config.durationSec = 600;
+        config.rssiNoiseDb = 8.0f;
+        if (!parseGeneratorOptions(argc, argv, 2, config)) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        generateTrace(config, trace);
+
+        PresenceTuning raw;
+        memset(&raw, 0, sizeof(raw));  // Rohwert >= Grenzwert, wie vor der Glättung
+        const PresenceTuning tunings[2] = {raw, defaultPresenceTuning()};
+        static const char* const titles[2] = {"raw", "filtered"};
+        ReplayResult results[2];
+        for (int i = 0; i < 2; i++) {
+            ReplayHarness harness;
+            harness.setPresenceTuning(tunings[i]);
+            if (!harness.run(trace, results[i])) {
+                fprintf(stderr, "Replay fehlgeschlagen\n");
+                return 1;
+            }
+        }
+
+        const PresenceTuning& t = tunings[1];
+        printf("== smoothing noise=%.1f dB duration=%d s known=%d (EMA 1/%d, +%d/-%d dB, %u/%u ms) ==\n",
+               config.rssiNoiseDb, config.durationSec, config.knownDevices, 1 << t.filterShift,
+               t.enterMargin, t.exitMargin, t.enterDwellMs, t.exitDwellMs);
+        printf("%-10s %12s %12s %10s %10s %8s\n", "", "relay_trans", "presence_ev", "detect_p50", "detect_p99", "missed");
+        for (int i = 0; i < 2; i++) {
+            const ReplayResult& r = results[i];
+            printf("%-10s %12d %12d %8llums %8llums %8d\n", titles[i], r.relayTransitions, r.presenceEvents,
+                   (unsigned long long)r.detectP50Ms, (unsigned long long)r.detectP99Ms, r.missedArrivals);
+        }
+        bool ok = results[1].relayTransitions < results[0].relayTransitions &&
+                  results[1].aggregateMismatches == 0 && results[1].relayMismatches == 0;
+        printf("%s\n", ok ? "OK" : "FEHLER: Glättung schaltet nicht seltener");
+
+        // Austritt mit maximaler Mindestdauer über den Umlauf des 8-Bit-Ticks (65,5 s): schwach bei
+        // 1 s und 60 s (noch keine 60 s), dann bei 67 s - jetzt muss das Gerät abwesend sein
+        static DeviceHot dwellTable[MAX_DEVICES];
+        static DeviceCold dwellDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        DeviceManager dwellManager;
+        dwellManager.begin(dwellTable, dwellDetails, MAX_DEVICES);
+        PresenceTuning longExit = defaultPresenceTuning();
+        longExit.filterShift = 0;
+        longExit.exitMargin = 0;
+        longExit.exitDwellMs = PRESENCE_MAX_DWELL_MS;
+        const char* dwellAddress = "02:d0:00:00:00:01";
+        dwellManager.addKnownDevice(dwellAddress, "dwell", -70, &longExit);
+        dwellManager.updateDevice(dwellAddress, "dwell", -50);
+        static const uint32_t weakAt[] = {1000, 60000, 67000};
+        bool nearbyBefore = false;
+        for (uint32_t t : weakAt) {
+            int idx = dwellManager.findDevice(dwellAddress);
+            if (t == weakAt[2]) nearbyBefore = idx >= 0 && dwellTable[idx].isNearby();
+            hostSetMillis(t);
+            dwellManager.updateDevice(dwellAddress, "dwell", -90);
+        }
+        int dwellIndex = dwellManager.findDevice(dwellAddress);
+        bool dwellOk = nearbyBefore && dwellIndex >= 0 && !dwellTable[dwellIndex].isNearby();
+        printf("exit_dwell_wrap:       %s\n", dwellOk ? "ok" : "FEHLER (Mindestdauer über Tick-Umlauf nicht abgelaufen)");
+        ok = ok && dwellOk;
+        return ok ? 0 : 1;
+    }
+
+    int cmdHeap(int argc, char** argv) {
+        // Dichtes Scan-Fenster: viele Geräte gleichzeitig, jedes mit eigenem Ergebnis in BLEScan
+        TraceGeneratorConfig config = defaultGeneratorConfig();
+        config.devices = 300;
+        config.durationSec = 60;
+        if (!parseGeneratorOptions(argc, argv, 2, config)) {
+            usage();
+            return 2;
+        }
+        Trace trace;
+        generateTrace(config, trace);
+        ReplayResult results[2];
+        for (int i = 0; i < 2; i++) {
+            ReplayHarness harness;
+            harness.setScanMode(SCAN_MODE_DUTY_CYCLE);
+            harness.setStreaming(i == 1);
+            harness.setGapIngest(false);  // verglichen wird die Ergebnis-Map von BLEScan
+            if (!harness.run(trace, results[i])) {
+                fprintf(stderr, "Replay fehlgeschlagen\n");
+                return 1;
+            }
+            char title[96];
+            snprintf(title, sizeof(title), "heap devices=%d seed=%u (%s)", config.devices, config.seed,
+                     i == 1 ? "streaming" : "BLEScan sammelt");
+            ReplayHarness::printResult(title, results[i]);
+        }
+        printf("== Heap-Ersparnis ==\n");
+        printf("heap_peak:             %llu -> %llu Bytes\n",
+               (unsigned long long)results[0].heapPeakBytes, (unsigned long long)results[1].heapPeakBytes);
+        printf("retained_results:      %llu -> %llu\n",
+               (unsigned long long)results[0].peakRetainedResults, (unsigned long long)results[1].peakRetainedResults);
+        printf("adverts_delivered:     %llu -> %llu (Duplikate filtert die Gerätetabelle)\n",
+               (unsigned long long)results[0].advertsDelivered, (unsigned long long)results[1].advertsDelivered);
+        return 0;
+    }
+
+    uint64_t xorshift64(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    bool ringOrderCheck() {
+        // Reiner SPSC-Test: jede Sequenznummer genau einmal und in Reihenfolge
+        const uint32_t total = 2000000;
+        SpscQueue<uint32_t, ADVERT_RING_SIZE> queue;
+        std::atomic<bool> producerDone(false);
+        uint32_t fullSpins = 0;
+        std::thread producer([&]() {
+            for (uint32_t i = 0; i < total; i++) {
+                while (!queue.push(i)) {
+                    fullSpins++;
+                    std::this_thread::yield();
+                }
+            }
+            producerDone.store(true, std::memory_order_release);
+        });
+        uint32_t expected = 0, errors = 0, value;
+        while (expected < total) {
+            if (queue.pop(value)) {
+                if (value != expected) errors++;
+                expected = value + 1;
+            } else if (producerDone.load(std::memory_order_acquire) && queue.empty()) {
+                break;
+            } else {
+                std::this_thread::yield();  // auch auf nur einem Kern Fortschritt
+            }
+        }
+        producer.join();
+        bool ok = errors == 0 && expected == total && queue.empty();
+        printf("spsc_order:            %u Einträge, %u Reihenfolgefehler, %u mal voll -> %s\n",
+               total, errors, fullSpins, ok ? "OK" : "FEHLER");
+        return ok;
+    }
+
+    bool ringScannerCheck() {
+        // Echter Pfad: BLE-Callback, Ingest-Task und Web-Leser in drei Threads
+        const int adverts = 200000;
+        const int addresses = MAX_DEVICES / 2;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        memset(deviceTable, 0, sizeof(deviceTable));
+        memset(deviceDetails, 0, sizeof(deviceDetails));
+
+        DeviceManager deviceManager;
+        deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+        BluetoothScanner scanner;
+        scanner.setScanMode(SCAN_MODE_CONTINUOUS);
+        scanner.setStreaming(true);
+        if (!scanner.begin(&deviceManager)) return false;
+        scanner.performAutomaticScanCycle();
+
+        std::atomic<bool> producerDone(false);
+        std::atomic<bool> consumerDone(false);
+        std::thread producer([&]() {
+            uint64_t state = 0x2545F4914F6CDD1DULL;
+            uint8_t payload[] = {0x02, 0x01, 0x06, 0x05, 0x09, 'R', 'i', 'n', 'g'};
+            for (int i = 0; i < adverts; i++) {
+                uint64_t r = xorshift64(state);
+                uint8_t bda[6] = {0x02, 0xAB, 0xCD, 0x00, (uint8_t)((r % addresses) >> 8), (uint8_t)(r % addresses)};
+                BLEDevice::hostDeliverScanResult(bda, -40 - (int)((r >> 16) % 50), payload, sizeof(payload));
+                if ((i & 15) == 15) std::this_thread::yield();  // Funk liefert in Schüben, nicht ununterbrochen
+            }
+            producerDone.store(true, std::memory_order_release);
+        });
+        uint64_t processed = 0;
+        std::thread consumer([&]() {
+            // Leer erst prüfen, nachdem der Erzeuger fertig ist: sonst fehlt der letzte Batch
+            while (true) {
+                bool done = producerDone.load(std::memory_order_acquire);
+                int n = scanner.processPending();
+                processed += (uint64_t)n;
+                if (done && n == 0) break;
+                if (n == 0) std::this_thread::yield();
+            }
+            consumerDone.store(true, std::memory_order_release);
+        });
+        uint64_t reads = 0, readErrors = 0;
+        std::thread reader([&]() {
+            SafeDevice device;
+            while (!consumerDone.load(std::memory_order_acquire)) {
+                {
+                    DeviceManager::Lock lock(deviceManager);
+                    for (int i = 0; i < deviceManager.getDeviceCount(); i++) {
+                        if (!deviceManager.getDevice(i, device) || strncmp(device.address, "02:ab:cd:00:", 12) != 0) {
+                            readErrors++;
+                        }
+                        reads++;
+                    }
+                }
+                std::this_thread::yield();
+            }
+        });
+        producer.join();
+        consumer.join();
+        reader.join();
+
+        uint64_t delivered = (uint64_t)scanner.getAdvertsReceived();
+        uint64_t dropped = scanner.getRingDropCount();
+        bool aggregatesOk = true;
+        {
+            DeviceManager::Lock lock(deviceManager);
+            const DeviceHot* table = deviceManager.getDeviceTable();
+            int active = 0, present = 0;
+            for (int i = 0; i < deviceManager.getDeviceCount(); i++) {
+                if (table[i].isActive()) active++;
+                if (table[i].isPresent()) present++;
+            }
+            aggregatesOk = active == deviceManager.getActiveCount() && present == deviceManager.getPresentCount() &&
+                           deviceManager.getDeviceCount() <= addresses;
+        }
+        bool ok = delivered == (uint64_t)adverts && processed + dropped == delivered && readErrors == 0 && aggregatesOk;
+        printf("scanner_ring:          %llu geliefert, %llu verarbeitet, %llu verworfen (Ring voll), %d Geräte\n",
+               (unsigned long long)delivered, (unsigned long long)processed, (unsigned long long)dropped,
+               deviceManager.getDeviceCount());
+        printf("reader:                %llu Zeilen gelesen, %llu fehlerhaft, Zähler %s -> %s\n",
+               (unsigned long long)reads, (unsigned long long)readErrors, aggregatesOk ? "konsistent" : "abweichend",
+               ok ? "OK" : "FEHLER");
+        scanner.end();
+        return ok;
+    }
+
+    int cmdRing() {
+        printf("== ring size=%d record=%zu Bytes ==\n", ADVERT_RING_SIZE, sizeof(AdvertRecord));
+        bool ok = ringOrderCheck();
+        ok = ringScannerCheck() && ok;
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    // Name, den ein Gerät in cmdSnapshot sendet: aus der Adresse ableitbar, damit
+    // ein Cold-Record, der nicht zu seinem Hot-Record passt, auffällt
+    void snapshotDeviceName(MacKey key, char* out) {
+        snprintf(out, 8, "N%04X", (unsigned)(key & 0xFFFF));
+    }
+
+    struct SnapshotCheck {
+        uint64_t reads;
+        uint64_t errors;
+        uint64_t rows;
+    };
+
+    void checkSnapshot(const DeviceSnapshot& snapshot, int capacity, uint32_t& lastEpoch, SnapshotCheck& check) {
+        bool ok = snapshot.epoch >= lastEpoch && snapshot.deviceCount <= capacity;
+        lastEpoch = snapshot.epoch;
+        int active = 0, present = 0;
+        char expected[8];
+        for (int i = 0; i < snapshot.deviceCount; i++) {
+            const DeviceHot& device = snapshot.hot[i];
+            if (device.isActive()) active++;
+            if (device.isPresent()) present++;
+            snapshotDeviceName(device.key(), expected);
+            if (strcmp(snapshot.cold[i].name, expected) != 0) ok = false;
+            for (int j = 0; j < i; j++) {
+                if (snapshot.hot[j].key() == device.key()) ok = false;
+            }
+        }
+        int trigger = snapshot.presenceTrigger;
+        bool triggerOk = (present == 0) ? trigger < 0 : (trigger >= 0 && trigger < snapshot.deviceCount && snapshot.hot[trigger].isPresent());
+        if (active != snapshot.activeCount || present != snapshot.presentCount || !triggerOk) ok = false;
+        check.reads++;
+        check.rows += (uint64_t)snapshot.deviceCount;
+        if (!ok) check.errors++;
+    }
+
+    int cmdSnapshot() {
+        // Ingest (BLE-Callback + Ingest-Task) in einem Thread, Web-Task mit Known-Änderungen
+        // und ein zweiter Leser dagegen. Jede gelesene Sicht muss in sich stimmig sein.
+        const int adverts = 300000;
+        const int phaseLength = 20000;      // danach wechselt der Adressbereich, alte Geräte laufen ab
+        const int addressesPerPhase = 48;   // mehr als capacity: LRU-Verdrängung
+        const int capacity = 32;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        memset(deviceTable, 0, sizeof(deviceTable));
+        memset(deviceDetails, 0, sizeof(deviceDetails));
+
+        DeviceManager* deviceManager = new DeviceManager();
+        deviceManager->begin(deviceTable, deviceDetails, capacity);
+        BluetoothScanner scanner;
+        scanner.setScanMode(SCAN_MODE_CONTINUOUS);
+        scanner.setStreaming(true);
+        if (!scanner.begin(deviceManager)) return 1;
+        scanner.performAutomaticScanCycle();
+
+        auto addressFor = [&](int phase, int slot, uint8_t* bda) {
+            int id = phase * addressesPerPhase + slot;
+            uint8_t mac[6] = {0x02, 0x5E, 0x00, 0x00, (uint8_t)(id >> 8), (uint8_t)id};
+            memcpy(bda, mac, 6);
+        };
+
+        std::atomic<bool> ingestDone(false);
+        uint64_t maxBatchNanos = 0;
+        std::thread ingest([&]() {
+            uint64_t state = 0x6A09E667F3BCC909ULL;
+            for (int i = 0; i < adverts; i++) {
+                hostSetMillis((unsigned long)i * 10);
+                uint64_t r = xorshift64(state);
+                uint8_t bda[6];
+                addressFor(i / phaseLength, (int)(r % addressesPerPhase), bda);
+                char name[8];
+                snapshotDeviceName(macKeyFromBytes(bda), name);
+                uint8_t payload[12] = {0x02, 0x01, 0x06, (uint8_t)(strlen(name) + 1), 0x09};
+                memcpy(payload + 5, name, strlen(name));
+                BLEDevice::hostDeliverScanResult(bda, -40 - (int)((r >> 16) % 50), payload, 5 + strlen(name));
+                auto start = std::chrono::steady_clock::now();
+                scanner.processPending();
+                uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                if (ns > maxBatchNanos) maxBatchNanos = ns;
+                if ((i & 7) == 7) std::this_thread::yield();
+            }
+            ingestDone.store(true, std::memory_order_release);
+        });
+
+        SnapshotCheck webCheck = {0, 0, 0}, readerCheck = {0, 0, 0};
+        uint64_t knownToggles = 0, commentErrors = 0;
+        std::thread web([&]() {
+            // Web-Task: liest Snapshots samt Kommentar und ändert ab und zu die Known-Liste
+            uint32_t lastEpoch = 0;
+            SafeDevice entry;
+            char mac[18];
+            for (uint64_t n = 0; !ingestDone.load(std::memory_order_acquire); n++) {
+                {
+                    DeviceManager::Snapshot snapshot(*deviceManager);
+                    checkSnapshot(*snapshot, capacity, lastEpoch, webCheck);
+                    for (int i = 0; i < snapshot->deviceCount; i++) {
+                        if (!deviceManager->getDevice(*snapshot, i, entry)) commentErrors++;
+                        else if (entry.comment[0] != '\0' && strcmp(entry.comment, "Web") != 0) commentErrors++;
+                    }
+                }
+                if ((n & 15) == 15) {
+                    uint8_t bda[6];
+                    addressFor((int)((n >> 4) % (adverts / phaseLength)), (int)((n >> 4) % addressesPerPhase), bda);
+                    formatMacKey(macKeyFromBytes(bda), mac);
+                    DeviceManager::Lock lock(*deviceManager);
+                    if (deviceManager->isKnownDevice(mac)) deviceManager->removeKnownDevice(mac);
+                    else deviceManager->addKnownDevice(mac, "Web", -60);
+                    deviceManager->publishSnapshot();
+                    knownToggles++;
+                }
+                std::this_thread::yield();
+            }
+        });
+        std::thread reader([&]() {
+            uint32_t lastEpoch = 0;
+            while (!ingestDone.load(std::memory_order_acquire)) {
+                {
+                    DeviceManager::Snapshot snapshot(*deviceManager);
+                    checkSnapshot(*snapshot, capacity, lastEpoch, readerCheck);
+                }
+                std::this_thread::yield();
+            }
+        });
+        ingest.join();
+        web.join();
+        reader.join();
+
+        // Verschobene Veröffentlichung: Leser hält den alten Puffer, der Ingest ändert weiter
+        bool skipOk;
+        {
+            DeviceManager::Snapshot pinned(*deviceManager);
+            uint32_t pinnedEpoch = pinned->epoch;
+            bool first, second;
+            {
+                DeviceManager::Lock lock(*deviceManager);
+                first = deviceManager->publishSnapshot();   // füllt den anderen Puffer
+                second = deviceManager->publishSnapshot();  // bräuchte den festgehaltenen
+            }
+            uint8_t bda[6] = {0x02, 0x5E, 0xFF, 0xFF, 0x00, 0x01};
+            char name[8];
+            snapshotDeviceName(macKeyFromBytes(bda), name);
+            uint8_t payload[12] = {0x02, 0x01, 0x06, (uint8_t)(strlen(name) + 1), 0x09};
+            memcpy(payload + 5, name, strlen(name));
+            BLEDevice::hostDeliverScanResult(bda, -50, payload, 5 + strlen(name));
+            scanner.processPending();
+            skipOk = first && !second && pinned->epoch == pinnedEpoch && deviceManager->hasPendingSnapshot();
+        }
+
+        // Ohne Leser muss der nächste Stand genau der Live-Tabelle entsprechen
+        bool finalOk;
+        {
+            DeviceManager::Lock lock(*deviceManager);
+            deviceManager->publishSnapshot();
+            DeviceManager::Snapshot snapshot(*deviceManager);
+            int count = deviceManager->getDeviceCount();
+            finalOk = snapshot->deviceCount == count &&
+                      memcmp(snapshot->hot, deviceManager->getDeviceTable(), count * sizeof(DeviceHot)) == 0 &&
+                      memcmp(snapshot->cold, deviceDetails, count * sizeof(DeviceCold)) == 0 &&
+                      snapshot->activeCount == deviceManager->getActiveCount() &&
+                      snapshot->presentCount == deviceManager->getPresentCount();
+        }
+
+        bool ok = webCheck.errors == 0 && readerCheck.errors == 0 && commentErrors == 0 && skipOk && finalOk &&
+                  webCheck.reads > 0 && readerCheck.reads > 0;
+        printf("== snapshot capacity=%d adverts=%d snapshot_bytes=%zu ==\n", capacity, adverts, sizeof(DeviceSnapshot));
+        printf("epochs:                %u veröffentlicht, %u verschoben (Leser im freien Puffer)\n",
+               deviceManager->getSnapshotEpoch(), deviceManager->getSnapshotSkips());
+        printf("web_reads:             %llu Stände, %llu Zeilen, %llu fehlerhaft, %llu Kommentarfehler, %llu Known-Änderungen\n",
+               (unsigned long long)webCheck.reads, (unsigned long long)webCheck.rows, (unsigned long long)webCheck.errors,
+               (unsigned long long)commentErrors, (unsigned long long)knownToggles);
+        printf("reader_reads:          %llu Stände, %llu Zeilen, %llu fehlerhaft\n",
+               (unsigned long long)readerCheck.reads, (unsigned long long)readerCheck.rows, (unsigned long long)readerCheck.errors);
+        printf("ingest_batch_max:      %llu ns (Ingest wartet nie auf Leser), evictions %u\n",
+               (unsigned long long)maxBatchNanos, deviceManager->getEvictionCount());
+        printf("pinned_reader:         %s\n", skipOk ? "Veröffentlichung verschoben, alter Stand unverändert" : "FEHLER");
+        printf("final_snapshot:        %s\n", finalOk ? "entspricht der Live-Tabelle" : "weicht ab");
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        scanner.end();
+        delete deviceManager;
+        return ok ? 0 : 1;
+    }
+
+    int cmdAdParse(int argc, char** argv) {
+        // Ohne Trace: synthetische Umgebung als Saat für Mutationen und Benchmark
+        Trace trace;
+        uint32_t iterations = 1000000;
+        uint64_t seed = 0x853C49E6748FEA9BULL;
+        int first = 2;
+        if (argc > 2 && strncmp(argv[2], "--", 2) != 0) {
+            std::string error;
+            if (!loadTrace(argv[2], trace, error)) {
+                fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+            first = 3;
+        } else {
+            TraceGeneratorConfig config = defaultGeneratorConfig();
+            config.durationSec = 60;
+            generateTrace(config, trace);
+        }
+        for (int i = first; i < argc; i++) {
+            if (i + 1 >= argc) {
+                usage();
+                return 2;
+            }
+            if (strcmp(argv[i], "--iterations") == 0) iterations = (uint32_t)strtoul(argv[++i], nullptr, 10);
+            else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[++i], nullptr, 10);
+            else {
+                usage();
+                return 2;
+            }
+        }
+        printf("== adparse %zu Trace-Payloads ==\n", trace.events.size());
+        bool ok = fuzzAdParser(iterations, seed, &trace);
+        benchAdParser(trace);
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    const char* decodeRuuvi(const uint8_t* data, size_t length) {
+        return length >= 1 && data[0] == 0x05 ? "Ruuvi Tag" : nullptr;
+    }
+
+    int cmdVendors() {
+        bool ok = true;
+
+        // Binärsuche gegen lineare Suche über alle 65536 IDs
+        size_t count = 0;
+        const CompanyIdentifier* table = getCompanyIdentifiers(count);
+        int mismatches = 0;
+        for (uint32_t id = 0; id <= 0xFFFF; id++) {
+            const char* expected = nullptr;
+            for (size_t i = 0; i < count; i++) {
+                if (table[i].id == id) expected = table[i].name;
+            }
+            if (lookupCompanyName((uint16_t)id) != expected) mismatches++;
+        }
+        if (mismatches != 0) ok = false;
+
+        // Kosten pro Suche, bekannte und unbekannte IDs gemischt
+        const int rounds = 200;
+        AllocSnapshot before = AllocCounter::snapshot();
+        auto start = std::chrono::steady_clock::now();
+        const char* volatile sink = nullptr;
+        for (int round = 0; round < rounds; round++) {
+            for (uint32_t id = 0; id < 0x1000; id++) sink = lookupCompanyName((uint16_t)id);
+        }
+        uint64_t nanos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        uint64_t lookupAllocs = AllocCounter::snapshot().count - before.count;
+        if (lookupAllocs != 0) ok = false;
+
+        // Decoder über den Ingest-Pfad: eingebauter Apple-Decoder und ein nachträglich registrierter
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        DeviceManager deviceManager;
+        deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+        BluetoothScanner scanner;
+        if (!registerVendorDecoder(0x0499, decodeRuuvi)) ok = false;
+        if (!scanner.begin(&deviceManager)) return 1;
+        // Nach dem Start ist die Registry gesperrt, der Ingest-Task liest sie ohne Sperre
+        bool lateRegistration = registerVendorDecoder(0x0059, decodeRuuvi);
+        if (lateRegistration) ok = false;
+
+        struct Case {
+            uint8_t payload[8];
+            uint8_t length;
+            const char* manufacturer;
+            const char* deviceType;
+        };
+        static const Case cases[] = {
+            { {0x04, 0xFF, 0x4C, 0x00, 0x07}, 5, "Apple", "Apple AirPods" },
+            { {0x04, 0xFF, 0x4C, 0x00, 0x7E}, 5, "Apple", "Apple Device" },
+            { {0x04, 0xFF, 0x99, 0x04, 0x05}, 5, "Ruuvi Innovations", "Ruuvi Tag" },
+            { {0x04, 0xFF, 0x34, 0x12, 0x01}, 5, "Unknown (1234)", "Unknown" },
+        };
+        printf("== vendors companies=%zu table_bytes=%zu ==\n", count, count * sizeof(CompanyIdentifier));
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            AdvertRecord advert = {};
+            uint8_t mac[6] = {0x02, 0x7E, 0x00, 0x00, 0x00, (uint8_t)(i + 1)};
+            memcpy(advert.address, mac, sizeof(mac));
+            advert.rssi = -60;
+            advert.payloadLength = cases[i].length;
+            memcpy(advert.payload, cases[i].payload, cases[i].length);
+            scanner.processDevice(advert);
+
+            char address[18];
+            formatMacKey(macKeyFromBytes(mac), address);
+            SafeDevice device;
+            bool found = deviceManager.getDevice(deviceManager.findDevice(address), device);
+            bool match = found && strcmp(device.manufacturer, cases[i].manufacturer) == 0 &&
+                         strcmp(device.deviceType, cases[i].deviceType) == 0;
+            printf("decode %02x%02x:           %-20s %-16s %s\n", cases[i].payload[3], cases[i].payload[2],
+                   found ? device.manufacturer : "-", found ? device.deviceType : "-", match ? "ok" : "FEHLER");
+            if (!match) ok = false;
+        }
+        scanner.end();
+
+        printf("late_registration:     %s\n", lateRegistration ? "angenommen (FEHLER)" : "abgelehnt");
+        printf("lookup_mismatches:     %d von 65536 IDs\n", mismatches);
+        printf("lookup:                %.1f ns, %llu Allokationen\n",
+               (double)nanos / (rounds * 0x1000), (unsigned long long)lookupAllocs);
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    int cmdStats() {
+        // Geräte mit festem Intervall und gleichverteiltem Versatz; nach der Hälfte eine Pause
+        // über ABSENCE_TIMEOUT_MAX_MS. Unbekannte Geräte werden entfernt und beginnen neu, bekannte
+        // bleiben stehen - der Abstand über die Pause darf nicht in die Statistik eingehen.
+        struct Profile {
+            uint32_t intervalMs;
+            uint32_t jitterMs;
+            bool known;
+        };
+        static const Profile profiles[] = {
+            {100, 10, false}, {250, 50, true}, {1000, 200, false}, {2000, 1000, true}, {5000, 500, false},
+        };
+        const int packetsPerDevice = 400;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        DeviceManager deviceManager;
+        deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+
+        bool ok = true;
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        printf("== stats sizeof(DeviceStats)=%zu ==\n", sizeof(DeviceStats));
+        printf("%8s %6s %8s %9s %9s %9s %9s %9s\n", "interval", "known", "packets", "mean_ms", "exact", "sd_ms", "exact", "rssi");
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+            const Profile& profile = profiles[p];
+            MacKey key = 0x02A000000000ULL + p;
+            char address[18];
+            formatMacKey(key, address);
+            if (profile.known) deviceManager.addKnownDevice(address, "stats", DEFAULT_RSSI_THRESHOLD);
+
+            unsigned long now = 1000;
+            double sum = 0.0, sumSq = 0.0;
+            int count = 0, packets = 0, expectedMin = 127, expectedMax = -128;
+            for (int i = 0; i < packetsPerDevice; i++) {
+                uint32_t step = profile.intervalMs - profile.jitterMs + (uint32_t)(xorshift64(state) % (2 * profile.jitterMs + 1));
+                bool gap = i == packetsPerDevice / 2;
+                if (gap) {
+                    step = ABSENCE_TIMEOUT_MAX_MS + 5000;  // Gerät war weg
+                    hostSetMillis(now + ABSENCE_TIMEOUT_MAX_MS + 1);
+                    deviceManager.cleanupOldDevices();
+                    if (!profile.known) {
+                        sum = sumSq = 0.0;
+                        count = packets = 0;
+                        expectedMin = 127;
+                        expectedMax = -128;
+                    }
+                } else if (packets > 0) {
+                    sum += step;
+                    sumSq += (double)step * step;
+                    count++;
+                }
+                now += step;
+                hostSetMillis(now);
+                int rssi = -95 + (int)(xorshift64(state) % 50);
+                expectedMin = std::min(expectedMin, rssi);
+                expectedMax = std::max(expectedMax, rssi);
+                packets++;
+                deviceManager.updateDevice(key, "", rssi);
+            }
+
+            SafeDevice device;
+            if (!deviceManager.getDevice(deviceManager.findDevice(address), device)) {
+                ok = false;
+                continue;
+            }
+            double mean = sum / count;
+            double sd = sqrt(std::max(0.0, sumSq / count - mean * mean));
+            double meanErr = fabs(device.intervalMeanMs - mean) / mean;
+            // EWMA über ~8 Abstände: Mittel auf 10 %, Streuung grob; RSSI-Grenzen und Pakete exakt
+            bool rowOk = (int)device.packets == packets && meanErr < 0.10 &&
+                         fabs((double)device.intervalStdDevMs - sd) <= 0.6 * sd + 2.0 &&
+                         device.rssiMin == expectedMin && device.rssiMax == expectedMax;
+            printf("%8u %6s %8u %9u %9.0f %9u %9.0f %4d..%d %s\n", profile.intervalMs, profile.known ? "ja" : "nein",
+                   device.packets, device.intervalMeanMs, mean, device.intervalStdDevMs, sd, device.rssiMin, device.rssiMax,
+                   rowOk ? "ok" : "FEHLER");
+            if (!rowOk) ok = false;
+        }
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    bool absenceModeSwitchCheck() {
+        // Start im Dauer-Scan, nach 2 Minuten Umschalten auf Zyklus und wieder zurück. Ein
+        // Telefon (200 ms) darf in keiner Scan-Pause wegfallen, und die Grenze muss jedem Wechsel
+        // folgen (mit fester Grenze aus BT_SCAN_MODE schlägt die Zeile fehl)
+        const uint32_t intervalMs = 200;
+        const unsigned long switchAt = 120000, backAt = 240000, silentAt = 360000;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        DeviceManager deviceManager;
+        deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+        BluetoothScanner scanner;
+        scanner.setScanMode(SCAN_MODE_CONTINUOUS);
+        if (!scanner.begin(&deviceManager)) return false;
+        MacKey key = 0x02B0000000FFULL;
+        char address[18];
+        formatMacKey(key, address);
+        deviceManager.addKnownDevice(address, "modus", DEFAULT_RSSI_THRESHOLD);
+
+        unsigned long nextCheck = ABSENCE_CHECK_MS;
+        int falseDepartures = 0;
+        auto checkUntil = [&](unsigned long until) {
+            while (nextCheck <= until) {
+                hostSetMillis(nextCheck);
+                falseDepartures += deviceManager.cleanupOldDevices();
+                nextCheck += ABSENCE_CHECK_MS;
+            }
+        };
+
+        uint32_t floors[3] = {deviceManager.getAbsenceMinMs(), 0, 0};
+        unsigned long now = 1000, lastAdvert = 0;
+        bool dutyCycle = false;
+        while (now < silentAt) {
+            if (!dutyCycle && now >= switchAt && now < backAt) {
+                checkUntil(now);
+                scanner.setScanMode(SCAN_MODE_DUTY_CYCLE);
+                floors[1] = deviceManager.getAbsenceMinMs();
+                dutyCycle = true;
+            } else if (dutyCycle && now >= backAt) {
+                checkUntil(now);
+                scanner.setScanMode(SCAN_MODE_CONTINUOUS);
+                floors[2] = deviceManager.getAbsenceMinMs();
+                dutyCycle = false;
+            }
+            bool heard = !dutyCycle || now % BT_SCAN_INTERVAL_MS < BT_SCAN_DURATION_SEC * 1000UL;
+            if (heard) {
+                checkUntil(now);
+                hostSetMillis(now);
+                deviceManager.updateDevice(key, "", -60);
+                lastAdvert = now;
+            }
+            now += intervalMs;
+        }
+
+        checkUntil(lastAdvert);
+        int departuresWhileSending = falseDepartures;
+        int deviceIndex = deviceManager.findDevice(address);
+        uint32_t timeoutMs = deviceManager.getDeviceStats()[deviceIndex].absenceTimeoutMs(deviceManager.getAbsenceMinMs());
+        unsigned long departedAt = 0;
+        while (departedAt == 0 && nextCheck <= lastAdvert + ABSENCE_TIMEOUT_MAX_MS) {
+            checkUntil(nextCheck);
+            if (!deviceManager.getDeviceTable()[deviceIndex].isActive()) departedAt = nextCheck - ABSENCE_CHECK_MS;
+        }
+        unsigned long latency = departedAt > 0 ? departedAt - lastAdvert : 0;
+        bool rowOk = floors[0] == ABSENCE_TIMEOUT_MIN_FOR(SCAN_MODE_CONTINUOUS) &&
+                     floors[1] == ABSENCE_TIMEOUT_MIN_FOR(SCAN_MODE_DUTY_CYCLE) &&
+                     floors[2] == ABSENCE_TIMEOUT_MIN_FOR(SCAN_MODE_CONTINUOUS) && departuresWhileSending == 0 &&
+                     departedAt > 0 && latency <= timeoutMs + ABSENCE_CHECK_MS + (1UL << EXPIRY_TICK_SHIFT);
+        printf("%-16s %9u %10u %12lu %12s %7d %s (Grenze %u/%u/%u ms)\n", "Modus-Wechsel", intervalMs, timeoutMs, latency,
+               "-", departuresWhileSending, rowOk ? "ok" : "FEHLER", (unsigned)floors[0], (unsigned)floors[1],
+               (unsigned)floors[2]);
+        scanner.end();
+        return rowOk;
+    }
+
+    int cmdAbsence() {
+        // Bekannte Geräte senden 10 Minuten mit ihrem Intervall (±10 %) und verstummen dann.
+        // Gemessen wird die Zeit vom letzten Advertisement bis zur Abmeldung, geprüft werden
+        // Fehlalarme während des Sendens. Bereinigt wird wie im Ingest-Task alle ABSENCE_CHECK_MS.
+        struct Profile {
+            const char* label;
+            uint32_t intervalMs;
+            bool dutyCycle;  // nur in 2 s von 10 s empfangen (Zyklus-Scan)
+        };
+        static const Profile profiles[] = {
+            {"Telefon", 200, false}, {"Telefon/Zyklus", 200, true}, {"Beacon", 1000, false},
+            {"Sensor", 5000, false}, {"Tag", 30000, false},
+        };
+        const unsigned long sendMs = 600000;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+
+        bool ok = true;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        printf("== absence (N=%d, min %u ms, max %u ms, fest %u ms) ==\n", ABSENCE_MISSED_ADVERTS,
+               (unsigned)ABSENCE_TIMEOUT_MIN_FOR(BT_SCAN_MODE), (unsigned)ABSENCE_TIMEOUT_MAX_MS, (unsigned)DEVICE_TIMEOUT_MS);
+        printf("%-16s %9s %10s %12s %12s %7s\n", "profil", "interval", "timeout", "weg_nach_ms", "fest_ms", "fehl");
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+            const Profile& profile = profiles[p];
+            Preferences::eraseAll();
+            hostSetMillis(0);
+            DeviceManager deviceManager;
+            deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            MacKey key = 0x02B000000000ULL + p;
+            char address[18];
+            formatMacKey(key, address);
+            deviceManager.addKnownDevice(address, "absence", DEFAULT_RSSI_THRESHOLD);
+
+            // Bereinigung im festen Takt zwischen den Advertisements
+            unsigned long nextCheck = ABSENCE_CHECK_MS;
+            int falseDepartures = 0;
+            auto checkUntil = [&](unsigned long until) {
+                while (nextCheck <= until) {
+                    hostSetMillis(nextCheck);
+                    falseDepartures += deviceManager.cleanupOldDevices();
+                    nextCheck += ABSENCE_CHECK_MS;
+                }
+            };
+
+            unsigned long now = 1000, lastAdvert = 0;
+            while (now < sendMs) {
+                bool heard = !profile.dutyCycle || now % BT_SCAN_INTERVAL_MS < BT_SCAN_DURATION_SEC * 1000UL;
+                if (heard) {
+                    checkUntil(now);
+                    hostSetMillis(now);
+                    deviceManager.updateDevice(key, "", -60);
+                    lastAdvert = now;
+                }
+                uint32_t jitter = profile.intervalMs / 10;
+                now += profile.intervalMs - jitter + (uint32_t)(xorshift64(state) % (2 * jitter + 1));
+            }
+
+            checkUntil(lastAdvert);
+            int departuresWhileSending = falseDepartures;
+            int deviceIndex = deviceManager.findDevice(address);
+            uint32_t timeoutMs = deviceManager.getDeviceStats()[deviceIndex].absenceTimeoutMs(deviceManager.getAbsenceMinMs());
+            unsigned long departedAt = 0;
+            while (departedAt == 0 && nextCheck <= lastAdvert + ABSENCE_TIMEOUT_MAX_MS + 2 * ABSENCE_CHECK_MS) {
+                checkUntil(nextCheck);
+                if (!deviceManager.getDeviceTable()[deviceIndex].isActive()) departedAt = nextCheck - ABSENCE_CHECK_MS;
+            }
+            unsigned long latency = departedAt > 0 ? departedAt - lastAdvert : 0;
+            // Bisher: fester Timeout, geprüft alle BT_SCAN_INTERVAL_MS
+            unsigned long fixedMs = DEVICE_TIMEOUT_MS + BT_SCAN_INTERVAL_MS / 2;
+            bool rowOk = departuresWhileSending == 0 && departedAt > 0 && latency > timeoutMs &&
+                         latency <= timeoutMs + ABSENCE_CHECK_MS + (1UL << EXPIRY_TICK_SHIFT);
+            printf("%-16s %9u %10u %12lu %12lu %7d %s\n", profile.label, profile.intervalMs, timeoutMs, latency, fixedMs,
+                   departuresWhileSending, rowOk ? "ok" : "FEHLER");
+            if (!rowOk) ok = false;
+        }
+        if (!absenceModeSwitchCheck()) ok = false;
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    int cmdExpiry() {
+        // Bereinigung bei 1/4, 1/2 und voller Tabelle, ohne und mit Wechsel: pro Sekunde
+        // verstummen `leave` Geräte und ebenso viele neue kommen hinzu. Alle senden jede
+        // Sekunde (±10 %). Gezählt werden die von cleanupOldDevices() geprüften Geräte;
+        // die bisherige Schleife hätte bei jedem Aufruf die ganze Tabelle angesehen.
+        const unsigned long durationMs = 600000;
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        const int capacities[] = {MAX_DEVICES / 4, MAX_DEVICES / 2, MAX_DEVICES};
+
+        bool ok = true;
+        printf("== expiry MAX_DEVICES=%d, Zeitrad %d Slots à %u ms, Umzug %zu Byte ==\n", MAX_DEVICES, EXPIRY_WHEEL_SLOTS,
+               1u << EXPIRY_TICK_SHIFT, sizeof(DeviceHot) + sizeof(DeviceCold) + sizeof(DeviceStats));
+        printf("%8s %6s %10s %10s %10s %10s %10s\n", "tabelle", "wechsel", "weg/s", "geprüft/s", "sweep/s", "ns/aufruf", "");
+        for (int capacity : capacities) {
+            for (int churn = 0; churn < 2; churn++) {
+                Preferences::eraseAll();
+                hostSetMillis(0);
+                DeviceManager deviceManager;
+                deviceManager.begin(deviceTable, deviceDetails, capacity);
+
+                // Population mit Platz für die Abgänge bis zu ihrem Timeout, damit nichts verdrängt wird
+                struct Sender {
+                    MacKey key;
+                    unsigned long nextAdvert;
+                };
+                int population = capacity * 3 / 8;
+                int leave = churn ? std::max(1, capacity / 64) : 0;
+                std::vector<Sender> senders;
+                uint64_t state = 0xD1B54A32D192ED03ULL ^ (uint64_t)capacity;
+                MacKey nextKey = 0x02C000000000ULL;
+                for (int i = 0; i < population; i++) {
+                    senders.push_back(Sender{nextKey++, (unsigned long)(xorshift64(state) % 1000)});
+                }
+
+                uint64_t cleanupNanos = 0, sweepRows = 0;
+                int cleanups = 0, expired = 0;
+                size_t rotation = 0;
+                uint32_t checksBefore = deviceManager.getExpiryChecks();
+                for (unsigned long second = 1000; second <= durationMs; second += ABSENCE_CHECK_MS) {
+                    for (Sender& sender : senders) {
+                        while (sender.nextAdvert < second) {
+                            hostSetMillis(sender.nextAdvert);
+                            deviceManager.updateDevice(sender.key, "", -70);
+                            sender.nextAdvert += 900 + xorshift64(state) % 201;
+                        }
+                    }
+                    hostSetMillis(second);
+                    sweepRows += deviceManager.getDeviceCount();
+                    auto start = std::chrono::steady_clock::now();
+                    expired += deviceManager.cleanupOldDevices();
+                    cleanupNanos += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    cleanups++;
+
+                    // Wechsel erst nach der Einlaufphase, damit die Timeouts gemessen sind
+                    // und reihum, damit jedes Gerät vor dem Verstummen genug Abstände gemessen hat
+                    if (second >= 60000) {
+                        for (int i = 0; i < leave; i++) {
+                            size_t victim = (size_t)(rotation++ % senders.size());
+                            senders[victim] = Sender{nextKey++, second + xorshift64(state) % 1000};
+                        }
+                    }
+                }
+                uint32_t checks = deviceManager.getExpiryChecks() - checksBefore;
+
+                // Ohne Wechsel läuft nichts ab; jedes aktive Gerät wird etwa einmal pro Timeout neu eingeplant,
+                // ein verstummtes höchstens noch einmal, bevor es abläuft
+                double checksPerCleanup = (double)checks / cleanups;
+                double rearmBound = (double)population * ABSENCE_CHECK_MS / deviceManager.getAbsenceMinMs() + leave + 1.0;
+                bool rowOk = checksPerCleanup <= (double)expired / cleanups + rearmBound && (churn || expired == 0);
+                printf("%8d %6s %10.2f %10.2f %10.1f %10.0f %10s\n", capacity, churn ? "ja" : "nein",
+                       (double)expired / cleanups, checksPerCleanup, (double)sweepRows / cleanups,
+                       (double)cleanupNanos / cleanups, rowOk ? "ok" : "FEHLER");
+                if (!rowOk) ok = false;
+            }
+        }
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+
+    int cmdHll() {
+        // Synthetische Adressströme: n verschiedene Adressen, jede 1-4 mal gesehen
+        static const int cardinalities[] = {100, 1000, 10000, 50000, 100000};
+        const int streams = 20;
+        const double sigma = 1.04 / sqrt((double)HLL_REGISTERS);
+        bool ok = true;
+
+        printf("== hll registers=%d bytes=%d sigma=%.2f%% ==\n", HLL_REGISTERS, HLL_REGISTERS, sigma * 100);
+        printf("%8s %10s %10s %10s %12s\n", "n", "rms_err%", "max_err%", "mean_est", "bitfield256");
+        for (int n : cardinalities) {
+            double sumSq = 0.0, maxErr = 0.0, sumEst = 0.0;
+            int bitfieldCount = 0;
+            for (int stream = 0; stream < streams; stream++) {
+                HyperLogLog hll;
+                uint32_t bitfield[8] = {0};
+                uint64_t state = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)n << 20) ^ (uint64_t)(stream + 1);
+                for (int i = 0; i < n; i++) {
+                    MacKey key = xorshift64(state) & 0xFFFFFFFFFFFFULL;
+                    int repeats = 1 + (int)(xorshift64(state) % 4);
+                    for (int r = 0; r < repeats; r++) hll.add(key);
+                    // Bisheriges 256-Bit-Feld zum Vergleich
+                    uint8_t bit = (uint8_t)((key * 0x9E3779B97F4A7C15ULL) >> 56);
+                    bitfield[bit / 32] |= 1u << (bit % 32);
+                }
+                double est = hll.estimate();
+                double err = fabs(est - n) / n;
+                sumSq += err * err;
+                maxErr = std::max(maxErr, err);
+                sumEst += est;
+                if (stream == 0) {
+                    for (uint32_t word : bitfield) bitfieldCount += __builtin_popcount(word);
+                }
+            }
+            double rms = sqrt(sumSq / streams);
+            printf("%8d %10.2f %10.2f %10.0f %12d\n", n, rms * 100, maxErr * 100, sumEst / streams, bitfieldCount);
+            // Schranken: RMS unter 1.5 sigma, kein Strom über 4 sigma
+            if (rms > 1.5 * sigma || maxErr > 4 * sigma) ok = false;
+        }
+
+        // Checkpoint über NVS: Schätzung muss einen Neustart überstehen
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        Preferences::eraseAll();
+        hostSetMillis(0);
+        int before = 0;
+        {
+            DeviceManager manager;
+            manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            uint64_t state = 42;
+            for (int i = 0; i < 5000; i++) {
+                manager.updateDevice((MacKey)(xorshift64(state) & 0xFFFFFFFFFFFFULL), "", -70);
+            }
+            manager.checkpointEverSeen(true);
+            before = manager.getTotalEverSeen();
+        }
+        DeviceManager restarted;
+        restarted.begin(deviceTable, deviceDetails, MAX_DEVICES);
+        int after = restarted.getTotalEverSeen();
+        printf("checkpoint: %d vor Neustart, %d danach\n", before, after);
+        if (before != after || before == 0) ok = false;
+
+        printf("%s\n", ok ? "OK" : "FEHLER: Fehlerschranke überschritten");
+        return ok ? 0 : 1;
+    }
+    struct KnownFixture {
+        char mac[18];
+        char comment[MAX_COMMENT_LENGTH];
+        int threshold;
+        PresenceTuning tuning;
+    };
+
+    void makeKnownFixture(int count, std::vector<KnownFixture>& fixture) {
+        uint64_t state = 0xA5A5F00DULL ^ (uint64_t)count;
+        fixture.resize(count);
+        for (int i = 0; i < count; i++) {
+            KnownFixture& entry = fixture[i];
+            formatMacKey(0x02D000000000ULL + (MacKey)i * 7919, entry.mac);
+            int length = snprintf(entry.comment, sizeof(entry.comment), "Gerät %d", i);
+            int extra = (int)(xorshift64(state) % 20);
+            for (int c = 0; c < extra && length < (int)sizeof(entry.comment) - 1; c++) entry.comment[length++] = 'a' + c;
+            entry.comment[length] = '\0';
+            entry.threshold = -40 - (int)(xorshift64(state) % 50);
+            entry.tuning = defaultPresenceTuning();
+            entry.tuning.enterMargin = (int8_t)(xorshift64(state) % 10);
+            entry.tuning.exitDwellMs = (uint16_t)(xorshift64(state) % 10000);
+        }
+    }
+
+    void writeLegacyKnownList(const std::vector<KnownFixture>& fixture) {
+        // Bisheriges saveKnownDevices(): vier Schlüssel pro Gerät
+        Preferences preferences;
+        preferences.begin("known_devices", false);
+        preferences.putInt("count", (int)fixture.size());
+        for (size_t i = 0; i < fixture.size(); i++) {
+            String macKey = "mac" + String((int)i);
+            String commentKey = "comment" + String((int)i);
+            String thresholdKey = "threshold" + String((int)i);
+            String tuningKey = "tuning" + String((int)i);
+            preferences.putString(macKey.c_str(), fixture[i].mac);
+            preferences.putString(commentKey.c_str(), fixture[i].comment);
+            preferences.putInt(thresholdKey.c_str(), fixture[i].threshold);
+            preferences.putBytes(tuningKey.c_str(), &fixture[i].tuning, sizeof(PresenceTuning));
+        }
+        preferences.end();
+    }
+
+    bool knownListMatches(DeviceManager& manager, const std::vector<KnownFixture>& fixture) {
+        if (manager.getKnownCount() != (int)fixture.size()) return false;
+        // Die Liste ist nach MAC sortiert, die Fixture nicht: pro Adresse vergleichen
+        for (size_t i = 0; i < fixture.size(); i++) {
+            MacKey key = 0;
+            parseMacKey(fixture[i].mac, key);
+            int k = manager.findKnown(key);
+            if (k < 0 ||
+                strcmp(manager.getKnownComments()[k], fixture[i].comment) != 0 ||
+                manager.getKnownRSSIThresholds()[k] != fixture[i].threshold ||
+                memcmp(&manager.getKnownTunings()[k], &fixture[i].tuning, sizeof(PresenceTuning)) != 0) {
+                return false;
+            }
+        }
+        for (int i = 1; i < manager.getKnownCount(); i++) {
+            if (manager.getKnownKeys()[i - 1] >= manager.getKnownKeys()[i]) return false;
+        }
+        return true;
+    }
+
+    double elapsedMicros(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int cmdNvs() {
+        // Known-Liste in NVS: bisherige Einzel-Schlüssel gegen den Blob, gemessen am In-Memory-NVS
+        // des Hosts (Zugriffe und Bytes sind das, was auf dem Gerät Flash kostet)
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        const int counts[] = {std::min(20, MAX_KNOWN), std::min(100, MAX_KNOWN), MAX_KNOWN};
+        bool ok = true;
+
+        printf("== nvs Known-Liste, MAX_KNOWN=%d ==\n", MAX_KNOWN);
+        printf("%6s %-12s %8s %8s %10s %12s\n", "geräte", "vorgang", "zugriffe", "commits", "bytes", "us");
+        for (int count : counts) {
+            std::vector<KnownFixture> fixture;
+            makeKnownFixture(count, fixture);
+            Preferences::eraseAll();
+            hostSetMillis(0);
+
+            auto row = [&](const char* operation, double micros) {
+                const HostNvsStats& stats = Preferences::stats();
+                printf("%6d %-12s %8lu %8lu %10lu %12.1f\n", count, operation, stats.writes + stats.reads, stats.commits,
+                       stats.bytesWritten, micros);
+            };
+
+            // Bisheriges Speichern der ganzen Liste
+            Preferences::resetStats();
+            auto start = std::chrono::steady_clock::now();
+            writeLegacyKnownList(fixture);
+            row("alt_save", elapsedMicros(start));
+
+            // Erster Start: alte Schlüssel lesen und in den Blob überführen
+            bool migrated, reloaded, saved, legacyGone, corruptRejected;
+            {
+                Preferences::resetStats();
+                DeviceManager manager;
+                start = std::chrono::steady_clock::now();
+                manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+                row("migration", elapsedMicros(start));
+                migrated = knownListMatches(manager, fixture);
+
+                Preferences preferences;
+                preferences.begin("known_devices", true);
+                legacyGone = !preferences.isKey("count") && !preferences.isKey("mac0") && preferences.isKey("known");
+                preferences.end();
+            }
+
+            // Normaler Start aus dem Blob
+            {
+                Preferences::resetStats();
+                DeviceManager manager;
+                start = std::chrono::steady_clock::now();
+                manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+                row("blob_load", elapsedMicros(start));
+                reloaded = knownListMatches(manager, fixture);
+
+                // Ganze Liste als einen Blob schreiben
+                manager.addKnownDevice(fixture[count / 2].mac, "geändert", fixture[count / 2].threshold,
+                                       &fixture[count / 2].tuning);
+                Preferences::resetStats();
+                start = std::chrono::steady_clock::now();
+                manager.saveKnownDevices();
+                row("blob_save", elapsedMicros(start));
+                snprintf(fixture[count / 2].comment, sizeof(fixture[count / 2].comment), "geändert");
+                saved = Preferences::stats().writes == 1;
+            }
+            {
+                DeviceManager manager;
+                manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+                saved = saved && knownListMatches(manager, fixture);
+            }
+
+            // Beschädigter Blob (ein Bit im Kommentarbereich) muss an der CRC scheitern
+            {
+                Preferences preferences;
+                preferences.begin("known_devices", false);
+                std::vector<uint8_t> blob(preferences.getBytesLength("known"));
+                preferences.getBytes("known", blob.data(), blob.size());
+                blob[blob.size() - 1] ^= 0x01;
+                preferences.putBytes("known", blob.data(), blob.size());
+                preferences.end();
+
+                DeviceManager manager;
+                manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+                corruptRejected = manager.getKnownCount() == 0;
+            }
+
+            bool rowOk = migrated && legacyGone && reloaded && saved && corruptRejected;
+            printf("%6d %-12s %s%s%s%s%s%s\n", count, "prüfung", rowOk ? "ok" : "FEHLER: ", migrated ? "" : "migration ",
+                   legacyGone ? "" : "alte_schlüssel ", reloaded ? "" : "laden ", saved ? "" : "speichern ",
+                   corruptRejected ? "" : "crc");
+            if (!rowOk) ok = false;
+        }
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+    typedef std::map<std::string, std::string> KnownState;
+
+    KnownState captureKnown(DeviceManager& manager) {
+        // Reihenfolge der Liste zählt nicht, nur Inhalt pro Adresse
+        KnownState state;
+        for (int i = 0; i < manager.getKnownCount(); i++) {
+            char value[MAX_COMMENT_LENGTH + 32];
+            const PresenceTuning& tuning = manager.getKnownTunings()[i];
+            snprintf(value, sizeof(value), "%s|%d|%d|%d|%u|%u|%u", manager.getKnownComments()[i],
+                     (int)manager.getKnownRSSIThresholds()[i], tuning.enterMargin, tuning.exitMargin, tuning.filterShift,
+                     tuning.enterDwellMs, tuning.exitDwellMs);
+            char address[18];
+            formatMacKey(manager.getKnownKeys()[i], address);
+            state[address] = value;
+        }
+        return state;
+    }
+
+    struct DurableState {
+        unsigned long writeIndex;  // Schreibzugriff, mit dem der Stand in NVS steht
+        KnownState state;
+    };
+
+    void runKnownScript(DeviceManager& manager, std::vector<DurableState>* durable) {
+        // Feste Folge aus Einzeländerungen, Flushes, Importen und Verdichtungen
+        uint64_t state = 0x5EEDC0DEULL;
+        unsigned long now = 0;
+        int nextDevice = 0;
+        auto address = [](int device, char* out) { formatMacKey(0x02E000000000ULL + (MacKey)device * 104729, out); };
+        auto commit = [&](unsigned long writesBefore) {
+            if (durable && Preferences::stats().writes != writesBefore) {
+                durable->push_back(DurableState{writesBefore, captureKnown(manager)});
+            }
+        };
+
+        for (int step = 0; step < 1200; step++) {
+            int action = (int)(xorshift64(state) % 20);
+            char mac[18];
+            char comment[MAX_COMMENT_LENGTH];
+            snprintf(comment, sizeof(comment), "s%d-%d", step, (int)(xorshift64(state) % 1000));
+            unsigned long writesBefore = Preferences::stats().writes;
+            if (action < 8 || nextDevice < 4) {
+                address(nextDevice++, mac);
+                PresenceTuning tuning = defaultPresenceTuning();
+                tuning.exitDwellMs = (uint16_t)(xorshift64(state) % 5000);
+                manager.addKnownDevice(mac, comment, -50 - (int)(xorshift64(state) % 40), &tuning);
+            } else if (action < 12) {
+                address((int)(xorshift64(state) % nextDevice), mac);
+                manager.addKnownDevice(mac, comment, -60, nullptr);
+            } else if (action < 15) {
+                address((int)(xorshift64(state) % nextDevice), mac);
+                manager.removeKnownDevice(mac);
+            } else if (action < 19) {
+                // Takt aus loop(): schreibt erst nach KNOWN_FLUSH_DELAY_MS Ruhe
+                now += KNOWN_FLUSH_DELAY_MS / 2 + (unsigned long)(xorshift64(state) % KNOWN_FLUSH_DELAY_MS);
+                hostSetMillis(now);
+                manager.flushKnownDevices();
+                commit(writesBefore);
+            } else if (step % 4 == 0) {
+                manager.beginKnownBatch();
+                for (int i = 0; i < KNOWN_PENDING_MAX + 4; i++) {
+                    address(nextDevice++, mac);
+                    manager.addKnownDevice(mac, "import", -70, nullptr);
+                }
+                manager.endKnownBatch();
+                manager.flushKnownDevices(true);
+                commit(writesBefore);
+            } else if (step % 4 == 1) {
+                manager.saveKnownDevices();
+                commit(writesBefore);
+            } else {
+                manager.flushKnownDevices(true);
+                commit(writesBefore);
+            }
+        }
+        unsigned long writesBefore = Preferences::stats().writes;
+        manager.flushKnownDevices(true);
+        commit(writesBefore);
+    }
+
+    int cmdJournal() {
+        // Known-Liste: Journal-Einträge für Einzeländerungen, ein Schreibzugriff pro Import,
+        // und nach einem Stromausfall an jeder Stelle ein bestätigter Stand
+        static DeviceHot deviceTable[MAX_DEVICES];
+        static DeviceCold deviceDetails[MAX_DEVICES];
+        const int base = std::min(100, MAX_KNOWN - 2);
+        bool ok = true;
+
+        printf("== journal Known-Liste, %d Geräte, Verzögerung %d ms, %d Einträge bis zur Verdichtung ==\n", base,
+               KNOWN_FLUSH_DELAY_MS, KNOWN_JOURNAL_MAX);
+        printf("%-24s %8s %10s %10s\n", "vorgang", "zugriffe", "bytes", "us");
+        auto row = [](const char* operation, double micros) {
+            const HostNvsStats& stats = Preferences::stats();
+            printf("%-24s %8lu %10lu %10.1f\n", operation, stats.writes, stats.bytesWritten, micros);
+        };
+
+        Preferences::eraseAll();
+        Preferences::setWriteBudget(-1);
+        hostSetMillis(0);
+        std::vector<KnownFixture> fixture;
+        makeKnownFixture(base + 1, fixture);
+        {
+            DeviceManager manager;
+            manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+
+            // Import: bisher ein vollständiges Speichern pro Gerät
+            unsigned long legacyWrites = 0;
+            for (int i = 1; i <= base; i++) legacyWrites += 4 * (unsigned long)i + 1;
+            Preferences::resetStats();
+            auto start = std::chrono::steady_clock::now();
+            manager.beginKnownBatch();
+            for (int i = 0; i < base; i++) {
+                manager.addKnownDevice(fixture[i].mac, fixture[i].comment, fixture[i].threshold, &fixture[i].tuning);
+            }
+            manager.endKnownBatch();
+            manager.flushKnownDevices(true);
+            row("import", elapsedMicros(start));
+            printf("%-24s %8lu %10s %10s (Einzel-Schlüssel, pro Gerät gespeichert)\n", "import_alt", legacyWrites, "", "");
+            if (Preferences::stats().writes != 1) ok = false;
+
+            // Einzelne Änderung: vor Ablauf der Verzögerung nichts, danach nur ihr Eintrag
+            Preferences::resetStats();
+            manager.addKnownDevice(fixture[base].mac, fixture[base].comment, fixture[base].threshold, &fixture[base].tuning);
+            hostSetMillis(KNOWN_FLUSH_DELAY_MS / 2);
+            manager.flushKnownDevices();
+            bool debounced = Preferences::stats().writes == 0;
+            hostSetMillis(KNOWN_FLUSH_DELAY_MS);
+            start = std::chrono::steady_clock::now();
+            manager.flushKnownDevices();
+            row("einzeländerung", elapsedMicros(start));
+            if (!debounced || Preferences::stats().writes != 1) ok = false;
+
+            // Mehrere Änderungen innerhalb der Verzögerung: ein Eintrag pro Adresse
+            Preferences::resetStats();
+            for (int i = 0; i < 5; i++) {
+                manager.addKnownDevice(fixture[0].mac, i % 2 ? "a" : "b", -60 - i, nullptr);
+            }
+            manager.removeKnownDevice(fixture[1].mac);
+            hostSetMillis(2 * KNOWN_FLUSH_DELAY_MS);
+            start = std::chrono::steady_clock::now();
+            manager.flushKnownDevices();
+            row("6_änderungen_2_geräte", elapsedMicros(start));
+            if (Preferences::stats().writes != 1) ok = false;
+
+            // Volles Journal: der nächste Flush schreibt die ganze Liste und räumt auf
+            unsigned long now = 2 * KNOWN_FLUSH_DELAY_MS;
+            while (manager.getKnownJournalCount() < KNOWN_JOURNAL_MAX) {
+                manager.addKnownDevice(fixture[2].mac, "voll", -61, nullptr);
+                now += KNOWN_FLUSH_DELAY_MS;
+                hostSetMillis(now);
+                manager.flushKnownDevices();
+            }
+            Preferences::resetStats();
+            manager.addKnownDevice(fixture[2].mac, "verdichtet", -62, nullptr);
+            hostSetMillis(now + KNOWN_FLUSH_DELAY_MS);
+            start = std::chrono::steady_clock::now();
+            manager.flushKnownDevices();
+            row("verdichtung", elapsedMicros(start));
+            if (manager.getKnownJournalCount() != 0) ok = false;
+
+            KnownState expected = captureKnown(manager);
+            DeviceManager restarted;
+            restarted.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            if (captureKnown(restarted) != expected) {
+                printf("FEHLER: Neustart liefert anderen Stand\n");
+                ok = false;
+            }
+        }
+
+        // Referenzlauf: nach welchem Schreibzugriff welcher Stand bestätigt ist
+        Preferences::eraseAll();
+        Preferences::resetStats();
+        hostSetMillis(0);
+        std::vector<DurableState> durable;
+        durable.push_back(DurableState{0, KnownState()});
+        {
+            DeviceManager manager;
+            manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            runKnownScript(manager, &durable);
+        }
+        unsigned long totalWrites = Preferences::stats().writes;
+
+        // Stromausfall nach jedem einzelnen Schreibzugriff; danach Neustart und eine weitere Änderung
+        int crashFailures = 0, resumeFailures = 0;
+        for (unsigned long crashAt = 0; crashAt <= totalWrites; crashAt++) {
+            Preferences::eraseAll();
+            Preferences::resetStats();
+            Preferences::setWriteBudget((long)crashAt);
+            hostSetMillis(0);
+            {
+                DeviceManager manager;
+                manager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+                runKnownScript(manager, nullptr);
+            }
+            Preferences::setWriteBudget(-1);
+
+            // Erwartet: letzter Stand, dessen bestätigender Zugriff noch durchkam
+            const KnownState* expected = &durable[0].state;
+            for (size_t i = 1; i < durable.size() && durable[i].writeIndex < crashAt; i++) expected = &durable[i].state;
+
+            DeviceManager restarted;
+            restarted.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            KnownState recovered = captureKnown(restarted);
+            if (recovered != *expected) crashFailures++;
+
+            restarted.addKnownDevice("02:ff:00:00:00:01", "nach neustart", -55, nullptr);
+            restarted.flushKnownDevices(true);
+            KnownState resumed = captureKnown(restarted);
+            DeviceManager again;
+            again.begin(deviceTable, deviceDetails, MAX_DEVICES);
+            if (captureKnown(again) != resumed) resumeFailures++;
+        }
+        printf("stromausfall:            %lu Stellen geprüft, %zu bestätigte Stände, %d falsch, %d nach Neustart falsch\n",
+               totalWrites + 1, durable.size() - 1, crashFailures, resumeFailures);
+        if (crashFailures > 0 || resumeFailures > 0) ok = false;
+
+        printf("%s\n", ok ? "OK" : "FEHLER");
+        return ok ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    if (strcmp(argv[1], "replay") == 0) return cmdReplay(argc, argv);
+    if (strcmp(argv[1], "generate") == 0) return cmdGenerate(argc, argv);
+    if (strcmp(argv[1], "synth") == 0) return cmdSynth(argc, argv);
+    if (strcmp(argv[1], "scale") == 0) return cmdScale(argc, argv);
+    if (strcmp(argv[1], "evict") == 0) return cmdEvict(argc, argv);
+    if (strcmp(argv[1], "scanmode") == 0) return cmdScanMode(argc, argv);
+    if (strcmp(argv[1], "gap") == 0) return cmdGap(argc, argv);
+    if (strcmp(argv[1], "smoothing") == 0) return cmdSmoothing(argc, argv);
+    if (strcmp(argv[1], "heap") == 0) return cmdHeap(argc, argv);
+    if (strcmp(argv[1], "ring") == 0) return cmdRing();
+    if (strcmp(argv[1], "snapshot") == 0) return cmdSnapshot();
+    if (strcmp(argv[1], "adparse") == 0) return cmdAdParse(argc, argv);
+    if (strcmp(argv[1], "vendors") == 0) return cmdVendors();
+    if (strcmp(argv[1], "stats") == 0) return cmdStats();
+    if (strcmp(argv[1], "absence") == 0) return cmdAbsence();
+    if (strcmp(argv[1], "expiry") == 0) return cmdExpiry();
+    if (strcmp(argv[1], "hll") == 0) return cmdHll();
+    if (strcmp(argv[1], "nvs") == 0) return cmdNvs();
+    if (strcmp(argv[1], "journal") == 0) return cmdJournal();
+    usage();
+    return 2;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file AdvertisementParser.h
+ * @brief Zerlegt Advertising- und Scan-Response-Daten in einem Durchlauf
+ *
+ * Der Parser läuft einmal über die AD-Strukturen ([Länge][Typ][Daten...])
+ * und liefert für jedes ausgewertete Feld nur Zeiger und Länge in den
+ * Roh-Payload - keine Kopie, kein Heap. Gilt jeweils das erste Vorkommen
+ * eines Typs; der vollständige Name hat Vorrang vor dem gekürzten.
+ */
+
+#ifndef ADVERTISEMENT_PARSER_H
+#define ADVERTISEMENT_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// AD-Typen (Bluetooth Core Spec Supplement, Teil A)
+#define AD_TYPE_FLAGS 0x01
+#define AD_TYPE_UUID16_INCOMPLETE 0x02
+#define AD_TYPE_UUID16_COMPLETE 0x03
+#define AD_TYPE_UUID32_INCOMPLETE 0x04
+#define AD_TYPE_UUID32_COMPLETE 0x05
+#define AD_TYPE_UUID128_INCOMPLETE 0x06
+#define AD_TYPE_UUID128_COMPLETE 0x07
+#define AD_TYPE_NAME_SHORT 0x08
+#define AD_TYPE_NAME_COMPLETE 0x09
+#define AD_TYPE_TX_POWER 0x0A
+#define AD_TYPE_SERVICE_DATA16 0x16
+#define AD_TYPE_APPEARANCE 0x19
+#define AD_TYPE_SERVICE_DATA32 0x20
+#define AD_TYPE_SERVICE_DATA128 0x21
+#define AD_TYPE_MANUFACTURER_DATA 0xFF
+
+/**
+ * @brief Ausschnitt des Payloads (nullptr = Feld nicht vorhanden)
+ */
+struct AdView {
+    const uint8_t* data;
+    uint8_t length;
+
+    bool present() const { return data != nullptr; }
+};
+
+/**
+ * @brief Ergebnis von parseAdStructures()
+ */
+struct AdFields {
+    AdView flags;              // AD-Flags (1 Byte)
+    AdView name;               // ohne Nullterminierung
+    bool nameComplete;
+    AdView manufacturerData;   // inkl. Company-ID (Little Endian) in den ersten 2 Byte
+    AdView serviceUuids16;     // Liste, length / 2 Einträge
+    AdView serviceUuids32;
+    AdView serviceUuids128;
+    AdView serviceData;        // inkl. Service-UUID am Anfang
+    uint8_t serviceDataUuidBytes;  // 2, 4 oder 16
+    bool haveTxPower;
+    int8_t txPower;            // dBm
+    bool haveAppearance;
+    uint16_t appearance;
+    uint8_t structureCount;    // gültige AD-Strukturen
+    bool malformed;            // Länge einer Struktur reicht über das Payload-Ende
+
+    bool hasServiceUuids() const { return serviceUuids16.present() || serviceUuids32.present() || serviceUuids128.present(); }
+};
+
+// Liefert false, wenn der Payload fehlerhaft endet; die Felder bis dahin sind gültig
+bool parseAdStructures(const uint8_t* payload, size_t length, AdFields& out);
+
+#endif // ADVERTISEMENT_PARSER_H
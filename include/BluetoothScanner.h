@@ -12,15 +12,41 @@
 #include <BLEDevice.h>
 #include <BLEScan.h>
 #include <BLEAdvertisedDevice.h>
+#include <esp_gap_ble_api.h>
 #include <esp_task_wdt.h>
+#include <atomic>
+#include "AdvertisementParser.h"
+#include "CompanyIdentifiers.h"
 #include "Config.h"
 #include "DeviceManager.h"
+#include "SpscQueue.h"
+#include "VendorDecoders.h"
+
+#define ADVERT_MAX_PAYLOAD 62  // 31 Byte Advertising + 31 Byte Scan Response
+
+/**
+ * @brief Kompaktes Advertisement für den Ring zwischen BLE-Task und Ingest-Task (76 Byte)
+ *
+ * Enthält nur Adresse, RSSI und Roh-Payload; alles Weitere (Name,
+ * Hersteller, Service-Daten) liest der Ingest-Task aus dem Payload.
+ */
+struct AdvertRecord {
+    uint32_t receivedMicros;  // micros() im Callback (für die Relais-Latenz)
+    uint8_t address[6];
+    int8_t rssi;
+    uint8_t payloadLength;
+    uint8_t payload[ADVERT_MAX_PAYLOAD];
+};
 
 // Forward declaration
 class BluetoothScanner;
 
 /**
- * @brief Callback-Klasse für gefundene BLE-Geräte
+ * @brief Callback-Klasse für gefundene BLE-Geräte (nur ohne BT_GAP_INGEST)
+ *
+ * Die Bibliothek übergibt jedes Ergebnis per Wert, also als Kopie samt
+ * std::string-Payload; der GAP-Pfad (BluetoothScanner::handleGapEvent)
+ * vermeidet beides.
  */
 class SafeAdvertisedDeviceCallbacks : public BLEAdvertisedDeviceCallbacks {
 private:
@@ -40,18 +66,42 @@ private:
     DeviceManager* deviceManager;
     SafeAdvertisedDeviceCallbacks* callbacks;
     
-    unsigned long lastScanTime;
     unsigned long lastSuccessfulScan;
     unsigned long lastBluetoothReset;
     unsigned long scanStartTime;        // Für automatische Scan-Zyklen
     bool scanCycleActive;               // True wenn im 2s+8s Zyklus
+    ScanMode scanMode;
+    bool streaming;                     // keine Ergebnisse in der BLEScan-Map behalten
+    bool gapIngest;                     // eigener GAP-Handler statt BLEScan (kein BLEAdvertisedDevice)
     int failedScansCount;
     bool currentlyScanning;
     bool initialized;
     
+    // Ring zwischen BLE-Callback (einziger Erzeuger) und Ingest-Task (einziger Verbraucher,
+    // besitzt die Gerätetabelle). Der Callback kopiert nur und kehrt sofort zurück.
+    SpscQueue<AdvertRecord, ADVERT_RING_SIZE> advertRing;
+    void (*ingestWakeup)(void* context);
+    void* ingestWakeupContext;
+    uint32_t ringDropCount;             // Ring voll, Advertisement verworfen (nur BLE-Task schreibt)
+    uint32_t currentAdvertMicros;       // Empfangszeit des gerade verarbeiteten Advertisements
+    unsigned long lastCleanup;
+    
+    void configureScan();
+    void restartScan();
+    void applyAbsenceFloor();  // Untergrenze der Abwesenheit an den Scan-Modus anpassen
+    bool startScan(uint32_t durationSec);  // 0 = ohne Zeitbegrenzung, nicht blockierend
+    void stopScan();
+    
+    // GAP-Handler des Bluetooth-Stacks (BTC-Task); es gibt nur einen, daher statisch
+    static BluetoothScanner* gapInstance;
+    static void handleGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+    void performContinuousScan();
+    
     // Statistics
     unsigned long sessionStartTime;
-    int totalDevicesSeen;
+    // BLE-/GAP-Task zählt, Web- und loop()-Task lesen
+    std::atomic<uint32_t> advertsReceived;    // alle Advertisements seit dem Start (keine Geräte)
+    std::atomic<uint32_t> advertsThisWindow;  // im laufenden Scan-Fenster
     
 public:
     BluetoothScanner();
@@ -63,23 +113,31 @@ public:
     bool isInitialized() const { return initialized; }
     
     // Scanning
-    void performScan();
-    void performAutomaticScanCycle();   // Neuer automatischer Scan-Zyklus
+    void performAutomaticScanCycle();   // Neuer automatischer Scan-Zyklus (bzw. Dauer-Scan)
+    void setScanMode(ScanMode mode);    // jederzeit, laufender Scan wird neu gestartet
+    ScanMode getScanMode() const { return scanMode; }
+    void setStreaming(bool enabled);    // false = Bibliothek sammelt Ergebnisse bis clearResults()
+    bool isStreaming() const { return streaming; }
+    void setGapIngest(bool enabled);    // false = Ergebnisse über BLEScan und onResult()
+    bool isGapIngest() const { return gapIngest; }
     void resetBluetooth();
     bool isScanning() const { return currentlyScanning; }
     
-    // Device processing (called by callback)
-    void processDevice(BLEAdvertisedDevice& advertisedDevice);
+    // BLE-Callback: Advertisement in den Ring legen (kein Zugriff auf den DeviceManager)
+    bool enqueueAdvert(const uint8_t* address, int rssi, const uint8_t* payload, size_t payloadLength);
+    bool enqueueAdvert(BLEAdvertisedDevice& advertisedDevice);
     
-    // Payload analysis
-    String getManufacturerName(uint16_t companyId);
-    String analyzeAppleDevice(uint8_t* data, size_t length);
-    String analyzeSamsungDevice(uint8_t* data, size_t length);
-    String analyzePayload(uint8_t* data, size_t length, uint16_t manufacturerId);
+    // Ingest-Task: Ring leeren, Geräte aktualisieren, alte Geräte bereinigen
+    int processPending();
+    void processDevice(const AdvertRecord& advert);
+    void setIngestWakeup(void (*wakeupFunction)(void* context), void* context = nullptr);
+    bool hasIngestTask() const { return ingestWakeup != nullptr; }
+    uint32_t getCurrentAdvertMicros() const { return currentAdvertMicros; }
+    uint32_t getRingDropCount() const { return ringDropCount; }
     
     // Statistics
     unsigned long getSessionStartTime() const { return sessionStartTime; }
-    int getTotalDevicesSeen() const { return totalDevicesSeen; }
+    uint32_t getAdvertsReceived() const { return advertsReceived.load(std::memory_order_relaxed); }
     unsigned long getLastSuccessfulScan() const { return lastSuccessfulScan; }
     int getFailedScansCount() const { return failedScansCount; }
 };
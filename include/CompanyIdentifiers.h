@@ -0,0 +1,30 @@
+/**
+ * @file CompanyIdentifiers.h
+ * @brief Bluetooth-SIG Company Identifiers (Hersteller der Manufacturer Data)
+ *
+ * Die Tabelle ist ein constexpr-Array, nach ID sortiert (zur Compile-Zeit
+ * geprüft) und liegt im Flash. Die Suche ist binär und liefert den
+ * statischen Namen ohne Kopie.
+ */
+
+#ifndef COMPANY_IDENTIFIERS_H
+#define COMPANY_IDENTIFIERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct CompanyIdentifier {
+    uint16_t id;
+    const char* name;  // höchstens 31 Zeichen (DeviceCold::manufacturer)
+};
+
+// Statischer Name oder nullptr, wenn die ID nicht in der Tabelle steht
+const char* lookupCompanyName(uint16_t companyId);
+
+// Name in out schreiben, unbekannte IDs als "Unknown (xxxx)"
+void formatCompanyName(uint16_t companyId, char* out, size_t outSize);
+
+// Gesamte Tabelle (aufsteigend nach ID), count = Anzahl Einträge
+const CompanyIdentifier* getCompanyIdentifiers(size_t& count);
+
+#endif // COMPANY_IDENTIFIERS_H
@@ -70,10 +70,47 @@ enum DeviceMode {
 #define BT_SCAN_INTERVAL_MS 10000       // 10 Sekunden Gesamtzyklus (2s scan + 8s pause)
 #define BT_SCAN_PAUSE_MS 8000           // 8 Sekunden Pause zwischen Scans
 #define BT_MAX_FAILED_SCANS 3           // Maximale Anzahl fehlgeschlagener Scans
+
+// Scan-Modus: Zyklus (2s aktiv scannen, 8s Pause) oder durchgehend passiv scannen.
+// Durchgehend: jedes Advertisement kommt sofort über den Callback, Duplikate filtert
+// die eigene Gerätetabelle; Namen, die nur in Scan-Responses stehen, fehlen dann.
+enum ScanMode {
+    SCAN_MODE_DUTY_CYCLE = 0,
+    SCAN_MODE_CONTINUOUS = 1
+};
+#define BT_SCAN_MODE SCAN_MODE_DUTY_CYCLE
+#define BT_SCAN_STREAMING true          // Advertisements nur im Callback verarbeiten, BLEScan behält keine Ergebnisse
+#define BT_GAP_INGEST true              // Scan-Ergebnisse direkt aus dem GAP-Ereignis lesen, ohne BLEScan/BLEAdvertisedDevice
+#define ADVERT_RING_SIZE 64             // Zweierpotenz; Puffer BLE-Callback -> Ingest-Task (76 Byte pro Eintrag)
+#define INGEST_TASK true                // eigener Task besitzt die Gerätetabelle (sonst leert loop() den Ring)
+#define INGEST_TASK_PRIORITY 4          // unter dem Relais-Task, über loop()
+#define INGEST_TASK_STACK_SIZE 4096
+#define INGEST_IDLE_MS 1000             // spätestens dann bereinigt der Task auch ohne Advertisements
 #define MAX_KNOWN_DEVICES 20
-#define DEVICE_TIMEOUT_MS 120000        // 2 Minuten bis Gerät als "weg" gilt
+#define DEVICE_TIMEOUT_MS 120000        // 2 Minuten bis Gerät als "weg" gilt (ohne gemessenes Intervall)
+// Abwesenheit nach dem eigenen Sendeintervall: weg, wenn ABSENCE_MISSED_ADVERTS erwartete
+// Advertisements (Mittel + 2 Streuungen) ausbleiben, begrenzt auf [MIN, MAX]. Im Zyklus-Modus
+// muss MIN über der Scan-Pause liegen, sonst fällt jedes Gerät in jeder Pause weg; die Grenze
+// folgt dem laufenden Modus (BluetoothScanner::setScanMode), BT_SCAN_MODE ist nur der Start.
+#define ABSENCE_MISSED_ADVERTS 5
+#define ABSENCE_MIN_INTERVALS 4         // erst ab so vielen gemessenen Abständen, vorher DEVICE_TIMEOUT_MS
+#define ABSENCE_TIMEOUT_MIN_MS 5000     // Dauer-Scan; im Zyklus-Modus kommt die Scan-Pause dazu
+#define ABSENCE_TIMEOUT_MIN_FOR(mode) ((mode) == SCAN_MODE_DUTY_CYCLE ? BT_SCAN_INTERVAL_MS + ABSENCE_TIMEOUT_MIN_MS : ABSENCE_TIMEOUT_MIN_MS)
+#define ABSENCE_TIMEOUT_MAX_MS 300000   // seltene Sender (Tags alle 30 s) fallen nicht zu früh weg
+#define ABSENCE_CHECK_MS 1000           // so oft prüft der Ingest-Task auf abgelaufene Geräte
 #define DEFAULT_RSSI_THRESHOLD -80      // Standard RSSI-Grenzwert in dBm
+// Glättung und Hysterese der Anwesenheit (Standard, pro bekanntem Gerät einstellbar)
+#define RSSI_FILTER_SHIFT 2             // EMA: neuer Messwert geht mit 1/2^n ein (0 = ungefiltert)
+#define PRESENCE_ENTER_MARGIN_DB 0      // anwesend ab Grenzwert + Marge (geglättet)
+#define PRESENCE_EXIT_MARGIN_DB 5       // abwesend erst unter Grenzwert - Marge
+#define PRESENCE_ENTER_DWELL_MS 0       // so lange muss die Eintrittsbedingung anhalten
+#define PRESENCE_EXIT_DWELL_MS 10000    // so lange muss die Austrittsbedingung anhalten (max. 60000)
 #define MAX_COMMENT_LENGTH 32           // Maximale Kommentarlänge für bekannte Geräte
+#define DEVICES_EVER_PERSIST true       // "devices ever seen"-Schätzer in NVS sichern (übersteht Neustart)
+#define DEVICES_EVER_CHECKPOINT_MS 900000  // höchstens alle 15 Minuten schreiben (Flash-Verschleiß)
+#define KNOWN_FLUSH_DELAY_MS 2000       // Known-Liste: Änderungen so lange sammeln, dann ein Journal-Eintrag
+#define KNOWN_PENDING_MAX 16            // Geräte pro Journal-Eintrag, mehr auf einmal schreibt die ganze Liste
+#define KNOWN_JOURNAL_MAX 16            // Journal-Einträge, danach wird die ganze Liste neu geschrieben
 
 // =================== LED KONFIGURATION ===================
 #define LED_BUILTIN_PIN 8
@@ -82,6 +119,10 @@ enum DeviceMode {
 
 // =================== RELAIS/OUTPUT KONFIGURATION ===================
 #define RELAY_OUTPUT_PIN 4  // GPIO 4 für Torsteuerung/Relais
+#define RELAY_EVENT_TASK true        // Relais direkt aus dem Scan-Callback schalten (eigener Task statt loop()-Polling)
+#define RELAY_TASK_PRIORITY 5        // über loop() (1), unter dem Bluetooth-Stack
+#define RELAY_TASK_STACK_SIZE 2048
+#define RELAY_EVENT_QUEUE_SIZE 16    // Zweierpotenz; Überlauf verliert nur den Latenz-Zeitstempel
 
 // =================== SYSTEM KONFIGURATION ===================
 #define SERIAL_BAUD_RATE 115200
@@ -0,0 +1,76 @@
+/**
+ * @file DeviceIndex.h
+ * @brief Hash-Index über die 48-Bit-MAC-Adresse
+ *
+ * Open-Addressing-Tabelle (lineares Sondieren), die pro Adresse den
+ * Platz in der aktiven Geräteliste hält. Ein Advertisement kostet damit
+ * eine Suche statt eines linearen strcmp-Durchlaufs. Die Liste bekannter
+ * Geräte ist selbst nach MAC sortiert und braucht keinen Index.
+ */
+
+#ifndef DEVICE_INDEX_H
+#define DEVICE_INDEX_H
+
+#include <Arduino.h>
+
+// MAC-Adresse als 48-Bit-Schlüssel (Byte 0 der Adresse im höchsten Byte)
+typedef uint64_t MacKey;
+
+bool parseMacKey(const char* address, MacKey& key);  // "aa:bb:cc:dd:ee:ff", Groß-/Kleinschreibung egal
+MacKey macKeyFromBytes(const uint8_t* mac);
+void formatMacKey(MacKey key, char* out);  // out: 18 Zeichen, Kleinbuchstaben
+
+// splitmix64-Finalizer: alle 64 Bit hängen von jedem Bit der Adresse ab, auch wenn sich
+// MAC-Adressen nur in wenigen Bits unterscheiden (HyperLogLog, Known-Vorfilter)
+inline uint64_t mixMacKey(MacKey key) {
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * @brief Index der aktiven Geräte
+ */
+class DeviceIndex {
+public:
+    static const int NO_ENTRY = -1;
+
+    DeviceIndex(int maxEntries);
+    ~DeviceIndex();
+
+    void clear();
+
+    // Position in devices[] (NO_ENTRY = nicht vorhanden)
+    int findDevice(MacKey key) const;
+
+    // Setzen/Entfernen; NO_ENTRY entfernt den Eintrag
+    bool setDevice(MacKey key, int deviceIndex);
+
+    int getSlotCount() const { return slotCount; }
+    int getUsedCount() const { return usedCount; }
+
+private:
+    // 8 Byte pro Slot: Schlüssel aufgeteilt, damit kein 8-Byte-Alignment nötig ist
+    struct Slot {
+        uint32_t keyLow;
+        uint16_t keyHigh;
+        int16_t device;
+
+        bool isEmpty() const { return device < 0; }
+        MacKey key() const { return ((MacKey)keyHigh << 32) | keyLow; }
+    };
+
+    Slot* slots;
+    int slotCount;   // Zweierpotenz, mindestens doppelte Anzahl Einträge
+    int slotBits;    // slotCount = 1 << slotBits
+    int usedCount;
+
+    uint32_t home(MacKey key) const;
+    int locate(MacKey key) const;  // Slot-Nummer oder -1
+    void erase(int slot);
+};
+
+#endif // DEVICE_INDEX_H
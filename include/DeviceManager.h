@@ -11,17 +11,148 @@
 
 #include <Arduino.h>
 #include <Preferences.h>
-#include <ArduinoJson.h>
+#include <atomic>
+#include <mutex>
 #include "Config.h"
+#include "DeviceIndex.h"
+#include "ExpiryWheel.h"
+#include "HyperLogLog.h"
+#include "KnownFilter.h"
 
-// Device structure definition
+// Flags im Hot-Record
+#define DEVICE_FLAG_ACTIVE        0x01
+#define DEVICE_FLAG_KNOWN         0x02
+#define DEVICE_FLAG_NEARBY        0x04  // geglätteter RSSI über Grenzwert (mit Hysterese und Mindestdauer)
+#define DEVICE_FLAG_WAS_NEARBY    0x08
+#define DEVICE_FLAG_MANUFACTURER  0x10
+#define DEVICE_FLAG_PENDING       0x20  // Wechsel von NEARBY läuft, seit pendingSince
+
+// Zeitbasis für pendingSince: millis() >> 8 (256 ms pro Tick, 8 Bit reichen für 65 s)
+#define PRESENCE_TICK_SHIFT 8
+#define PRESENCE_MAX_DWELL_MS 60000
+
+/**
+ * @brief Hot-Record: alles was pro Advertisement und pro
+ * updateLEDStatus()-Durchlauf gelesen oder geschrieben wird (16 Byte)
+ */
+struct DeviceHot {
+    uint32_t keyLow;         // MAC-Adresse Byte 2..5
+    uint16_t keyHigh;        // MAC-Adresse Byte 0..1
+    int8_t rssi;
+    int8_t rssiThreshold;    // Kopie aus der Known-Liste bzw. DEFAULT_RSSI_THRESHOLD
+    uint32_t lastSeen;       // millis()
+    uint8_t flags;           // DEVICE_FLAG_*
+    uint8_t pendingSince;    // Tick (PRESENCE_TICK_SHIFT), ab dem die Wechselbedingung gilt
+    int16_t rssiFiltered;    // geglätteter RSSI, Festkomma dBm * 256
+    
+    MacKey key() const { return ((MacKey)keyHigh << 32) | keyLow; }
+    bool isActive() const { return flags & DEVICE_FLAG_ACTIVE; }
+    bool isKnown() const { return flags & DEVICE_FLAG_KNOWN; }
+    bool isNearby() const { return flags & DEVICE_FLAG_NEARBY; }
+    bool isPresent() const { return isActive() && isKnown() && isNearby(); }
+    int filteredRssi() const { return rssiFiltered >> 8; }  // ganze dBm (abgerundet)
+};
+
+/**
+ * @brief Glättung und Hysterese eines bekannten Geräts (8 Byte)
+ *
+ * Anwesend wird ein Gerät, wenn der geglättete RSSI enterDwellMs lang
+ * mindestens Grenzwert + enterMargin beträgt; abwesend, wenn er exitDwellMs
+ * lang unter Grenzwert - exitMargin liegt. Alles 0 = Rohwert gegen Grenzwert.
+ */
+struct PresenceTuning {
+    int8_t enterMargin;      // dB
+    int8_t exitMargin;       // dB
+    uint8_t filterShift;     // EMA-Gewicht 1/2^filterShift, 0..6
+    uint8_t reserved;
+    uint16_t enterDwellMs;   // höchstens PRESENCE_MAX_DWELL_MS
+    uint16_t exitDwellMs;
+};
+
+PresenceTuning defaultPresenceTuning();  // Werte aus Config.h
+void constrainPresenceTuning(PresenceTuning& tuning);
+// Werte aus Import/API erst begrenzen, dann in die schmalen Felder schreiben
+void constrainPresenceTuning(PresenceTuning& tuning, int enterMargin, int exitMargin, int filterShift, int enterDwellMs, int exitDwellMs);
+
+// Inhalt des letzten Advertisements (DevicePayload::flags)
+#define PAYLOAD_FLAG_MANUFACTURER   0x01
+#define PAYLOAD_FLAG_SERVICE_DATA   0x02
+#define PAYLOAD_FLAG_SERVICE_UUIDS  0x04
+#define PAYLOAD_FLAG_NAME           0x08
+#define PAYLOAD_FLAG_TX_POWER       0x10
+#define PAYLOAD_FLAG_APPEARANCE     0x20
+
+#define PAYLOAD_MAX_BYTES 32
+
+/**
+ * @brief Roh-Payload des letzten Advertisements (38 Byte)
+ *
+ * Der Ingest-Pfad kopiert nur Bytes; den Text für /api/devices
+ * erzeugt formatDevicePayload() erst beim Ausliefern.
+ */
+struct DevicePayload {
+    uint8_t data[PAYLOAD_MAX_BYTES];  // Manufacturer Data inkl. Company-ID, gekürzt
+    uint8_t length;
+    uint8_t flags;                    // PAYLOAD_FLAG_*
+    int8_t txPower;
+    uint16_t appearance;
+};
+
+// Hex-Dump der Manufacturer Data, sonst Kurzbeschreibung ("TX:-4dBm SVC:YES", "AdvData:NONE");
+// name für "N:..." (Name aus dem Cold-Record)
+void formatDevicePayload(const DevicePayload& payload, const char* name, char* out, size_t outSize);
+
+/**
+ * @brief Cold-Record: Texte für die Web-Oberfläche, parallel zu DeviceHot
+ */
+struct DeviceCold {
+    char name[32];
+    char manufacturer[32];
+    DevicePayload payload;
+    const char* deviceType;  // statischer String aus dem Scanner (nullptr = leer)
+    uint32_t firstSeen;
+    uint16_t manufacturerId;
+};
+
+/**
+ * @brief Empfangsstatistik pro Gerät (16 Byte), parallel zu DeviceHot
+ *
+ * Abstände zwischen zwei Advertisements als exponentiell gleitender
+ * Mittelwert und Varianz (Gewicht 1/8, Festkomma). Gemessen wird, was der
+ * Scanner tatsächlich empfängt - im Zyklus-Modus also inklusive Scan-Pausen.
+ * Nach einer Inaktivität zählt der Abstand nicht, Pakete und RSSI schon.
+ */
+struct DeviceStats {
+    uint32_t packets;        // Advertisements seit das Gerät in der Tabelle steht
+    uint32_t intervalMean;   // ms * 16 (Q4)
+    uint32_t intervalVar;    // ms^2
+    int8_t rssiMin;
+    int8_t rssiMax;
+    uint16_t intervals;      // gemessene Abstände (sättigt bei 65535)
+    
+    void record(int rssi, bool hasInterval, uint32_t intervalMs);
+    uint32_t meanIntervalMs() const { return (intervalMean + 8) >> 4; }
+    uint32_t intervalStdDevMs() const;
+    uint32_t absenceTimeoutMs(uint32_t minMs) const;  // ab wann das Gerät als weg gilt (minMs: Untergrenze des Scan-Modus)
+};
+
+/**
+ * @brief Vollständige Gerätesicht, wird nur für /api/devices aus
+ * Hot- und Cold-Record zusammengesetzt (siehe DeviceManager::getDevice)
+ */
 struct SafeDevice {
     char address[18];  // "XX:XX:XX:XX:XX:XX"
     char name[32];
     char comment[50];  // Benutzer-Kommentar
     int rssi;
+    int rssiFiltered;  // geglättet, Grundlage für isNearby
+    uint32_t packets;
+    uint32_t intervalMeanMs;    // 0 = noch kein Abstand gemessen
+    uint32_t intervalStdDevMs;
+    uint32_t absenceTimeoutMs;
+    int rssiMin;
+    int rssiMax;
     unsigned long lastSeen;
-    char lastSeenFormatted[20];  // "vor X min"
     bool isKnown;
     bool isActive;
     unsigned long firstSeenThisSession;
@@ -33,14 +164,25 @@ struct SafeDevice {
     char manufacturer[32];
     char deviceType[32];
     char payloadHex[128];
-    char serviceData[64];
     bool hasManufacturerData;
-    bool hasServiceData;
     uint16_t manufacturerId;
 };
 
-#define MAX_DEVICES 32
+// Maximale Größe der Gerätetabelle (Build-Zeit, z.B. -DMAX_DEVICES=256 in platformio.ini);
+// begin() kann zur Laufzeit eine kleinere Kapazität wählen. Pro Gerät ~480 Byte RAM, davon
+// ~300 Byte für die zwei Snapshots der Web-Leser (MAX_DEVICES 256: ~120 KB). Firmware höchstens
+// 256, größere Tabellen nur im Host-Bench
+#ifndef MAX_DEVICES
+#define MAX_DEVICES 128
+#endif
+#ifndef MAX_KNOWN
 #define MAX_KNOWN 200
+#endif
+// Bloom-Vorfilter vor der Binärsuche in der Known-Liste; bei 200 Plätzen kein messbarer
+// Gewinn (bench-scale), ab 800 etwa dreimal schnellere Suche nach unbekannten Adressen
+#ifndef KNOWN_FILTER
+#define KNOWN_FILTER (MAX_KNOWN >= 800)
+#endif
 #define MAX_OUTPUT_LOG_ENTRIES 30
 
 // Output Log Entry für Ausgang-Schaltungen
@@ -53,49 +195,233 @@ struct OutputLogEntry {
     char reason[64];   // "Gerät erkannt", "Gerät verschwunden", etc.
 };
 
+/**
+ * @brief Veröffentlichter Stand der Gerätetabelle für Web-Leser
+ *
+ * DeviceManager schreibt abwechselnd in einen von zwei Puffern und schaltet
+ * erst danach um (siehe publishSnapshot). Ein Leser sieht daher immer einen
+ * vollständigen Stand, Zähler und Zeilen passen zusammen.
+ */
+struct DeviceSnapshot {
+    uint32_t epoch;              // +1 pro Veröffentlichung
+    unsigned long publishedAt;   // millis()
+    int deviceCount;
+    int activeCount;
+    int presentCount;
+    int presenceTrigger;
+    int totalEverSeen;
+    uint32_t evictionCount;
+    uint32_t absenceMinMs;       // Untergrenze für DeviceStats::absenceTimeoutMs()
+    DeviceHot hot[MAX_DEVICES];
+    DeviceCold cold[MAX_DEVICES];
+    DeviceStats stats[MAX_DEVICES];
+    int16_t knownIndex[MAX_DEVICES];  // Position in der Known-Liste beim Veröffentlichen, -1 = unbekannt
+    
+    int find(MacKey key) const;  // Position oder -1 (linear über hot[])
+    int find(const char* address) const;
+};
+
+// Wird aufgerufen, sobald sich das auslösende Gerät ändert (-1 = kein bekanntes Gerät in Reichweite).
+// fromAdvertisement: Wechsel kommt aus updateDevice() im Scan-Callback (sonst Timeout, Known-Liste, ...)
+// triggerIndex gilt nur während des Aufrufs: beim Entfernen zieht die letzte Zeile in die Lücke, ohne
+// dass der Listener erneut gerufen wird (am Pegel ändert sich nichts). Wer das Gerät länger braucht,
+// merkt sich die MAC (formatDeviceAddress/getDeviceTable()[i].key()), nicht die Zeile.
+typedef void (*PresenceListener)(int triggerIndex, bool fromAdvertisement, void* context);
+
 /**
  * @brief Klasse für Geräte-Verwaltung
  */
 class DeviceManager {
 private:
-    SafeDevice* devices;
-    char knownMACs[MAX_KNOWN][18];
+    DeviceHot* hot;      // dicht gepackt, wird pro Advertisement angefasst
+    DeviceCold* cold;    // gleiche Position wie in hot[]
+    int capacity;        // Laufzeit-Kapazität, höchstens MAX_DEVICES
+    
+    // LRU-Liste der unbekannten Geräte (Kopf = zuletzt gesehen).
+    // Bekannte Geräte stehen nicht in der Liste und werden nie verdrängt.
+    uint16_t lruPrev[MAX_DEVICES];
+    uint16_t lruNext[MAX_DEVICES];
+    DeviceStats stats[MAX_DEVICES];  // pro Advertisement geschrieben, daher nicht im Cold-Record
+    int lruHead;
+    int lruTail;
+    uint32_t evictionCount;   // verdrängte unbekannte Geräte
+    uint32_t droppedCount;    // verworfene Advertisements (Tabelle nur mit bekannten Geräten belegt)
+    
+    // Inkrementell gepflegte Anwesenheit (statt Rescan pro loop()/Status-Abfrage)
+    int activeCount;
+    int presentCount;
+    int presenceTrigger;      // Gerät das den Ausgang schaltet (-1 = keins)
+    PresenceListener presenceListener;
+    void* presenceListenerContext;
+    
+    // Known-Liste aufsteigend nach MAC sortiert; Suchen, Einfügen und Entfernen per Binärsuche
+    MacKey knownKeys[MAX_KNOWN];
     char knownComments[MAX_KNOWN][MAX_COMMENT_LENGTH];
-    int knownRSSIThresholds[MAX_KNOWN];
+    int8_t knownRSSIThresholds[MAX_KNOWN];
+    PresenceTuning knownTuning[MAX_KNOWN];  // Glättung/Hysterese, parallel zu knownKeys
+    PresenceTuning defaultTuning;           // für unbekannte Geräte (Anzeige grün/gelb)
     int deviceCount;
     int knownCount;
+    MacKey knownPending[KNOWN_PENDING_MAX];  // seit dem letzten Journal-Eintrag geänderte Adressen
+    int knownPendingCount;
+    bool knownCompactPending;       // mehr als KNOWN_PENDING_MAX Änderungen: ganze Liste schreiben
+    int knownBatchDepth;            // > 0: Import läuft, Flush wartet auf endKnownBatch()
+    unsigned long lastKnownChange;
+    uint32_t knownGeneration;       // Generation des Blobs, Journal-Einträge gelten nur dazu
+    int knownJournalCount;          // geschriebene Journal-Einträge j0..jN-1
+    DeviceIndex index;  // MAC -> Position in hot[]/cold[]
+    KnownFilter knownFilter;  // vor findKnown(): unbekannte Adressen ohne Binärsuche abweisen
+    bool knownFilterEnabled;
+    ExpiryWheel expiry; // Abwesenheits-Timeouts aktiver Geräte, Eintrag = Position in hot[]
+    uint32_t expiryChecks;  // von cleanupOldDevices() geprüfte Geräte (fällige und neu eingeplante)
+    uint32_t absenceMinMs;  // Untergrenze des Abwesenheits-Timeouts, folgt dem Scan-Modus
     Preferences preferences;
+    std::mutex tableMutex;  // Ingest-Task gegen Web-Handler und loop()
+    std::mutex persistMutex;  // NVS-Schreibzugriffe aus loop() und Web-Handlern nacheinander, vor tableMutex
+    
+    // Doppelpuffer für lock-freie Leser: publishedSnapshot zeigt auf den gültigen Puffer,
+    // snapshotReaders zählt Leser pro Puffer. Cold-Zeilen werden nur kopiert, wenn sie sich
+    // seit der letzten Veröffentlichung in diesen Puffer geändert haben.
+    DeviceSnapshot snapshots[2];
+    mutable std::atomic<int> snapshotReaders[2];
+    std::atomic<int> publishedSnapshot;
+    uint32_t coldDirty[2][(MAX_DEVICES + 31) / 32];
+    uint32_t snapshotEpoch;
+    uint32_t snapshotSkips;     // Veröffentlichung verschoben, Leser noch im freien Puffer
+    bool snapshotPending;
+    bool everSeenChanged;       // Schätzung beim nächsten Veröffentlichen neu berechnen
+    int everSeenEstimate;
     
     // Output Log System
     OutputLogEntry outputLog[MAX_OUTPUT_LOG_ENTRIES];
     int outputLogCount;
     int outputLogIndex;  // Ringpuffer-Index
     
-    // Ever-seen tracking (Bitfeld für RAM-effizientes Tracking)
-    uint32_t everSeenBitfield[8];  // 256 bits = 256 mögliche Geräte-Hashes
-    int totalEverSeen;
+    // Ever-seen tracking (HyperLogLog, 1 KB, optional in NVS gesichert)
+    HyperLogLog everSeen;
+    bool everSeenDirty;
+    unsigned long lastEverSeenCheckpoint;
+    
+    void rebuildIndex();
+    void loadEverSeen();
+    void removeDeviceAt(int deviceIndex);
+    void applyKnownStatus(int deviceIndex, int knownIndex);
+    
+    // Known-Liste in NVS: ein Blob mit Version und CRC, alte Einzel-Schlüssel nur noch lesen
+    bool loadKnownBlob();
+    int loadLegacyKnownDevices();                                     // Anzahl der gespeicherten alten Einträge
+    uint8_t* buildKnownBlob(uint32_t generation, size_t& length);      // malloc, unter Lock
+    bool writeKnownBlob(uint32_t generation, int legacyEntries = -1);  // nur beim Laden; >= 0: danach alte Schlüssel löschen
+    
+    // Änderungen zwischen zwei Blobs: Journal-Einträge, gesammelt und verzögert geschrieben
+    bool replayKnownJournal(int slot);
+    uint8_t* buildKnownJournal(size_t& length);  // malloc, unter Lock
+    void noteKnownChange(MacKey key);
+    int knownLowerBound(MacKey key) const;  // erste Position mit knownKeys[i] >= key
+    int upsertKnown(MacKey key, const char* comment, int rssiThreshold, const PresenceTuning* tuning);
+    bool eraseKnown(MacKey key);
+    void rebuildKnownFilter();
+    void moveDevice(int from, int to);
+    void scheduleExpiry(int deviceIndex);
+    void lruUnlink(int deviceIndex);
+    void lruPushFront(int deviceIndex);
+    void trackPresence(int deviceIndex, bool wasActive, bool wasPresent, bool fromAdvertisement = false);
+    void updateNearby(DeviceHot& device, int rssi, const PresenceTuning& tuning, bool restart);
+    void markColdDirty(int deviceIndex);
+    int acquireSnapshot() const;
+    void releaseSnapshot(int slot) const;
     
 public:
+    /**
+     * @brief Sperrt Gerätetabelle, Known-Liste und Output-Log für einen Block
+     *
+     * Der Ingest-Task hält die Sperre pro Batch, loop() beim Lesen der
+     * Live-Tabelle, Web-Handler nur noch für Known-Liste und Output-Log
+     * (Gerätedaten lesen sie aus dem Snapshot).
+     */
+    class Lock {
+    public:
+        explicit Lock(DeviceManager& manager) : mutex(manager.tableMutex) { mutex.lock(); }
+        ~Lock() { mutex.unlock(); }
+    private:
+        std::mutex& mutex;
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+    
+    /**
+     * @brief Lesezugriff auf den zuletzt veröffentlichten Stand, ohne Sperre
+     *
+     * Hält den Puffer für die Lebensdauer des Objekts fest; der Ingest-Task
+     * wartet nie darauf, sondern verschiebt höchstens seine nächste
+     * Veröffentlichung. Für Web-Handler (AsyncTCP-Task) gedacht.
+     */
+    class Snapshot {
+    public:
+        explicit Snapshot(const DeviceManager& manager) : manager(manager), slot(manager.acquireSnapshot()) {}
+        ~Snapshot() { manager.releaseSnapshot(slot); }
+        const DeviceSnapshot& operator*() const { return manager.snapshots[slot]; }
+        const DeviceSnapshot* operator->() const { return &manager.snapshots[slot]; }
+    private:
+        const DeviceManager& manager;
+        int slot;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+    };
+    
     DeviceManager();
     ~DeviceManager();
     
     // Initialization
-    void begin(SafeDevice* deviceArray, int maxDevices);
+    void begin(DeviceHot* hotArray, DeviceCold* coldArray, int maxDevices);
     
     // Known devices management
     void loadKnownDevices();
-    void saveKnownDevices();
-    int addKnownDevice(const char* address, const char* comment, int rssiThreshold);
+    // Schreiben in NVS: nicht unter Lock aufrufen, die Tabelle ist nur zum Kopieren gesperrt
+    // und der Flash-Zugriff läuft danach (loop() bzw. Web-Handler, nie der Ingest-Task)
+    void saveKnownDevices();  // ganze Liste als Blob, verdichtet das Journal
+    // Gesammelte Änderungen als ein Journal-Eintrag, sobald KNOWN_FLUSH_DELAY_MS nichts mehr
+    // geändert wurde (force: sofort, z.B. nach einem Import oder vor einem Neustart)
+    void flushKnownDevices(bool force = false);
+    bool hasPendingKnownChanges() const { return knownPendingCount > 0 || knownCompactPending; }
+    int getKnownJournalCount() const { return knownJournalCount; }
+    // Import: Änderungen nur sammeln, danach schreibt flushKnownDevices(true) sie einmal
+    void beginKnownBatch();
+    void endKnownBatch();
+    // tuning = nullptr: bisherige Einstellung behalten bzw. Standard für neue Einträge
+    int addKnownDevice(const char* address, const char* comment, int rssiThreshold, const PresenceTuning* tuning = nullptr);
+    bool getKnownTuning(const char* address, PresenceTuning& out) const;  // Standard, wenn nicht bekannt
     bool removeKnownDevice(const char* address);
     bool isKnownDevice(const char* address);
+    int findKnown(MacKey key) const;  // Position in der Known-Liste oder -1 (Bloom-Filter, dann Binärsuche)
+    void setKnownFilter(bool enabled) { knownFilterEnabled = enabled; }  // false = immer Binärsuche
+    bool isKnownFilter() const { return knownFilterEnabled; }
+    const KnownFilter& getKnownFilter() const { return knownFilter; }
     
     // Device management
     void updateDevice(const char* address, const char* name, int rssi);
-    void updateManufacturerInfo(const char* address, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const char* payloadHex = "");
+    void updateManufacturerInfo(const char* address, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const DevicePayload* payload = nullptr);
     void setDeviceActive(const char* address, bool active);
-    void cleanupOldDevices();
+    int findDevice(const char* address) const;  // Position in getDeviceTable() oder -1
     
-    // Export/Import
+    // Ingest-Pfad mit binärer Adresse (eine Index-Suche pro Advertisement)
+    int updateDevice(MacKey key, const char* name, int rssi);  // liefert Position in getDeviceTable() oder -1
+    void updateManufacturerInfo(int deviceIndex, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const DevicePayload* payload = nullptr);
+    int cleanupOldDevices();  // liefert die Zahl der als weg erkannten Geräte
+    // Untergrenze der Abwesenheit (ABSENCE_TIMEOUT_MIN_FOR des Scan-Modus), unter Lock;
+    // plant alle aktiven Geräte im Zeitrad neu ein
+    void setAbsenceMinMs(uint32_t minMs);
+    uint32_t getAbsenceMinMs() const { return absenceMinMs; }
+    void checkpointEverSeen(bool force = false);  // HyperLogLog nach NVS (DEVICES_EVER_PERSIST), nicht unter Lock
+    
+    // Snapshot für Web-Leser: nur unter Lock aufrufen (Ingest-Task nach jedem Batch,
+    // Web-Handler nach Änderungen der Known-Liste). false = verschoben, Leser im freien Puffer
+    bool publishSnapshot();
+    bool hasPendingSnapshot() const { return snapshotPending; }
+    uint32_t getSnapshotEpoch() const { return snapshotEpoch; }
+    uint32_t getSnapshotSkips() const { return snapshotSkips; }
+    
+    // Export/Import (DeviceManagerJson.cpp)
     String exportDevicesJson();
     bool importDevicesJson(const String& jsonData);
     
@@ -106,14 +432,30 @@ public:
     
     // Getters
     int getDeviceCount() const { return deviceCount; }  // Aktiv (current seen)
+    int getCapacity() const { return capacity; }
+    uint32_t getEvictionCount() const { return evictionCount; }
+    uint32_t getDroppedCount() const { return droppedCount; }
+    uint32_t getExpiryChecks() const { return expiryChecks; }
     int getKnownCount() const { return knownCount; }    // Bekannt (saved)
-    int getTotalEverSeen() const { return totalEverSeen; }  // Geräte ever seen
-    int getActiveCount() const;  // Aktiv (current seen)
-    int getPresentCount() const;  // Anwesend (current seen + near)
-    SafeDevice* getDevices() { return devices; }
-    char (*getKnownMACs())[18] { return knownMACs; }
+    int getTotalEverSeen() const { return (int)everSeen.estimate(); }  // Geräte ever seen (Schätzung, ~3%)
+    int getActiveCount() const { return activeCount; }  // Aktiv (current seen)
+    int getPresentCount() const { return presentCount; }  // Anwesend (current seen + near)
+    int getPresenceTrigger() const { return presenceTrigger; }  // aktuelle Zeile des auslösenden Geräts (-1 = keins)
+    void setPresenceListener(PresenceListener listener, void* context = nullptr);
+    
+    // Gerätetabelle: Hot-Records direkt, Cold-Daten nur bei Bedarf
+    const DeviceHot* getDeviceTable() const { return hot; }
+    const DeviceStats* getDeviceStats() const { return stats; }  // gleiche Position wie in hot[]
+    bool getDevice(int deviceIndex, SafeDevice& out) const;  // setzt die Gerätesicht zusammen
+    bool getDevice(const DeviceSnapshot& snapshot, int deviceIndex, SafeDevice& out) const;  // aus einem Snapshot
+    const char* getKnownComment(const DeviceSnapshot& snapshot, int deviceIndex) const;  // "" wenn Known-Liste inzwischen anders
+    void formatDeviceAddress(int deviceIndex, char* out) const;  // out: 18 Zeichen
+    const char* getDeviceName(int deviceIndex) const;
+    const char* getDeviceComment(int deviceIndex) const;  // Kommentar aus der Known-Liste oder ""
+    const MacKey* getKnownKeys() const { return knownKeys; }  // sortiert, Text mit formatMacKey()
     char (*getKnownComments())[MAX_COMMENT_LENGTH] { return knownComments; }
-    int* getKnownRSSIThresholds() { return knownRSSIThresholds; }
+    const int8_t* getKnownRSSIThresholds() const { return knownRSSIThresholds; }
+    const PresenceTuning* getKnownTunings() const { return knownTuning; }
 };
 
 #endif // DEVICE_MANAGER_H
\ No newline at end of file
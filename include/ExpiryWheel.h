@@ -0,0 +1,65 @@
+/**
+ * @file ExpiryWheel.h
+ * @brief Zeitrad für die Abwesenheits-Timeouts der Gerätetabelle
+ *
+ * Ein Eintrag pro Tabellenplatz, eingehängt in den Slot seines
+ * Ablauf-Ticks (512 ms). Die Bereinigung besucht nur die Slots seit dem
+ * letzten Aufruf und damit nur fällige Einträge, unabhängig davon wie
+ * viele Geräte in der Tabelle stehen. Ein Advertisement hängt nichts um:
+ * wird ein Eintrag fällig, prüft der Aufrufer das tatsächliche lastSeen
+ * und plant das Gerät gegebenenfalls neu ein (einmal pro Timeout statt
+ * einmal pro Advertisement).
+ *
+ * Eine Ebene genügt, weil kein Timeout länger als die Reichweite des
+ * Rads ist (ABSENCE_TIMEOUT_MAX_MS); weiter entfernte Termine werden auf
+ * die Reichweite gekürzt und dann erneut eingeplant.
+ */
+
+#ifndef EXPIRY_WHEEL_H
+#define EXPIRY_WHEEL_H
+
+#include <Arduino.h>
+
+#define EXPIRY_TICK_SHIFT 9        // 512 ms pro Tick
+#define EXPIRY_WHEEL_SLOTS 1024    // Zweierpotenz; Reichweite 1024 * 512 ms = 524 s
+
+class ExpiryWheel {
+public:
+    static const int NONE = -1;
+    static const unsigned long RANGE_MS = ((unsigned long)(EXPIRY_WHEEL_SLOTS - 1) << EXPIRY_TICK_SHIFT);
+
+    ExpiryWheel(int maxEntries);
+    ~ExpiryWheel();
+
+    void clear(unsigned long now);
+
+    // Eintrag (Tabellenplatz) zum Zeitpunkt dueMs fällig; hängt um, falls schon eingeplant
+    void schedule(int entry, unsigned long dueMs);
+    void cancel(int entry);
+    void move(int from, int to);  // Eintrag zieht auf einen freien Platz um
+    bool isScheduled(int entry) const { return prev[entry] != NOT_LINKED; }
+
+    // Nächster fälliger Eintrag (bereits ausgehängt) oder NONE; besucht nur Slots seit dem letzten Aufruf
+    int popDue(unsigned long now);
+
+    int getScheduledCount() const { return scheduledCount; }
+
+private:
+    static const int16_t NOT_LINKED = -2;
+
+    int16_t* slotHead;   // erster Eintrag pro Slot, NONE = leer
+    int16_t* next;
+    int16_t* prev;       // NONE = Kopf des Slots, NOT_LINKED = nicht eingeplant
+    uint32_t* dueTick;
+    int maxEntries;
+    int scheduledCount;
+    uint32_t currentTick;     // fortlaufend, läuft erst nach Jahrzehnten über
+    uint32_t cursorTick;      // ältester noch nicht vollständig abgearbeiteter Tick
+    unsigned long tickBase;   // millis() zum Beginn von currentTick
+
+    void advance(unsigned long now);
+    void link(int entry, uint32_t tick);
+    void unlink(int entry);
+};
+
+#endif // EXPIRY_WHEEL_H
@@ -0,0 +1,42 @@
+/**
+ * @file HyperLogLog.h
+ * @brief Kardinalitätsschätzer für "devices ever seen"
+ *
+ * HyperLogLog mit 2^10 Registern zu je einem Byte (1 KB). Der
+ * Standardfehler liegt bei 1.04/sqrt(1024) = ~3.3%, unabhängig davon
+ * ob hundert oder hunderttausend verschiedene Adressen gesehen wurden.
+ */
+
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <Arduino.h>
+#include "DeviceIndex.h"
+
+#define HLL_PRECISION 10
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+class HyperLogLog {
+public:
+    HyperLogLog();
+
+    void clear();
+    bool add(uint64_t key);  // true wenn sich ein Register geändert hat
+    uint32_t estimate() const;  // O(1), Summe wird inkrementell geführt
+
+    // Rohdaten für den NVS-Checkpoint
+    const uint8_t* data() const { return registers; }
+    size_t size() const { return sizeof(registers); }
+    void load(const uint8_t* data);
+
+private:
+    uint8_t registers[HLL_REGISTERS];
+    double harmonicSum;   // Summe 2^-register, bei add() nachgeführt
+    int zeroRegisters;
+    mutable uint32_t cachedEstimate;
+    mutable bool cacheValid;
+
+    void recount();
+};
+
+#endif // HYPER_LOG_LOG_H
@@ -0,0 +1,100 @@
+/**
+ * @file PresenceRelay.h
+ * @brief Ereignisgesteuertes Schalten von Relais und LED
+ *
+ * Überschreitet ein bekanntes Gerät seinen RSSI-Grenzwert, legt der
+ * Ingest-Pfad ein PresenceEvent in eine lock-freie Warteschlange und
+ * weckt einen eigenen Task, der RELAY_OUTPUT_PIN sofort schaltet -
+ * statt auf das Ende des Scan-Fensters und den nächsten loop()-Durchlauf
+ * zu warten. Der Task ist der einzige, der die Ausgänge schreibt; er
+ * übernimmt immer den aktuellen Stand aus dem DeviceManager, damit
+ * spätere Änderungen (Timeout, Known-Liste) nie von einem veralteten
+ * Ereignis überschrieben werden.
+ *
+ * Über die Warteschlange laufen nur Wechsel aus einem Advertisement, also
+ * praktisch das Ankommen. Ein Gehen per Timeout (cleanupOldDevices) oder
+ * eine Änderung der Known-Liste bemerkt erst updateLEDStatus() im nächsten
+ * loop()-Durchlauf (alle 100 ms) und weckt dann den Task per wake().
+ */
+
+#ifndef PRESENCE_RELAY_H
+#define PRESENCE_RELAY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include "Config.h"
+#include "SpscQueue.h"
+
+class DeviceManager;
+
+/**
+ * @brief Latenz-Histogramm mit Zweierpotenz-Klassen in Mikrosekunden
+ */
+struct LatencyHistogram {
+    static const int BUCKETS = 24;  // Klasse i: [2^i, 2^(i+1)) µs, letzte Klasse nach oben offen
+
+    uint32_t buckets[BUCKETS];
+    uint32_t count;
+    uint32_t maxMicros;
+
+    void clear();
+    void record(uint32_t latencyMicros);
+    uint32_t percentile(float p) const;  // Obergrenze der Klasse, in der das Perzentil liegt
+};
+
+/**
+ * @brief Anwesenheitsereignis aus dem Ingest-Pfad (8 Byte)
+ */
+struct PresenceEvent {
+    uint32_t advertMicros;   // micros() beim auslösenden Advertisement
+    int16_t trigger;         // Geräteposition beim Ereignis (nur Diagnose, kann inzwischen umgezogen sein), -1 = keins
+    uint8_t present;
+    uint8_t reserved;
+};
+
+/**
+ * @brief Schaltet Relais und LED aus einem eigenen Task
+ */
+class PresenceRelay {
+private:
+    DeviceManager* deviceManager;
+    uint8_t relayPin;
+    uint8_t ledPin;              // invertierte Logik (LOW = AN)
+    SpscQueue<PresenceEvent, RELAY_EVENT_QUEUE_SIZE> queue;  // Erzeuger: Ingest-Task, Verbraucher: Relais-Task
+    void (*wakeup)(void* context);
+    void* wakeupContext;
+    std::atomic<bool> outputState;
+    LatencyHistogram latency;    // Advertisement bis Relais geschaltet
+    mutable std::mutex latencyMutex;  // record() im Relais-Task gegen getLatency() im Web-Task
+    uint32_t switchCount;
+    uint32_t overflowCount;      // Ereignis verworfen, Ausgang wird trotzdem nachgeführt
+
+    void applyOutput(bool on);
+
+public:
+    PresenceRelay();
+
+    void begin(DeviceManager* devMgr, uint8_t relayOutputPin, uint8_t ledOutputPin);
+
+    // Weckt den Relais-Task (z.B. xTaskNotifyGive); ohne Wecker schaltet wake() direkt
+    void setWakeup(void (*wakeupFunction)(void* context), void* context = nullptr);
+    bool hasTask() const { return wakeup != nullptr; }
+
+    // Nur aus dem Ingest-Task (einziger Erzeuger); advertMicros = Empfang im BLE-Callback
+    bool post(int triggerIndex, uint32_t advertMicros);
+
+    // Aus beliebigem Task: Ausgang auf den aktuellen Stand bringen (Timeouts, Known-Liste)
+    void wake();
+
+    // Relais-Task: Warteschlange leeren und Ausgang schalten
+    void process();
+
+    // Getters
+    bool getOutputState() const { return outputState.load(std::memory_order_acquire); }
+    LatencyHistogram getLatency() const;  // Kopie, in sich stimmig (nie ein halb geschriebenes Histogramm)
+    uint32_t getSwitchCount() const { return switchCount; }
+    uint32_t getOverflowCount() const { return overflowCount; }
+};
+
+#endif // PRESENCE_RELAY_H
@@ -0,0 +1,53 @@
+/**
+ * @file SpscQueue.h
+ * @brief Lock-freie Warteschlange für genau einen Erzeuger und einen Verbraucher
+ *
+ * Ringpuffer fester Größe ohne Heap und ohne Sperren: der Erzeuger
+ * schreibt nur tail, der Verbraucher nur head. Auf dem ESP32-C3
+ * (ohne Atomic-Erweiterung) reichen dafür einfache 32-Bit-Lade- und
+ * Speicherbefehle mit Acquire/Release, es wird nie ein Compare-and-Swap
+ * oder eine Critical Section benötigt.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+template <typename T, uint32_t Size>
+class SpscQueue {
+    static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "Size muss eine Zweierpotenz sein");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Nur vom Erzeuger aufrufen; false = voll, Element verworfen
+    bool push(const T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Size) return false;
+        items[t & (Size - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Nur vom Verbraucher aufrufen; false = leer
+    bool pop(T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = items[h & (Size - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    uint32_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    static uint32_t capacity() { return Size; }
+
+private:
+    T items[Size];
+    std::atomic<uint32_t> head;  // nächster zu lesender Eintrag (Verbraucher)
+    std::atomic<uint32_t> tail;  // nächster freier Eintrag (Erzeuger)
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,37 @@
+/**
+ * @file VendorDecoders.h
+ * @brief Registry für herstellerspezifische Auswertung der Manufacturer Data
+ *
+ * Pro Company-ID kann ein Decoder eingetragen werden, der aus den
+ * Herstellerdaten einen genaueren Gerätetyp ableitet (z.B. "Apple AirPods").
+ * Decoder liefern nur statische Strings und laufen im Ingest-Task. Die
+ * Registry ist nicht synchronisiert: BluetoothScanner::begin() sperrt sie,
+ * danach lehnt registerVendorDecoder() jede Änderung ab.
+ */
+
+#ifndef VENDOR_DECODERS_H
+#define VENDOR_DECODERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef MAX_VENDOR_DECODERS
+#define MAX_VENDOR_DECODERS 8
+#endif
+
+/**
+ * @brief Decoder für die Herstellerdaten hinter der Company-ID
+ * @return Statischer Gerätetyp oder nullptr, wenn nichts erkannt wurde
+ */
+typedef const char* (*VendorDecoder)(const uint8_t* data, size_t length);
+
+// Eintragen oder ersetzen; false wenn die Registry voll oder bereits gesperrt ist
+bool registerVendorDecoder(uint16_t companyId, VendorDecoder decoder);
+
+// Ab jetzt nur noch lesen (der Ingest-Task dekodiert); bleibt bis zum Neustart gesperrt
+void lockVendorDecoders();
+
+// data/length: Manufacturer Data ohne die 2 Byte Company-ID
+const char* decodeVendorPayload(uint16_t companyId, const uint8_t* data, size_t length);
+
+#endif // VENDOR_DECODERS_H
@@ -18,6 +18,7 @@
 #include "DeviceManager.h"
 #include "BluetoothScanner.h"
 #include "DeviceModeManager.h"
+#include "PresenceRelay.h"
 
 /**
  * @brief Klasse zur Verwaltung des Webservers
@@ -30,6 +31,7 @@ private:
     DeviceManager* deviceManager;
     BluetoothScanner* bluetoothScanner;
     DeviceModeManager* modeManager;
+    PresenceRelay* presenceRelay;
     bool isRunning;
     bool setupServerStarted;
     bool isInSecureMode;
@@ -52,6 +54,7 @@ public:
     
     // Configuration
     void setModeManager(DeviceModeManager* mgr) { modeManager = mgr; }
+    void setPresenceRelay(PresenceRelay* relay) { presenceRelay = relay; }
     
     // DNS Server handling for captive portal
     void processDNS();
@@ -63,6 +66,7 @@ private:
     // API Handlers
     void handleStatusAPI(AsyncWebServerRequest *request);
     void handleDevicesAPI(AsyncWebServerRequest *request);
+    void handleStatsAPI(AsyncWebServerRequest *request);  // Empfangsstatistik pro Gerät, kompakt
     
     // Device Management
     void handleSetKnownDevice(AsyncWebServerRequest *request);
@@ -92,8 +96,7 @@ private:
     void handleBeaconConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
     
     // Helpers
-    String formatRelativeTime(unsigned long seconds);
-    void updateAllDeviceStatus();
+    static void formatRelativeTime(unsigned long seconds, char* out, size_t outSize);  // "42s", "3m 5s", "2h 10m"
     void sendJSONResponse(AsyncWebServerRequest *request, const String& status, const String& message = "");
 };
 
@@ -0,0 +1,90 @@
+/**
+ * @file AdvertisementParser.cpp
+ * @brief Implementation des AD-Struktur-Parsers
+ */
+
+#include "AdvertisementParser.h"
+#include <string.h>
+
+static void setView(AdView& view, const uint8_t* data, size_t length) {
+    // Erstes Vorkommen gewinnt
+    if (view.data) return;
+    view.data = data;
+    view.length = (uint8_t)length;
+}
+
+bool parseAdStructures(const uint8_t* payload, size_t length, AdFields& out) {
+    memset(&out, 0, sizeof(out));
+    if (!payload) return length == 0;
+
+    size_t pos = 0;
+    while (pos < length) {
+        uint8_t structureLength = payload[pos];
+        if (structureLength == 0) break;  // Rest ist Auffüllung
+        if (structureLength > length - pos - 1) {
+            out.malformed = true;
+            return false;
+        }
+        uint8_t type = payload[pos + 1];
+        const uint8_t* data = payload + pos + 2;
+        size_t dataLength = structureLength - 1;
+        out.structureCount++;
+
+        switch (type) {
+            case AD_TYPE_FLAGS:
+                if (dataLength >= 1) setView(out.flags, data, dataLength);
+                break;
+            case AD_TYPE_UUID16_INCOMPLETE:
+            case AD_TYPE_UUID16_COMPLETE:
+                setView(out.serviceUuids16, data, dataLength);
+                break;
+            case AD_TYPE_UUID32_INCOMPLETE:
+            case AD_TYPE_UUID32_COMPLETE:
+                setView(out.serviceUuids32, data, dataLength);
+                break;
+            case AD_TYPE_UUID128_INCOMPLETE:
+            case AD_TYPE_UUID128_COMPLETE:
+                setView(out.serviceUuids128, data, dataLength);
+                break;
+            case AD_TYPE_NAME_COMPLETE:
+                if (!out.nameComplete) {
+                    out.name.data = data;
+                    out.name.length = (uint8_t)dataLength;
+                    out.nameComplete = true;
+                }
+                break;
+            case AD_TYPE_NAME_SHORT:
+                if (!out.nameComplete) setView(out.name, data, dataLength);
+                break;
+            case AD_TYPE_TX_POWER:
+                if (dataLength >= 1 && !out.haveTxPower) {
+                    out.txPower = (int8_t)data[0];
+                    out.haveTxPower = true;
+                }
+                break;
+            case AD_TYPE_APPEARANCE:
+                if (dataLength >= 2 && !out.haveAppearance) {
+                    out.appearance = (uint16_t)(data[0] | (data[1] << 8));
+                    out.haveAppearance = true;
+                }
+                break;
+            case AD_TYPE_SERVICE_DATA16:
+            case AD_TYPE_SERVICE_DATA32:
+            case AD_TYPE_SERVICE_DATA128: {
+                uint8_t uuidBytes = type == AD_TYPE_SERVICE_DATA16 ? 2 : (type == AD_TYPE_SERVICE_DATA32 ? 4 : 16);
+                if (dataLength >= uuidBytes && !out.serviceData.present()) {
+                    setView(out.serviceData, data, dataLength);
+                    out.serviceDataUuidBytes = uuidBytes;
+                }
+                break;
+            }
+            case AD_TYPE_MANUFACTURER_DATA:
+                setView(out.manufacturerData, data, dataLength);
+                break;
+            default:
+                break;
+        }
+        pos += 1 + structureLength;
+    }
+    return true;
+}
@@ -5,22 +5,40 @@
 
 #include "BluetoothScanner.h"
 
+// Scan-Intervall und -Fenster (BLEScan in ms, GAP in Einheiten zu 0,625 ms)
+static const uint16_t SCAN_INTERVAL_MS = 100;
+static const uint16_t SCAN_WINDOW_MS = 99;
+
 // =================== SafeAdvertisedDeviceCallbacks Implementation ===================
 
 void SafeAdvertisedDeviceCallbacks::onResult(BLEAdvertisedDevice advertisedDevice) {
     if (scanner) {
-        scanner->processDevice(advertisedDevice);
+        scanner->enqueueAdvert(advertisedDevice);
     }
 }
 
 // =================== BluetoothScanner Implementation ===================
 
+BluetoothScanner* BluetoothScanner::gapInstance = nullptr;
+
+void BluetoothScanner::handleGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    // Läuft im BTC-Task vor BLEScan: das Ergebnis wird dort gelesen, wo der Stack es
+    // abgelegt hat, und landet ohne BLEAdvertisedDevice und ohne Heap im Ring
+    if (event != ESP_GAP_BLE_SCAN_RESULT_EVT || param->scan_rst.search_evt != ESP_GAP_SEARCH_INQ_RES_EVT) return;
+    BluetoothScanner* scanner = gapInstance;
+    if (!scanner || !scanner->gapIngest) return;
+    scanner->enqueueAdvert(param->scan_rst.bda, param->scan_rst.rssi, param->scan_rst.ble_adv,
+                           param->scan_rst.adv_data_len + param->scan_rst.scan_rsp_len);
+}
+
 BluetoothScanner::BluetoothScanner() 
     : pBLEScan(nullptr), deviceManager(nullptr), callbacks(nullptr),
-      lastScanTime(0), lastSuccessfulScan(0), lastBluetoothReset(0),
-      scanStartTime(0), scanCycleActive(false),
+      lastSuccessfulScan(0), lastBluetoothReset(0),
+      scanStartTime(0), scanCycleActive(false), scanMode(BT_SCAN_MODE), streaming(BT_SCAN_STREAMING), gapIngest(BT_GAP_INGEST),
       failedScansCount(0), currentlyScanning(false), initialized(false),
-      sessionStartTime(0), totalDevicesSeen(0) {
+      ingestWakeup(nullptr), ingestWakeupContext(nullptr), ringDropCount(0),
+      currentAdvertMicros(0), lastCleanup(0),
+      sessionStartTime(0), advertsReceived(0), advertsThisWindow(0) {
 }
 
 BluetoothScanner::~BluetoothScanner() {
@@ -36,6 +54,7 @@ bool BluetoothScanner::begin(DeviceManager* devMgr) {
     }
     
     deviceManager = devMgr;
+    applyAbsenceFloor();
     
     // BLE initialisieren
     if (!BLEDevice::getInitialized()) {
@@ -52,31 +71,123 @@ bool BluetoothScanner::begin(DeviceManager* devMgr) {
     
     // Callbacks erstellen
     callbacks = new SafeAdvertisedDeviceCallbacks(this);
-    pBLEScan->setAdvertisedDeviceCallbacks(callbacks);
+    configureScan();
     
     // Scanner konfigurieren
-    pBLEScan->setActiveScan(true);
-    pBLEScan->setInterval(100);
-    pBLEScan->setWindow(99);
+    pBLEScan->setInterval(SCAN_INTERVAL_MS);
+    pBLEScan->setWindow(SCAN_WINDOW_MS);
     
     sessionStartTime = millis();
     initialized = true;
+    lockVendorDecoders();  // ab jetzt dekodiert der Ingest-Task
     
     BT_DEBUG_PRINTF("BT-Scan: Initialisierung erfolgreich\n");
     return true;
 }
 
+void BluetoothScanner::configureScan() {
+    // wantDuplicates = true: die Bibliothek legt kein Ergebnis in ihrer Map ab,
+    // jedes Advertisement geht einmal durch onResult() und wird danach verworfen.
+    // Duplikate filtert die eigene Gerätetabelle.
+    bool wantDuplicates = streaming || scanMode == SCAN_MODE_CONTINUOUS;
+    // shouldParse = false: die Bibliothek legt keine std::string-Kopien für Name,
+    // Hersteller- und Service-Daten an; processDevice() liest den Roh-Payload
+    pBLEScan->setAdvertisedDeviceCallbacks(gapIngest ? nullptr : callbacks, wantDuplicates, false);
+    pBLEScan->setActiveScan(scanMode != SCAN_MODE_CONTINUOUS);  // Dauer-Scan passiv
+    
+    // GAP-Pfad: eigener Handler liest jedes Ergebnis; BLEScan wird nicht gestartet und
+    // verwirft die Ergebnisse, ohne ein BLEAdvertisedDevice anzulegen
+    gapInstance = gapIngest ? this : nullptr;
+    BLEDevice::setCustomGapHandler(gapIngest ? handleGapEvent : nullptr);
+}
+
+bool BluetoothScanner::startScan(uint32_t durationSec) {
+    if (!gapIngest) {
+        return pBLEScan->start(durationSec, nullptr, false);
+    }
+    
+    // Dieselben Einstellungen wie über BLEScan; Duplikate filtert die Gerätetabelle
+    esp_ble_scan_params_t params;
+    params.scan_type = scanMode == SCAN_MODE_CONTINUOUS ? BLE_SCAN_TYPE_PASSIVE : BLE_SCAN_TYPE_ACTIVE;
+    params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    params.scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL;
+    params.scan_interval = (uint16_t)(SCAN_INTERVAL_MS * 1000UL / 625);
+    params.scan_window = (uint16_t)(SCAN_WINDOW_MS * 1000UL / 625);
+    params.scan_duplicate = BLE_SCAN_DUPLICATE_DISABLE;
+    if (esp_ble_gap_set_scan_params(&params) != ESP_OK) return false;
+    return esp_ble_gap_start_scanning(durationSec) == ESP_OK;
+}
+
+void BluetoothScanner::stopScan() {
+    if (gapIngest) {
+        esp_ble_gap_stop_scanning();
+    } else {
+        pBLEScan->stop();
+    }
+}
+
+void BluetoothScanner::setScanMode(ScanMode mode) {
+    if (mode == scanMode) return;
+    scanMode = mode;
+    applyAbsenceFloor();
+    restartScan();
+    
+    BT_DEBUG_PRINTF("BT-Scan: Modus %s\n", mode == SCAN_MODE_CONTINUOUS ? "durchgehend" : "Zyklus");
+}
+
+void BluetoothScanner::setStreaming(bool enabled) {
+    if (enabled == streaming) return;
+    streaming = enabled;
+    restartScan();
+}
+
+void BluetoothScanner::setGapIngest(bool enabled) {
+    if (enabled == gapIngest) return;
+    // Laufenden Scan auf dem bisherigen Weg beenden, dann umschalten
+    if (initialized && currentlyScanning) {
+        stopScan();
+        currentlyScanning = false;
+    }
+    gapIngest = enabled;
+    restartScan();
+}
+
+void BluetoothScanner::applyAbsenceFloor() {
+    if (!deviceManager) return;  // begin() übernimmt den Modus
+    
+    // Im Zyklus-Modus muss die Grenze über der Scan-Pause liegen, sonst fällt jedes
+    // Gerät mit gemessenem Intervall in jeder Pause weg
+    DeviceManager::Lock lock(*deviceManager);
+    deviceManager->setAbsenceMinMs(ABSENCE_TIMEOUT_MIN_FOR(scanMode));
+}
+
+void BluetoothScanner::restartScan() {
+    if (!initialized) return;  // begin() übernimmt die Einstellungen
+    
+    if (currentlyScanning) {
+        stopScan();
+        currentlyScanning = false;
+    }
+    pBLEScan->clearResults();
+    scanCycleActive = false;
+    configureScan();
+}
+
 void BluetoothScanner::end() {
     if (!initialized) return;
     
     if (currentlyScanning) {
-        pBLEScan->stop();
+        stopScan();
         currentlyScanning = false;
     }
     
     if (pBLEScan) {
         pBLEScan->clearResults();
     }
+    if (gapInstance == this) {
+        BLEDevice::setCustomGapHandler(nullptr);
+        gapInstance = nullptr;
+    }
     
     if (callbacks) {
         delete callbacks;
@@ -87,56 +198,13 @@ void BluetoothScanner::end() {
     BT_DEBUG_PRINTF("BT-Scan: Beendet\n");
 }
 
-void BluetoothScanner::performScan() {
-    if (!initialized || currentlyScanning) {
-        return;
-    }
-    
-    unsigned long now = millis();
-    
-    // Rate limiting
-    if (now - lastScanTime < BT_SCAN_INTERVAL_MS) {
+void BluetoothScanner::performAutomaticScanCycle() {
+    if (!initialized) {
         return;
     }
     
-    lastScanTime = now;
-    
-    BT_DEBUG_PRINTF("BT-Scan: Starte manuellen Scan...\n");
-    
-    try {
-        currentlyScanning = true;
-        
-        // Alten Scan-Cache leeren
-        pBLEScan->clearResults();
-        
-        // Scan starten (non-blocking)
-        pBLEScan->start(BT_SCAN_DURATION_SEC, false);
-        
-        lastSuccessfulScan = now;
-        failedScansCount = 0;
-        
-        // Scan-Ergebnisse verarbeiten
-        BLEScanResults foundDevices = pBLEScan->getResults();
-        
-        BT_DEBUG_PRINTF("BT-Scan: %d Geräte gefunden\n", foundDevices.getCount());
-        
-        currentlyScanning = false;
-        
-    } catch (const std::exception& e) {
-        currentlyScanning = false;
-        failedScansCount++;
-        
-        BT_DEBUG_PRINTF("BT-Scan: FEHLER - %s\n", e.what());
-        
-        // Nach mehreren Fehlern Bluetooth reset
-        if (failedScansCount >= BT_MAX_FAILED_SCANS) {
-            resetBluetooth();
-        }
-    }
-}
-
-void BluetoothScanner::performAutomaticScanCycle() {
-    if (!initialized) {
+    if (scanMode == SCAN_MODE_CONTINUOUS) {
+        performContinuousScan();
         return;
     }
     
@@ -147,26 +215,33 @@ void BluetoothScanner::performAutomaticScanCycle() {
         scanCycleActive = true;
         scanStartTime = now;
         
-        // Alte Geräte bereinigen vor neuem Scan
-        deviceManager->cleanupOldDevices();
+        // Alte Geräte bereinigt der Ingest-Task (processPending), er besitzt die Tabelle
         
+        bool started = false;
         try {
             currentlyScanning = true;
+            advertsThisWindow.store(0, std::memory_order_relaxed);
             
-            // Alten Scan-Cache leeren
-            pBLEScan->clearResults();
+            // Alten Scan-Cache leeren (im Streaming-Modus ist er immer leer)
+            if (!streaming) {
+                pBLEScan->clearResults();
+            }
             
-            // Scan starten (non-blocking)
-            pBLEScan->start(BT_SCAN_DURATION_SEC, false);
-            
-            BT_DEBUG_PRINTF("BT-Auto-Scan: Gestartet (2s)\n");
+            // Scan starten (non-blocking, Ende des Fensters prüft der nächste Durchlauf)
+            started = startScan(BT_SCAN_DURATION_SEC);
             
         } catch (const std::exception& e) {
+            BT_DEBUG_PRINTF("BT-Auto-Scan: FEHLER - %s\n", e.what());
+        }
+        
+        if (started) {
+            BT_DEBUG_PRINTF("BT-Auto-Scan: Gestartet (2s)\n");
+        } else {
             currentlyScanning = false;
             scanCycleActive = false;
             failedScansCount++;
             
-            BT_DEBUG_PRINTF("BT-Auto-Scan: FEHLER - %s\n", e.what());
+            BT_DEBUG_PRINTF("BT-Auto-Scan: Start fehlgeschlagen (%d)\n", failedScansCount);
             
             if (failedScansCount >= BT_MAX_FAILED_SCANS) {
                 resetBluetooth();
@@ -180,9 +255,8 @@ void BluetoothScanner::performAutomaticScanCycle() {
             // Scan-Phase beendet
             currentlyScanning = false;
             
-            // Scan-Ergebnisse verarbeiten
-            BLEScanResults foundDevices = pBLEScan->getResults();
-            BT_DEBUG_PRINTF("BT-Auto-Scan: %d Geräte gefunden, starte 8s Pause\n", foundDevices.getCount());
+            // Ergebnisse sind bereits im Callback verarbeitet; keine Kopie der Ergebnis-Map
+            BT_DEBUG_PRINTF("BT-Auto-Scan: %lu Advertisements, starte 8s Pause\n", (unsigned long)advertsThisWindow.load(std::memory_order_relaxed));
             
             lastSuccessfulScan = now;
             failedScansCount = 0;
@@ -196,6 +270,36 @@ void BluetoothScanner::performAutomaticScanCycle() {
     }
 }
 
+void BluetoothScanner::performContinuousScan() {
+    unsigned long now = millis();
+    
+    if (!currentlyScanning) {
+        // Ohne Zeitbegrenzung und nicht blockierend: einmal starten, kein clearResults()/Neustart pro Zyklus
+        if (startScan(0)) {
+            currentlyScanning = true;
+            scanStartTime = now;
+            lastSuccessfulScan = now;
+            failedScansCount = 0;
+            
+            BT_DEBUG_PRINTF("BT-Dauer-Scan: Gestartet\n");
+        } else {
+            failedScansCount++;
+            
+            BT_DEBUG_PRINTF("BT-Dauer-Scan: Start fehlgeschlagen (%d)\n", failedScansCount);
+            
+            if (failedScansCount >= BT_MAX_FAILED_SCANS) {
+                resetBluetooth();
+            }
+        }
+        return;
+    }
+    
+    if (now - scanStartTime >= BT_SCAN_INTERVAL_MS) {
+        scanStartTime = now;
+        lastSuccessfulScan = now;
+    }
+}
+
 void BluetoothScanner::resetBluetooth() {
     BT_DEBUG_PRINTF("BT-Scan: Bluetooth-Reset wird durchgeführt...\n");
     
@@ -215,167 +319,144 @@ void BluetoothScanner::resetBluetooth() {
     BT_DEBUG_PRINTF("BT-Scan: Bluetooth-Reset abgeschlossen\n");
 }
 
-void BluetoothScanner::processDevice(BLEAdvertisedDevice& advertisedDevice) {
-    String address = advertisedDevice.getAddress().toString().c_str();
-    String name = "";
+bool BluetoothScanner::enqueueAdvert(BLEAdvertisedDevice& advertisedDevice) {
+    return enqueueAdvert(*advertisedDevice.getAddress().getNative(), advertisedDevice.getRSSI(),
+                         advertisedDevice.getPayload(), advertisedDevice.getPayloadLength());
+}
+
+bool BluetoothScanner::enqueueAdvert(const uint8_t* address, int rssi, const uint8_t* payload, size_t payloadLength) {
+    // Läuft im BLE-Task: nur kopieren, kein Zugriff auf die Gerätetabelle
+    AdvertRecord advert;
+    advert.receivedMicros = micros();
+    memcpy(advert.address, address, sizeof(advert.address));
+    advert.rssi = (int8_t)constrain(rssi, -128, 127);
+    advert.payloadLength = (uint8_t)(payloadLength < ADVERT_MAX_PAYLOAD ? payloadLength : ADVERT_MAX_PAYLOAD);
+    memcpy(advert.payload, payload, advert.payloadLength);
+    
+    advertsReceived.fetch_add(1, std::memory_order_relaxed);
+    advertsThisWindow.fetch_add(1, std::memory_order_relaxed);
+    
+    bool queued = advertRing.push(advert);
+    if (!queued) {
+        ringDropCount++;
+    }
+    if (ingestWakeup) {
+        ingestWakeup(ingestWakeupContext);
+    }
+    return queued;
+}
+
+void BluetoothScanner::setIngestWakeup(void (*wakeupFunction)(void* context), void* context) {
+    ingestWakeupContext = context;
+    ingestWakeup = wakeupFunction;
+}
+
+int BluetoothScanner::processPending() {
+    if (!deviceManager) return 0;
+    
+    // Ein Batch pro Aufruf unter der Tabellen-Sperre; Web-Handler lesen den Snapshot
+    DeviceManager::Lock lock(*deviceManager);
+    AdvertRecord advert;
+    int processed = 0;
+    while (processed < ADVERT_RING_SIZE && advertRing.pop(advert)) {
+        processDevice(advert);
+        processed++;
+    }
+    
+    // Abwesende Geräte im Sekundentakt erkennen (in beiden Scan-Modi), damit das
+    // Verlassen gemeldet wird, sobald das adaptive Timeout abgelaufen ist
+    unsigned long now = millis();
+    bool cleaned = false;
+    if (now - lastCleanup >= ABSENCE_CHECK_MS) {
+        lastCleanup = now;
+        cleaned = deviceManager->cleanupOldDevices() > 0;
+    }
+    
+    // Neuen Stand für die Web-Handler veröffentlichen (auch einen zuvor verschobenen)
+    if (processed > 0 || cleaned || deviceManager->hasPendingSnapshot()) {
+        deviceManager->publishSnapshot();
+    }
+    return processed;
+}
+
+void BluetoothScanner::processDevice(const AdvertRecord& advert) {
+    // Ingest-Pfad ohne Heap und ohne Formatierung: Adresse binär, AD-Felder in einem
+    // Durchlauf direkt aus dem Roh-Payload; Texte entstehen erst in /api/devices
+    MacKey key = macKeyFromBytes(advert.address);
+    currentAdvertMicros = advert.receivedMicros;
+    
+    AdFields ad;
+    parseAdStructures(advert.payload, advert.payloadLength, ad);  // fehlerhaftes Ende: Felder davor gelten
     
     // Gerätename falls verfügbar
-    if (advertisedDevice.haveName()) {
-        name = advertisedDevice.getName().c_str();
+    char name[32] = "";
+    if (ad.name.present()) {
+        size_t n = ad.name.length < sizeof(name) - 1 ? ad.name.length : sizeof(name) - 1;
+        memcpy(name, ad.name.data, n);
+        name[n] = '\0';
     }
     
-    int rssi = advertisedDevice.getRSSI();
+    int rssi = advert.rssi;
     
     // Gerät zum DeviceManager hinzufügen/aktualisieren
     // Dies updated Name, RSSI und lastSeen - auch für bereits bekannte Geräte
-    deviceManager->updateDevice(address.c_str(), name.c_str(), rssi);
-    
-    // Erstelle Device-Struktur für weitere Analysen
-    {
-        // Device-Info sammeln
-        SafeDevice newDevice = {};  // Struktur initialisieren
-        strncpy(newDevice.address, address.c_str(), sizeof(newDevice.address) - 1);
-        strncpy(newDevice.name, name.c_str(), sizeof(newDevice.name) - 1);
-        newDevice.rssi = rssi;
-        newDevice.lastSeen = millis();
-        newDevice.firstSeenThisSession = millis();
-        newDevice.isKnown = false;
-        newDevice.isActive = true;
-        newDevice.isNearby = true;
-        newDevice.hasManufacturerData = false;
-        newDevice.hasServiceData = false;
-        
-        // Geräteerkennung basierend auf Namen
-        if (name.indexOf("iPhone") >= 0 || name.indexOf("iPad") >= 0) {
-            strncpy(newDevice.deviceType, "Apple Device", sizeof(newDevice.deviceType) - 1);
-        } else if (name.indexOf("Galaxy") >= 0 || name.indexOf("Samsung") >= 0) {
-            strncpy(newDevice.deviceType, "Samsung Device", sizeof(newDevice.deviceType) - 1);
-        } else if (name.indexOf("Pixel") >= 0) {
-            strncpy(newDevice.deviceType, "Google Device", sizeof(newDevice.deviceType) - 1);
-        } else if (advertisedDevice.haveServiceUUID()) {
-            strncpy(newDevice.deviceType, "BLE Service Device", sizeof(newDevice.deviceType) - 1);
-        } else {
-            strncpy(newDevice.deviceType, "Unknown", sizeof(newDevice.deviceType) - 1);
-        }
-        
-        // Manufacturer Data analysieren
-        String allPayloadData = "";
-        
-        if (advertisedDevice.haveManufacturerData()) {
-            std::string manufData = advertisedDevice.getManufacturerData();
-            uint8_t* data = (uint8_t*)manufData.data();
-            size_t length = manufData.length();
-            
-            newDevice.hasManufacturerData = true;
-            
-            if (length >= 2) {
-                uint16_t manufacturerId = (data[1] << 8) | data[0];
-                newDevice.manufacturerId = manufacturerId;
-                
-                // Rohe Hex-Daten erstellen
-                String hexData = "";
-                for (size_t i = 0; i < length && i < 32; i++) {
-                    if (i > 0) hexData += " ";
-                    if (data[i] < 0x10) hexData += "0";
-                    hexData += String(data[i], HEX);
-                }
-                allPayloadData = hexData;
-                
-                String manufName = getManufacturerName(manufacturerId);
-                strncpy(newDevice.manufacturer, manufName.c_str(), sizeof(newDevice.manufacturer) - 1);
-            }
-        }
-        
-        // Service Data sammeln wenn keine Manufacturer Data vorhanden
-        if (allPayloadData.length() == 0 && advertisedDevice.haveServiceData()) {
-            newDevice.hasServiceData = true;
-            allPayloadData = "ServiceData:YES";
-        }
-        
-        // Falls keine spezifischen Daten verfügbar, sammle andere Advertising-Infos
-        if (allPayloadData.length() == 0) {
-            String advInfo = "";
-            if (advertisedDevice.haveName()) {
-                advInfo += "N:" + name + " ";
-            }
-            if (advertisedDevice.haveTXPower()) {
-                advInfo += "TX:" + String(advertisedDevice.getTXPower()) + "dBm ";
-            }
-            if (advertisedDevice.haveAppearance()) {
-                advInfo += "App:0x" + String(advertisedDevice.getAppearance(), HEX) + " ";
-            }
-            if (advertisedDevice.haveServiceUUID()) {
-                advInfo += "SVC:YES ";
-            }
-            
-            allPayloadData = advInfo.length() > 0 ? advInfo : "AdvData:NONE";
-        }
-        
-        // Payload-Daten immer speichern
-        strncpy(newDevice.payloadHex, allPayloadData.c_str(), sizeof(newDevice.payloadHex) - 1);
-        
-        // Hersteller-Informationen und Payload-Daten aktualisieren
-        deviceManager->updateManufacturerInfo(address.c_str(), newDevice.manufacturer, newDevice.deviceType, newDevice.manufacturerId, newDevice.payloadHex);
+    int deviceIndex = deviceManager->updateDevice(key, name, rssi);
+    
+    // Service-UUIDs: 16/32/128 Bit, jeweils unvollständige oder vollständige Liste
+    bool haveServiceUUID = ad.hasServiceUuids();
+    
+    // Manufacturer Data analysieren
+    const char* manufacturer = "";
+    const char* vendorType = nullptr;
+    uint16_t manufacturerId = 0;
+    
+    // Roh-Payload für die Web-Oberfläche, als Text erst in /api/devices
+    DevicePayload payload;
+    memset(&payload, 0, sizeof(payload));
+    if (ad.name.present()) payload.flags |= PAYLOAD_FLAG_NAME;
+    if (ad.serviceData.present()) payload.flags |= PAYLOAD_FLAG_SERVICE_DATA;
+    if (haveServiceUUID) payload.flags |= PAYLOAD_FLAG_SERVICE_UUIDS;
+    if (ad.haveTxPower) {
+        payload.flags |= PAYLOAD_FLAG_TX_POWER;
+        payload.txPower = ad.txPower;
+    }
+    if (ad.haveAppearance) {
+        payload.flags |= PAYLOAD_FLAG_APPEARANCE;
+        payload.appearance = ad.appearance;
+    }
+    
+    if (ad.manufacturerData.present() && ad.manufacturerData.length >= 2) {
+        const uint8_t* data = ad.manufacturerData.data;
+        manufacturerId = (data[1] << 8) | data[0];
         
-        totalDevicesSeen++;
+        payload.flags |= PAYLOAD_FLAG_MANUFACTURER;
+        payload.length = ad.manufacturerData.length < PAYLOAD_MAX_BYTES ? ad.manufacturerData.length : PAYLOAD_MAX_BYTES;
+        memcpy(payload.data, data, payload.length);
         
-        BT_DEBUG_PRINTF("BT-Scan: Gefunden - %s (%s) RSSI: %d\n", 
-                       name.c_str(), address.c_str(), rssi);
+        // Bekannte Hersteller als statischer String, unbekannte IDs formatiert getDevice()
+        const char* companyName = lookupCompanyName(manufacturerId);
+        if (companyName) manufacturer = companyName;
+        vendorType = decodeVendorPayload(manufacturerId, data + 2, ad.manufacturerData.length - 2);
     }
-}
-
-String BluetoothScanner::getManufacturerName(uint16_t companyId) {
-    switch (companyId) {
-        case 0x004C: return "Apple";
-        case 0x0075: return "Samsung";
-        case 0x00E0: return "Google";
-        case 0x0006: return "Microsoft";
-        case 0x000F: return "Broadcom";
-        case 0x0087: return "Garmin";
-        case 0x0131: return "Cypress Semiconductor";
-        default: return "Unknown (" + String(companyId, HEX) + ")";
-    }
-}
-
-String BluetoothScanner::analyzeAppleDevice(uint8_t* data, size_t length) {
-    if (length < 3) return "Apple (insufficient data)";
-    
-    uint8_t type = data[2];
-    switch (type) {
-        case 0x02: return "Apple iBeacon";
-        case 0x05: return "Apple AirDrop";
-        case 0x07: return "Apple AirPods";
-        case 0x09: return "Apple Watch";
-        case 0x0A: return "Apple Handoff";
-        case 0x0C: return "Apple Action Tag";
-        case 0x10: return "Apple Nearby";
-        default: return "Apple Device (Type: " + String(type, HEX) + ")";
+    
+    // Geräteerkennung: Produktname, dann Herstellerdaten, dann Services
+    const char* deviceType;
+    if (strstr(name, "iPhone") || strstr(name, "iPad")) {
+        deviceType = "Apple Device";
+    } else if (strstr(name, "Galaxy") || strstr(name, "Samsung")) {
+        deviceType = "Samsung Device";
+    } else if (strstr(name, "Pixel")) {
+        deviceType = "Google Device";
+    } else if (vendorType) {
+        deviceType = vendorType;
+    } else if (haveServiceUUID) {
+        deviceType = "BLE Service Device";
+    } else {
+        deviceType = "Unknown";
     }
-}
-
-String BluetoothScanner::analyzeSamsungDevice(uint8_t* data, size_t length) {
-    if (length < 3) return "Samsung (insufficient data)";
     
-    // Samsung-spezifische Analyse
-    return "Samsung Device";
+    // Hersteller-Informationen und Payload-Daten aktualisieren
+    deviceManager->updateManufacturerInfo(deviceIndex, manufacturer, deviceType, manufacturerId, &payload);
+    
+    BT_DEBUG_PRINTF("BT-Scan: Gefunden - %s (%012llx) RSSI: %d\n", name, (unsigned long long)key, rssi);
 }
-
-String BluetoothScanner::analyzePayload(uint8_t* data, size_t length, uint16_t manufacturerId) {
-    if (!data || length < 2) return "No data";
-    
-    switch (manufacturerId) {
-        case 0x004C: // Apple
-            return analyzeAppleDevice(data, length);
-        case 0x0075: // Samsung
-            return analyzeSamsungDevice(data, length);
-        default:
-            // Return raw hex data for unknown manufacturers
-            String hexStr = "";
-            for (size_t i = 0; i < length && i < 32; i++) {  // Limit to 32 bytes to avoid overflow
-                if (i > 0) hexStr += " ";
-                if (data[i] < 0x10) hexStr += "0";
-                hexStr += String(data[i], HEX);
-            }
-            return hexStr.length() > 0 ? hexStr : "No data";
-    }
-}
\ No newline at end of file
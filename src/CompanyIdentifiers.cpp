@@ -0,0 +1,105 @@
+/**
+ * @file CompanyIdentifiers.cpp
+ * @brief Tabelle der Company Identifiers und Suche
+ */
+
+#include "CompanyIdentifiers.h"
+#include <stdio.h>
+#include <string.h>
+
+// Handverlesener Auszug aus den Assigned Numbers der Bluetooth SIG
+// (assigned_numbers/company_identifiers/company_identifiers.yaml im Repository
+// https://bitbucket.org/bluetooth-SIG/public), aufsteigend nach ID. Enthalten sind
+// nur Hersteller, die in Büro- und Wohnumgebungen tatsächlich senden (Telefone,
+// Kopfhörer, Wearables, Tags, Funkchips in IoT-Geräten); die vollständige Liste hat
+// mehrere tausend Einträge. Namen sind gekürzt ("Apple" statt "Apple, Inc."),
+// fehlende IDs erscheinen als "Unknown (xxxx)".
+//
+// Ergänzen: value und name aus der YAML übernehmen, den Namen auf höchstens
+// 31 Zeichen kürzen und an der passenden Stelle einfügen - der static_assert
+// unten bricht den Build ab, wenn die Reihenfolge nicht stimmt. Die ganze Liste
+// (SIG-Namen, nach 31 Zeichen abgeschnitten) erzeugt:
+//   python3 -c "import sys, yaml; [print('    { 0x%04X, \"%s\" },' % (e['value'],
+//     e['name'][:31].replace('\"', \"'\"))) for e in sorted(yaml.safe_load(open(sys.argv[1]))
+//     ['company_identifiers'], key=lambda e: e['value'])]" company_identifiers.yaml
+static constexpr CompanyIdentifier companyIdentifiers[] = {
+    { 0x0000, "Ericsson" },
+    { 0x0001, "Nokia" },
+    { 0x0002, "Intel" },
+    { 0x0003, "IBM" },
+    { 0x0004, "Toshiba" },
+    { 0x0006, "Microsoft" },
+    { 0x0008, "Motorola" },
+    { 0x0009, "Infineon" },
+    { 0x000A, "Qualcomm (CSR)" },
+    { 0x000D, "Texas Instruments" },
+    { 0x000F, "Broadcom" },
+    { 0x001D, "Qualcomm" },
+    { 0x0025, "NXP Semiconductors" },
+    { 0x0030, "STMicroelectronics" },
+    { 0x0046, "MediaTek" },
+    { 0x004C, "Apple" },
+    { 0x0057, "Harman" },
+    { 0x0059, "Nordic Semiconductor" },
+    { 0x005D, "Realtek" },
+    { 0x0065, "HP" },
+    { 0x0067, "GN Audio (Jabra)" },
+    { 0x0075, "Samsung" },
+    { 0x0087, "Garmin" },
+    { 0x009E, "Bose" },
+    { 0x00C4, "LG Electronics" },
+    { 0x00E0, "Google" },
+    { 0x0118, "Radius Networks" },
+    { 0x012D, "Sony" },
+    { 0x0131, "Cypress Semiconductor" },
+    { 0x0157, "Huami (Amazfit)" },
+    { 0x015D, "Estimote" },
+    { 0x0171, "Amazon" },
+    { 0x027D, "Huawei" },
+    { 0x02E5, "Espressif" },
+    { 0x02FF, "Silicon Labs" },
+    { 0x038F, "Xiaomi" },
+    { 0x0499, "Ruuvi Innovations" },
+    { 0x067C, "Tile" },
+    { 0x0822, "Adafruit" },
+};
+
+static constexpr size_t COMPANY_IDENTIFIER_COUNT = sizeof(companyIdentifiers) / sizeof(companyIdentifiers[0]);
+
+static constexpr bool isStrictlySorted(const CompanyIdentifier* table, size_t count) {
+    return count < 2 || (table[0].id < table[1].id && isStrictlySorted(table + 1, count - 1));
+}
+
+static_assert(isStrictlySorted(companyIdentifiers, COMPANY_IDENTIFIER_COUNT),
+              "companyIdentifiers muss streng aufsteigend nach ID sortiert sein");
+
+const char* lookupCompanyName(uint16_t companyId) {
+    size_t low = 0;
+    size_t high = COMPANY_IDENTIFIER_COUNT;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        uint16_t id = companyIdentifiers[mid].id;
+        if (id == companyId) return companyIdentifiers[mid].name;
+        if (id < companyId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+void formatCompanyName(uint16_t companyId, char* out, size_t outSize) {
+    const char* known = lookupCompanyName(companyId);
+    if (known) {
+        strncpy(out, known, outSize - 1);
+        out[outSize - 1] = '\0';
+    } else {
+        snprintf(out, outSize, "Unknown (%x)", companyId);
+    }
+}
+
+const CompanyIdentifier* getCompanyIdentifiers(size_t& count) {
+    count = COMPANY_IDENTIFIER_COUNT;
+    return companyIdentifiers;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file DeviceIndex.cpp
+ * @brief Implementation des MAC-Hash-Index
+ */
+
+#include "DeviceIndex.h"
+
+namespace {
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+}
+
+bool parseMacKey(const char* address, MacKey& key) {
+    if (!address) return false;
+    MacKey result = 0;
+    for (int i = 0; i < 6; i++) {
+        int high = hexValue(address[i * 3]);
+        int low = high >= 0 ? hexValue(address[i * 3 + 1]) : -1;
+        if (low < 0) return false;
+        char separator = address[i * 3 + 2];
+        if (i < 5 ? (separator != ':' && separator != '-') : separator != '\0') return false;
+        result = (result << 8) | (MacKey)((high << 4) | low);
+    }
+    key = result;
+    return true;
+}
+
+MacKey macKeyFromBytes(const uint8_t* mac) {
+    MacKey result = 0;
+    for (int i = 0; i < 6; i++) {
+        result = (result << 8) | mac[i];
+    }
+    return result;
+}
+
+void formatMacKey(MacKey key, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 6; i++) {
+        uint8_t b = (uint8_t)(key >> (40 - i * 8));
+        out[i * 3] = digits[b >> 4];
+        out[i * 3 + 1] = digits[b & 0x0F];
+        out[i * 3 + 2] = (i < 5) ? ':' : '\0';
+    }
+}
+
+DeviceIndex::DeviceIndex(int maxEntries) : usedCount(0) {
+    // Füllgrad höchstens 50%, damit Sondierketten kurz bleiben
+    slotBits = 4;
+    while ((1 << slotBits) < maxEntries * 2) slotBits++;
+    slotCount = 1 << slotBits;
+    slots = new Slot[slotCount];
+    clear();
+}
+
+DeviceIndex::~DeviceIndex() {
+    delete[] slots;
+}
+
+void DeviceIndex::clear() {
+    for (int i = 0; i < slotCount; i++) {
+        slots[i].keyLow = 0;
+        slots[i].keyHigh = 0;
+        slots[i].device = NO_ENTRY;
+    }
+    usedCount = 0;
+}
+
+uint32_t DeviceIndex::home(MacKey key) const {
+    // Fibonacci-Hashing: die obersten slotBits Bits des Produkts hängen von allen Bits
+    // der Adresse ab. Fortlaufende Adressen landen so ohne Kollision nebeneinander
+    // (gemessen kürzere Sondierketten als mit mixMacKey, bei zufälligen gleich lang)
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits));
+}
+
+int DeviceIndex::locate(MacKey key) const {
+    uint32_t mask = slotCount - 1;
+    for (uint32_t i = home(key), n = 0; n < (uint32_t)slotCount; i = (i + 1) & mask, n++) {
+        if (slots[i].isEmpty()) return -1;
+        if (slots[i].key() == key) return (int)i;
+    }
+    return -1;
+}
+
+int DeviceIndex::findDevice(MacKey key) const {
+    int slot = locate(key);
+    return slot >= 0 ? slots[slot].device : NO_ENTRY;
+}
+
+bool DeviceIndex::setDevice(MacKey key, int deviceIndex) {
+    int slot = locate(key);
+    if (slot >= 0) {
+        if (deviceIndex < 0) erase(slot); else slots[slot].device = (int16_t)deviceIndex;
+        return true;
+    }
+    if (deviceIndex < 0) return true;  // nichts zu entfernen
+    if (usedCount >= slotCount - 1) return false;  // mindestens ein freier Slot beendet jede Suche
+
+    uint32_t mask = slotCount - 1;
+    uint32_t i = home(key);
+    while (!slots[i].isEmpty()) i = (i + 1) & mask;
+    slots[i].keyLow = (uint32_t)key;
+    slots[i].keyHigh = (uint16_t)(key >> 32);
+    slots[i].device = (int16_t)deviceIndex;
+    usedCount++;
+    return true;
+}
+
+void DeviceIndex::erase(int slot) {
+    // Backward-Shift-Deletion: nachfolgende Einträge der Sondierkette
+    // aufrücken lassen, statt Grabsteine zu hinterlassen
+    uint32_t mask = slotCount - 1;
+    uint32_t hole = (uint32_t)slot;
+    uint32_t i = hole;
+    while (true) {
+        i = (i + 1) & mask;
+        if (slots[i].isEmpty()) break;
+        uint32_t h = home(slots[i].key());
+        // Eintrag darf nur verschoben werden, wenn sein Heimat-Slot nicht zwischen Loch und i liegt
+        bool between = (hole <= i) ? (hole < h && h <= i) : (hole < h || h <= i);
+        if (!between) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole].device = NO_ENTRY;
+    usedCount--;
+}
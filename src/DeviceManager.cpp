@@ -4,348 +4,1283 @@
  */
 
 #include "DeviceManager.h"
+#include "CompanyIdentifiers.h"
+#include <math.h>
+#include <stddef.h>
 
-DeviceManager::DeviceManager() : devices(nullptr), deviceCount(0), knownCount(0), outputLogCount(0), outputLogIndex(0), totalEverSeen(0) {
-    memset(knownMACs, 0, sizeof(knownMACs));
+static_assert(sizeof(DeviceHot) == 16, "DeviceHot soll 16 Byte groß bleiben");
+static_assert(PRESENCE_MAX_DWELL_MS < (UINT8_MAX << PRESENCE_TICK_SHIFT), "Mindestdauer muss in DeviceHot::pendingSince passen");
+// Tabelle + zwei Snapshots (~480 Byte pro Gerät) müssen neben WLAN, Bluetooth und AsyncWebServer
+// in die ~400 KB SRAM des ESP32-C3 passen: 256 sind ~120 KB statisch, 512 (~240 KB) bleibt dem
+// Host-Bench vorbehalten (bench-scale), die Firmware startet damit nicht
+#ifdef ARDUINO
+static_assert(MAX_DEVICES <= 256, "MAX_DEVICES > 256 passt mit den Snapshots nicht mehr in den RAM");
+#endif
+
+#define LRU_NONE 0xFFFF
+
+// =================== Known-Liste als NVS-Blob ===================
+// Ein Schlüssel "known" im Namespace "known_devices": Kopf, Einträge fester Länge,
+// danach die Kommentare ohne Nullbyte hintereinander. Die CRC deckt alles nach dem Kopf ab.
+// Neuere Versionen dürfen Einträge nur hinten verlängern (entrySize), ältere Firmware
+// liest dann die bekannten Felder weiter.
+//
+// Einzelne Änderungen landen als Journal-Einträge "j0", "j1", ... mit derselben
+// Generation wie der Blob. Jeder Eintrag ist ein einziger Schreibzugriff und damit
+// ganz oder gar nicht vorhanden. Beim Verdichten wird der Blob mit neuer Generation
+// geschrieben; übrig gebliebene Einträge der alten Generation gelten dann nicht mehr.
+
+#define KNOWN_BLOB_KEY "known"
+#define KNOWN_BLOB_MAGIC 0x444B5442UL     // "BTKD"
+#define KNOWN_BLOB_VERSION 2              // 1: Kopf ohne generation
+#define KNOWN_BLOB_V1_HEADER_SIZE 16
+#define KNOWN_JOURNAL_MAGIC 0x4A4B5442UL  // "BTKJ"
+
+struct __attribute__((packed)) KnownBlobHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t entrySize;
+    uint16_t count;
+    uint32_t commentBytes;
+    uint32_t generation;  // ab Version 2
+    uint32_t crc;
+};
+
+struct __attribute__((packed)) KnownBlobEntry {
+    uint8_t mac[6];
+    int8_t rssiThreshold;
+    uint8_t commentLength;
+    PresenceTuning tuning;
+    uint32_t commentOffset;  // ab Beginn des Kommentarbereichs
+};
+
+struct __attribute__((packed)) KnownJournalHeader {
+    uint32_t magic;
+    uint32_t generation;
+    uint16_t count;
+    uint16_t length;  // Bytes nach dem Kopf
+    uint32_t crc;
+};
+
+// Danach commentLength Bytes Kommentar; op 0 = entfernt, 1 = hinzugefügt/geändert
+struct __attribute__((packed)) KnownJournalRecord {
+    uint8_t op;
+    uint8_t mac[6];
+    int8_t rssiThreshold;
+    PresenceTuning tuning;
+    uint8_t commentLength;
+};
+
+#define KNOWN_JOURNAL_BYTES (sizeof(KnownJournalHeader) + KNOWN_PENDING_MAX * (sizeof(KnownJournalRecord) + MAX_COMMENT_LENGTH))
+
+static_assert(sizeof(KnownBlobHeader) == 20, "Kopf des Known-Blobs hat 20 Byte");
+static_assert(sizeof(KnownBlobEntry) == 20, "Eintrag des Known-Blobs hat 20 Byte");
+static_assert(sizeof(KnownJournalRecord) == 17, "Journal-Eintrag hat 17 Byte plus Kommentar");
+static_assert(KNOWN_JOURNAL_BYTES <= 0xFFFF, "Journal-Eintrag zählt in 16 Bit");
+static_assert(MAX_KNOWN <= 0xFFFF && MAX_COMMENT_LENGTH <= 256, "Known-Blob zählt in 16 bzw. 8 Bit");
+static_assert(MAX_KNOWN <= 0x7FFF, "DeviceSnapshot::knownIndex ist 16 Bit");
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+    // CRC-32 (IEEE), halbbyteweise mit 16er-Tabelle
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static void macBytes(MacKey key, uint8_t* mac) {
+    for (int b = 0; b < 6; b++) {
+        mac[b] = (uint8_t)(key >> (40 - b * 8));
+    }
+}
+
+#define KNOWN_JOURNAL_KEY_SIZE 12
+
+static void journalKey(int slot, char* out) {
+    snprintf(out, KNOWN_JOURNAL_KEY_SIZE, "j%d", slot);
+}
+
+PresenceTuning defaultPresenceTuning() {
+    PresenceTuning tuning;
+    tuning.enterMargin = PRESENCE_ENTER_MARGIN_DB;
+    tuning.exitMargin = PRESENCE_EXIT_MARGIN_DB;
+    tuning.filterShift = RSSI_FILTER_SHIFT;
+    tuning.reserved = 0;
+    tuning.enterDwellMs = PRESENCE_ENTER_DWELL_MS;
+    tuning.exitDwellMs = PRESENCE_EXIT_DWELL_MS;
+    return tuning;
+}
+
+void constrainPresenceTuning(PresenceTuning& tuning) {
+    tuning.enterMargin = constrain(tuning.enterMargin, -30, 30);
+    tuning.exitMargin = constrain(tuning.exitMargin, -30, 30);
+    tuning.filterShift = min(tuning.filterShift, (uint8_t)6);
+    tuning.reserved = 0;
+    tuning.enterDwellMs = min(tuning.enterDwellMs, (uint16_t)PRESENCE_MAX_DWELL_MS);
+    tuning.exitDwellMs = min(tuning.exitDwellMs, (uint16_t)PRESENCE_MAX_DWELL_MS);
+}
+
+void constrainPresenceTuning(PresenceTuning& tuning, int enterMargin, int exitMargin, int filterShift, int enterDwellMs, int exitDwellMs) {
+    tuning.enterMargin = (int8_t)constrain(enterMargin, -30, 30);
+    tuning.exitMargin = (int8_t)constrain(exitMargin, -30, 30);
+    tuning.filterShift = (uint8_t)constrain(filterShift, 0, 6);
+    tuning.enterDwellMs = (uint16_t)constrain(enterDwellMs, 0, PRESENCE_MAX_DWELL_MS);
+    tuning.exitDwellMs = (uint16_t)constrain(exitDwellMs, 0, PRESENCE_MAX_DWELL_MS);
+    constrainPresenceTuning(tuning);
+}
+
+DeviceManager::DeviceManager() : hot(nullptr), cold(nullptr), capacity(0), lruHead(-1), lruTail(-1), evictionCount(0), droppedCount(0), activeCount(0), presentCount(0), presenceTrigger(-1), presenceListener(nullptr), presenceListenerContext(nullptr), deviceCount(0), knownCount(0), knownPendingCount(0), knownCompactPending(false), knownBatchDepth(0), lastKnownChange(0), knownGeneration(0), knownJournalCount(0), index(MAX_DEVICES), knownFilter(MAX_KNOWN), knownFilterEnabled(KNOWN_FILTER), expiry(MAX_DEVICES), expiryChecks(0), absenceMinMs(ABSENCE_TIMEOUT_MIN_FOR(BT_SCAN_MODE)), publishedSnapshot(0), snapshotEpoch(0), snapshotSkips(0), snapshotPending(false), everSeenChanged(false), everSeenEstimate(0), outputLogCount(0), outputLogIndex(0), everSeenDirty(false), lastEverSeenCheckpoint(0) {
+    memset(knownKeys, 0, sizeof(knownKeys));
     memset(knownComments, 0, sizeof(knownComments));
     memset(knownRSSIThresholds, DEFAULT_RSSI_THRESHOLD, sizeof(knownRSSIThresholds));
+    defaultTuning = defaultPresenceTuning();
+    for (int i = 0; i < MAX_KNOWN; i++) knownTuning[i] = defaultTuning;
     memset(outputLog, 0, sizeof(outputLog));
-    memset(everSeenBitfield, 0, sizeof(everSeenBitfield));
+    memset(snapshots, 0, sizeof(snapshots));
+    memset(coldDirty, 0, sizeof(coldDirty));
+    memset(stats, 0, sizeof(stats));
+    snapshotReaders[0].store(0);
+    snapshotReaders[1].store(0);
 }
 
 DeviceManager::~DeviceManager() {
     // Nothing to clean up for now
 }
 
-void DeviceManager::begin(SafeDevice* deviceArray, int maxDevices) {
-    devices = deviceArray;
+void DeviceManager::begin(DeviceHot* hotArray, DeviceCold* coldArray, int maxDevices) {
+    hot = hotArray;
+    cold = coldArray;
+    capacity = constrain(maxDevices, 1, MAX_DEVICES);
+    deviceCount = 0;
+    lruHead = -1;
+    lruTail = -1;
+    evictionCount = 0;
+    droppedCount = 0;
+    activeCount = 0;
+    presentCount = 0;
+    presenceTrigger = -1;
+    index.clear();
+    expiry.clear(millis());
+    expiryChecks = 0;
     loadKnownDevices();
+    loadEverSeen();
+    
+    // Erster Stand für Leser (noch ohne Tasks, daher ohne Sperre)
+    memset(coldDirty, 0xFF, sizeof(coldDirty));
+    everSeenChanged = true;
+    publishSnapshot();
+}
+
+void DeviceManager::loadEverSeen() {
+    everSeen.clear();
+    everSeenDirty = false;
+    everSeenChanged = true;
+    lastEverSeenCheckpoint = millis();
+    if (!DEVICES_EVER_PERSIST) return;
+    
+    preferences.begin("device_stats", true);  // read-only
+    uint8_t registers[HLL_REGISTERS];
+    if (preferences.getBytesLength("hll") == sizeof(registers) &&
+        preferences.getBytes("hll", registers, sizeof(registers)) == sizeof(registers)) {
+        everSeen.load(registers);
+    }
+    preferences.end();
+}
+
+void DeviceManager::checkpointEverSeen(bool force) {
+    if (!DEVICES_EVER_PERSIST) return;
+    
+    // Register unter der Sperre kopieren, in den Flash erst danach schreiben
+    std::lock_guard<std::mutex> persist(persistMutex);
+    uint8_t* registers;
+    {
+        Lock lock(*this);
+        if (!everSeenDirty) return;
+        if (!force && millis() - lastEverSeenCheckpoint < DEVICES_EVER_CHECKPOINT_MS) return;
+        registers = (uint8_t*)malloc(everSeen.size());
+        if (!registers) return;
+        memcpy(registers, everSeen.data(), everSeen.size());
+        everSeenDirty = false;
+        lastEverSeenCheckpoint = millis();
+    }
+    
+    preferences.begin("device_stats", false);  // read-write
+    bool ok = preferences.putBytes("hll", registers, everSeen.size()) == everSeen.size();
+    preferences.end();
+    free(registers);
+    if (!ok) {
+        Lock lock(*this);
+        everSeenDirty = true;  // nächster Checkpoint versucht es erneut
+    }
 }
 
 void DeviceManager::loadKnownDevices() {
+    knownCount = 0;
+    knownFilter.clear();
+    knownGeneration = 0;
+    knownJournalCount = 0;
+    knownPendingCount = 0;
+    knownCompactPending = false;
+    knownBatchDepth = 0;
     preferences.begin("known_devices", true);  // read-only
+    int legacyEntries = -1;
+    if (!loadKnownBlob() && preferences.isKey("count")) {
+        legacyEntries = loadLegacyKnownDevices();
+    }
+    rebuildIndex();
     
-    knownCount = preferences.getInt("count", 0);
-    if (knownCount > MAX_KNOWN) knownCount = MAX_KNOWN;
+    // Journal der aktuellen Generation in Reihenfolge nachspielen; der erste fehlende
+    // oder ungültige Eintrag beendet es (danach wurde nie etwas bestätigt)
+    if (legacyEntries < 0) {
+        while (knownJournalCount < KNOWN_JOURNAL_MAX && replayKnownJournal(knownJournalCount)) {
+            knownJournalCount++;
+        }
+    }
+    preferences.end();
     
-    for (int i = 0; i < knownCount; i++) {
+    // Alte Einzel-Schlüssel einmalig in den Blob überführen
+    if (legacyEntries >= 0) {
+        writeKnownBlob(knownGeneration, legacyEntries);
+    }
+}
+
+bool DeviceManager::loadKnownBlob() {
+    size_t length = preferences.getBytesLength(KNOWN_BLOB_KEY);
+    if (length < KNOWN_BLOB_V1_HEADER_SIZE) return false;
+    
+    uint8_t* blob = (uint8_t*)malloc(length);
+    if (!blob) return false;
+    bool ok = false;
+    if (preferences.getBytes(KNOWN_BLOB_KEY, blob, length) == length) {
+        KnownBlobHeader header;
+        size_t headerSize = sizeof(header);
+        memset(&header, 0, sizeof(header));
+        memcpy(&header, blob, min(length, sizeof(header)));
+        if (header.version == 1) {
+            // Version 1: crc direkt nach commentBytes, Generation 0
+            headerSize = KNOWN_BLOB_V1_HEADER_SIZE;
+            memcpy(&header.crc, blob + offsetof(KnownBlobHeader, generation), sizeof(header.crc));
+            header.generation = 0;
+        }
+        const uint8_t* body = blob + headerSize;
+        size_t bodyLength = length - min(length, headerSize);
+        ok = length >= headerSize && header.magic == KNOWN_BLOB_MAGIC && header.version >= 1 &&
+             header.entrySize >= sizeof(KnownBlobEntry) &&
+             bodyLength == (size_t)header.count * header.entrySize + header.commentBytes &&
+             crc32(body, bodyLength) == header.crc;
+        if (ok) {
+            // Ab dieser Firmware sortiert gespeichert, dann hängt jeder Eintrag nur hinten an;
+            // ältere Blobs werden beim Laden einsortiert
+            const uint8_t* comments = body + (size_t)header.count * header.entrySize;
+            for (int i = 0; i < header.count && knownCount < MAX_KNOWN; i++) {
+                KnownBlobEntry entry;
+                memcpy(&entry, body + (size_t)i * header.entrySize, sizeof(entry));
+                if (entry.commentOffset > header.commentBytes || entry.commentLength > header.commentBytes - entry.commentOffset) continue;
+                
+                char comment[MAX_COMMENT_LENGTH];
+                size_t commentLength = min((size_t)entry.commentLength, sizeof(comment) - 1);
+                memcpy(comment, comments + entry.commentOffset, commentLength);
+                comment[commentLength] = '\0';
+                PresenceTuning tuning = entry.tuning;
+                upsertKnown(macKeyFromBytes(entry.mac), comment, entry.rssiThreshold, &tuning);
+            }
+            knownGeneration = header.generation;
+        }
+    }
+    free(blob);
+    return ok;
+}
+
+bool DeviceManager::replayKnownJournal(int slot) {
+    char key[KNOWN_JOURNAL_KEY_SIZE];
+    journalKey(slot, key);
+    size_t length = preferences.getBytesLength(key);
+    if (length < sizeof(KnownJournalHeader) || length > KNOWN_JOURNAL_BYTES) return false;
+    
+    // Auf dem Heap wie der Blob: bis zu KNOWN_JOURNAL_BYTES sind zu viel für einen Task-Stack
+    uint8_t* batch = (uint8_t*)malloc(length);
+    if (!batch) return false;
+    bool ok = preferences.getBytes(key, batch, length) == length;
+    KnownJournalHeader header;
+    memcpy(&header, batch, sizeof(header));
+    const uint8_t* body = batch + sizeof(header);
+    ok = ok && header.magic == KNOWN_JOURNAL_MAGIC && header.generation == knownGeneration &&
+         header.length == length - sizeof(header) && crc32(body, header.length) == header.crc;
+    
+    // Erst vollständig prüfen, dann anwenden
+    size_t offset = 0;
+    for (int i = 0; ok && i < header.count; i++) {
+        KnownJournalRecord record;
+        if (offset + sizeof(record) > header.length) {
+            ok = false;
+            break;
+        }
+        memcpy(&record, body + offset, sizeof(record));
+        offset += sizeof(record) + record.commentLength;
+        ok = offset <= header.length && record.commentLength < MAX_COMMENT_LENGTH;
+    }
+    if (!ok) {
+        free(batch);
+        return false;
+    }
+    offset = 0;
+    for (int i = 0; i < header.count; i++) {
+        KnownJournalRecord record;
+        memcpy(&record, body + offset, sizeof(record));
+        MacKey mac = macKeyFromBytes(record.mac);
+        if (record.op) {
+            char comment[MAX_COMMENT_LENGTH];
+            memcpy(comment, body + offset + sizeof(record), record.commentLength);
+            comment[record.commentLength] = '\0';
+            PresenceTuning tuning = record.tuning;
+            upsertKnown(mac, comment, record.rssiThreshold, &tuning);
+        } else {
+            eraseKnown(mac);
+        }
+        offset += sizeof(record) + record.commentLength;
+    }
+    free(batch);
+    return true;
+}
+
+int DeviceManager::loadLegacyKnownDevices() {
+    // Stand vor dem Blob: count + macN/commentN/thresholdN/tuningN
+    int storedEntries = max(0, (int)preferences.getInt("count", 0));
+    int storedCount = min(storedEntries, MAX_KNOWN);
+    
+    for (int i = 0; i < storedCount; i++) {
         String macKey = "mac" + String(i);
         String commentKey = "comment" + String(i);
         String thresholdKey = "threshold" + String(i);
+        String tuningKey = "tuning" + String(i);
         
         String mac = preferences.getString(macKey.c_str(), "");
         String comment = preferences.getString(commentKey.c_str(), "");
         int threshold = preferences.getInt(thresholdKey.c_str(), DEFAULT_RSSI_THRESHOLD);
         
-        if (mac.length() > 0) {
-            strncpy(knownMACs[i], mac.c_str(), sizeof(knownMACs[i]) - 1);
-            strncpy(knownComments[i], comment.c_str(), sizeof(knownComments[i]) - 1);
-            knownRSSIThresholds[i] = threshold;
+        // Ältere Stände ohne Eintrag bekommen die Standardwerte
+        PresenceTuning tuning = defaultPresenceTuning();
+        if (preferences.getBytesLength(tuningKey.c_str()) == sizeof(tuning)) {
+            preferences.getBytes(tuningKey.c_str(), &tuning, sizeof(tuning));
+            constrainPresenceTuning(tuning);
+        }
+        
+        // Nur gültige Adressen übernehmen, sonst wären sie im Index nicht auffindbar
+        MacKey key;
+        if (parseMacKey(mac.c_str(), key)) {
+            upsertKnown(key, comment.c_str(), threshold, &tuning);
         }
     }
-    
-    preferences.end();
+    return storedEntries;
+}
+
+void DeviceManager::rebuildIndex() {
+    index.clear();
+    for (int i = 0; i < deviceCount; i++) {
+        index.setDevice(hot[i].key(), i);
+    }
 }
 
 void DeviceManager::saveKnownDevices() {
-    preferences.begin("known_devices", false);  // read-write
-    
-    preferences.putInt("count", knownCount);
+    {
+        Lock lock(*this);
+        knownCompactPending = true;
+    }
+    flushKnownDevices(true);
+}
+
+uint8_t* DeviceManager::buildKnownJournal(size_t& length) {
+    // Aktueller Stand jeder geänderten Adresse: gesammelte Änderungen derselben
+    // Adresse ergeben einen Eintrag
+    uint8_t* batch = (uint8_t*)malloc(KNOWN_JOURNAL_BYTES);
+    if (!batch) return nullptr;
+    uint8_t* body = batch + sizeof(KnownJournalHeader);
+    size_t offset = 0;
+    for (int i = 0; i < knownPendingCount; i++) {
+        KnownJournalRecord record;
+        memset(&record, 0, sizeof(record));
+        macBytes(knownPending[i], record.mac);
+        int known = findKnown(knownPending[i]);
+        if (known >= 0) {
+            record.op = 1;
+            record.rssiThreshold = knownRSSIThresholds[known];
+            record.tuning = knownTuning[known];
+            record.commentLength = (uint8_t)strnlen(knownComments[known], sizeof(knownComments[known]) - 1);
+        }
+        memcpy(body + offset, &record, sizeof(record));
+        if (known >= 0) memcpy(body + offset + sizeof(record), knownComments[known], record.commentLength);
+        offset += sizeof(record) + record.commentLength;
+    }
     
-    for (int i = 0; i < knownCount; i++) {
-        String macKey = "mac" + String(i);
-        String commentKey = "comment" + String(i);
-        String thresholdKey = "threshold" + String(i);
+    KnownJournalHeader header;
+    header.magic = KNOWN_JOURNAL_MAGIC;
+    header.generation = knownGeneration;
+    header.count = (uint16_t)knownPendingCount;
+    header.length = (uint16_t)offset;
+    header.crc = crc32(body, offset);
+    memcpy(batch, &header, sizeof(header));
+    length = sizeof(header) + offset;
+    return batch;
+}
+
+void DeviceManager::noteKnownChange(MacKey key) {
+    lastKnownChange = millis();
+    if (knownCompactPending) return;
+    for (int i = 0; i < knownPendingCount; i++) {
+        if (knownPending[i] == key) return;
+    }
+    if (knownPendingCount < KNOWN_PENDING_MAX) {
+        knownPending[knownPendingCount++] = key;
+    } else {
+        knownCompactPending = true;  // zu viele für einen Journal-Eintrag: ganze Liste
+    }
+}
+
+void DeviceManager::flushKnownDevices(bool force) {
+    // Nur das Kopieren läuft unter der Tabellen-Sperre, der Flash-Zugriff danach; der
+    // Ingest-Task wartet so nie auf einen Schreibvorgang. persistMutex hält loop() und
+    // Web-Handler auseinander, es ist also höchstens ein Eintrag unterwegs
+    std::lock_guard<std::mutex> persist(persistMutex);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool compact;
+        uint32_t generation;
+        int slot;
+        size_t length = 0;
+        uint8_t* data;
+        {
+            Lock lock(*this);
+            if (knownPendingCount == 0 && !knownCompactPending) return;
+            if (knownBatchDepth > 0) return;
+            if (!force && millis() - lastKnownChange < KNOWN_FLUSH_DELAY_MS) return;
+            
+            // Journal voll oder zu viele Änderungen: ganze Liste mit neuer Generation
+            compact = knownCompactPending || knownJournalCount >= KNOWN_JOURNAL_MAX;
+            slot = knownJournalCount;
+            generation = compact ? knownGeneration + 1 : knownGeneration;
+            data = compact ? buildKnownBlob(generation, length) : buildKnownJournal(length);
+            if (!data) return;  // kein Speicher: bleibt vorgemerkt
+            knownPendingCount = 0;
+            knownCompactPending = false;
+        }
+        
+        preferences.begin("known_devices", false);  // read-write
+        bool ok;
+        if (compact) {
+            // Erst danach die Journal-Einträge löschen (ohne Blob gelten sie weiter,
+            // mit Blob sind sie ungültig)
+            ok = preferences.putBytes(KNOWN_BLOB_KEY, data, length) == length;
+            for (int i = 0; ok && i < slot; i++) {
+                char key[KNOWN_JOURNAL_KEY_SIZE];
+                journalKey(i, key);
+                preferences.remove(key);
+            }
+        } else {
+            char key[KNOWN_JOURNAL_KEY_SIZE];
+            journalKey(slot, key);
+            ok = preferences.putBytes(key, data, length) == length;
+        }
+        preferences.end();
+        free(data);
         
-        preferences.putString(macKey.c_str(), knownMACs[i]);
-        preferences.putString(commentKey.c_str(), knownComments[i]);
-        preferences.putInt(thresholdKey.c_str(), knownRSSIThresholds[i]);
+        Lock lock(*this);
+        if (ok) {
+            if (compact) knownGeneration = generation;
+            knownJournalCount = compact ? 0 : slot + 1;
+            return;
+        }
+        // Nicht geschrieben: die kopierten Änderungen stecken nur noch in der Liste selbst,
+        // also ganze Liste vormerken. Ein fehlgeschlagener Journal-Eintrag wird sofort als
+        // Blob nachgeholt, sonst versucht es der nächste Aufruf erneut
+        knownCompactPending = true;
+        if (compact) return;
     }
-    
-    preferences.end();
 }
 
-int DeviceManager::addKnownDevice(const char* address, const char* comment, int rssiThreshold) {
-    if (knownCount >= MAX_KNOWN) {
-        return -1;  // Array full
+void DeviceManager::beginKnownBatch() {
+    knownBatchDepth++;
+}
+
+void DeviceManager::endKnownBatch() {
+    if (knownBatchDepth > 0) knownBatchDepth--;
+}
+
+uint8_t* DeviceManager::buildKnownBlob(uint32_t generation, size_t& length) {
+    // Ein Schreibzugriff für die ganze Liste statt vier Schlüssel pro Gerät
+    size_t commentBytes = 0;
+    for (int i = 0; i < knownCount; i++) {
+        commentBytes += strnlen(knownComments[i], sizeof(knownComments[i]) - 1);
     }
+    size_t entriesLength = (size_t)knownCount * sizeof(KnownBlobEntry);
+    length = sizeof(KnownBlobHeader) + entriesLength + commentBytes;
+    uint8_t* blob = (uint8_t*)malloc(length);
+    if (!blob) return nullptr;
     
-    // Check if already known - if yes, update it
+    uint8_t* body = blob + sizeof(KnownBlobHeader);
+    uint8_t* comments = body + entriesLength;
+    uint32_t commentOffset = 0;
     for (int i = 0; i < knownCount; i++) {
-        if (strcmp(knownMACs[i], address) == 0) {
-            // Update existing entry
-            strncpy(knownComments[i], comment, sizeof(knownComments[i]) - 1);
-            knownRSSIThresholds[i] = rssiThreshold;
-            saveKnownDevices();
-            return i;  // Return existing index
-        }
+        KnownBlobEntry entry;
+        macBytes(knownKeys[i], entry.mac);
+        entry.rssiThreshold = knownRSSIThresholds[i];
+        entry.commentLength = (uint8_t)strnlen(knownComments[i], sizeof(knownComments[i]) - 1);
+        entry.commentOffset = commentOffset;
+        entry.tuning = knownTuning[i];
+        memcpy(body + (size_t)i * sizeof(entry), &entry, sizeof(entry));
+        memcpy(comments + commentOffset, knownComments[i], entry.commentLength);
+        commentOffset += entry.commentLength;
     }
     
-    // Add new device
-    strncpy(knownMACs[knownCount], address, sizeof(knownMACs[knownCount]) - 1);
-    strncpy(knownComments[knownCount], comment, sizeof(knownComments[knownCount]) - 1);
-    knownRSSIThresholds[knownCount] = rssiThreshold;
-    knownCount++;
+    KnownBlobHeader header;
+    header.magic = KNOWN_BLOB_MAGIC;
+    header.version = KNOWN_BLOB_VERSION;
+    header.entrySize = sizeof(KnownBlobEntry);
+    header.count = (uint16_t)knownCount;
+    header.commentBytes = (uint32_t)commentBytes;
+    header.generation = generation;
+    header.crc = crc32(body, length - sizeof(header));
+    memcpy(blob, &header, sizeof(header));
+    return blob;
+}
+
+bool DeviceManager::writeKnownBlob(uint32_t generation, int legacyEntries) {
+    size_t length;
+    uint8_t* blob = buildKnownBlob(generation, length);
+    if (!blob) return false;
+    
+    preferences.begin("known_devices", false);  // read-write
+    bool ok = preferences.putBytes(KNOWN_BLOB_KEY, blob, length) == length;
     
-    saveKnownDevices();
-    return knownCount - 1;
+    // Alte Schlüssel erst entfernen, wenn der Blob steht; sonst nächster Start erneut
+    if (ok && legacyEntries >= 0) {
+        for (int i = 0; i < legacyEntries; i++) {
+            preferences.remove(("mac" + String(i)).c_str());
+            preferences.remove(("comment" + String(i)).c_str());
+            preferences.remove(("threshold" + String(i)).c_str());
+            preferences.remove(("tuning" + String(i)).c_str());
+        }
+        preferences.remove("count");
+    }
+    preferences.end();
+    free(blob);
+    return ok;
+}
+
+int DeviceManager::addKnownDevice(const char* address, const char* comment, int rssiThreshold, const PresenceTuning* tuning) {
+    MacKey key;
+    if (!parseMacKey(address, key)) {
+        return -1;  // Keine gültige MAC-Adresse
+    }
+    int result = upsertKnown(key, comment, rssiThreshold, tuning);
+    if (result >= 0) noteKnownChange(key);
+    return result;
 }
 
 bool DeviceManager::removeKnownDevice(const char* address) {
-    for (int i = 0; i < knownCount; i++) {
-        if (strcmp(knownMACs[i], address) == 0) {
-            // Shift remaining elements
-            for (int j = i; j < knownCount - 1; j++) {
-                strcpy(knownMACs[j], knownMACs[j + 1]);
-                strcpy(knownComments[j], knownComments[j + 1]);
-                knownRSSIThresholds[j] = knownRSSIThresholds[j + 1];
-            }
-            knownCount--;
-            saveKnownDevices();
-            return true;
+    MacKey key;
+    if (!parseMacKey(address, key)) return false;
+    if (!eraseKnown(key)) return false;
+    noteKnownChange(key);
+    return true;
+}
+
+int DeviceManager::knownLowerBound(MacKey key) const {
+    int low = 0, high = knownCount;
+    while (low < high) {
+        int mid = (low + high) >> 1;
+        if (knownKeys[mid] < key) low = mid + 1; else high = mid;
+    }
+    return low;
+}
+
+int DeviceManager::findKnown(MacKey key) const {
+    if (knownFilterEnabled && !knownFilter.mayContain(key)) return -1;
+    int i = knownLowerBound(key);
+    return (i < knownCount && knownKeys[i] == key) ? i : -1;
+}
+
+int DeviceManager::upsertKnown(MacKey key, const char* comment, int rssiThreshold, const PresenceTuning* tuning) {
+    int i = knownLowerBound(key);
+    bool existing = i < knownCount && knownKeys[i] == key;
+    if (!existing) {
+        if (knownCount >= MAX_KNOWN) {
+            return -1;  // Array full
         }
+        
+        // Platz an der sortierten Position schaffen
+        int tail = knownCount - i;
+        memmove(&knownKeys[i + 1], &knownKeys[i], tail * sizeof(knownKeys[0]));
+        memmove(&knownComments[i + 1], &knownComments[i], tail * sizeof(knownComments[0]));
+        memmove(&knownRSSIThresholds[i + 1], &knownRSSIThresholds[i], tail * sizeof(knownRSSIThresholds[0]));
+        memmove(&knownTuning[i + 1], &knownTuning[i], tail * sizeof(knownTuning[0]));
+        knownCount++;
+        knownKeys[i] = key;
+        knownTuning[i] = defaultPresenceTuning();
+        knownFilter.add(key);
     }
-    return false;
+    
+    strncpy(knownComments[i], comment, sizeof(knownComments[i]) - 1);
+    knownComments[i][sizeof(knownComments[i]) - 1] = '\0';
+    knownRSSIThresholds[i] = (int8_t)constrain(rssiThreshold, -128, 127);
+    // tuning = nullptr: bisherige Einstellung behalten (neue Einträge: Standard)
+    if (tuning) knownTuning[i] = *tuning;
+    constrainPresenceTuning(knownTuning[i]);
+    applyKnownStatus(index.findDevice(key), i);
+    return i;
 }
 
-bool DeviceManager::isKnownDevice(const char* address) {
+bool DeviceManager::eraseKnown(MacKey key) {
+    int i = findKnown(key);
+    if (i < 0) return false;
+    
+    int tail = knownCount - i - 1;
+    memmove(&knownKeys[i], &knownKeys[i + 1], tail * sizeof(knownKeys[0]));
+    memmove(&knownComments[i], &knownComments[i + 1], tail * sizeof(knownComments[0]));
+    memmove(&knownRSSIThresholds[i], &knownRSSIThresholds[i + 1], tail * sizeof(knownRSSIThresholds[0]));
+    memmove(&knownTuning[i], &knownTuning[i + 1], tail * sizeof(knownTuning[0]));
+    knownCount--;
+    rebuildKnownFilter();
+    applyKnownStatus(index.findDevice(key), -1);
+    return true;
+}
+
+void DeviceManager::rebuildKnownFilter() {
+    // Bloom-Filter kann nicht einzeln entfernen; bei MAX_KNOWN 200 sind das 200 Hash-Aufrufe
+    knownFilter.clear();
     for (int i = 0; i < knownCount; i++) {
-        if (strcmp(knownMACs[i], address) == 0) {
-            return true;
-        }
+        knownFilter.add(knownKeys[i]);
     }
-    return false;
 }
 
-void DeviceManager::updateDevice(const char* address, const char* name, int rssi) {
-    // Ever-seen tracking: Simple Hash über MAC-Adresse
-    uint32_t hash = 0;
-    for (int i = 0; address[i] != '\0'; i++) {
-        hash = hash * 31 + (uint8_t)address[i];
+void DeviceManager::applyKnownStatus(int deviceIndex, int knownIndex) {
+    // Known-Status und Schwellwert im Hot-Record zwischenspeichern,
+    // damit der Ingest-Pfad die Known-Liste nicht anfassen muss
+    if (deviceIndex < 0) return;
+    DeviceHot& device = hot[deviceIndex];
+    bool wasKnown = device.isKnown();
+    bool wasPresent = device.isPresent();
+    if (knownIndex >= 0) {
+        device.flags |= DEVICE_FLAG_KNOWN;
+        device.rssiThreshold = knownRSSIThresholds[knownIndex];
+    } else {
+        device.flags &= ~DEVICE_FLAG_KNOWN;
+        device.rssiThreshold = DEFAULT_RSSI_THRESHOLD;
     }
-    uint8_t bitIndex = hash % 256;
-    uint8_t arrayIndex = bitIndex / 32;
-    uint8_t bitPosition = bitIndex % 32;
     
-    // Prüfe ob Gerät bereits jemals gesehen wurde
-    if (!(everSeenBitfield[arrayIndex] & (1 << bitPosition))) {
-        everSeenBitfield[arrayIndex] |= (1 << bitPosition);
-        totalEverSeen++;
+    // Nur unbekannte Geräte stehen in der LRU-Liste
+    if (wasKnown && knownIndex < 0) {
+        lruPushFront(deviceIndex);
+    } else if (!wasKnown && knownIndex >= 0) {
+        lruUnlink(deviceIndex);
     }
     
-    // Find existing device or create new one
-    int deviceIndex = -1;
-    for (int i = 0; i < deviceCount; i++) {
-        if (strcmp(devices[i].address, address) == 0) {
-            deviceIndex = i;
-            break;
-        }
+    // Neuer Grenzwert gilt sofort (Benutzeraktion, ohne Hysterese und Mindestdauer)
+    device.flags &= ~(DEVICE_FLAG_NEARBY | DEVICE_FLAG_PENDING);
+    if (device.isActive() && device.filteredRssi() >= device.rssiThreshold) {
+        device.flags |= DEVICE_FLAG_NEARBY;
     }
     
-    if (deviceIndex == -1) {
-        if (deviceCount < MAX_DEVICES) {
-            // Create new device
-            deviceIndex = deviceCount++;
-        } else {
-            // LRU-Ersatz: Ältestes Gerät (kleinstes lastSeen) ersetzen
-            unsigned long oldestTs = ULONG_MAX;
-            int oldestIdx = 0;
-            for (int i = 0; i < deviceCount; i++) {
-                unsigned long ts = devices[i].lastSeen;
-                if (ts == 0 || ts < oldestTs) {
-                    oldestTs = ts;
-                    oldestIdx = i;
-                }
-            }
-            deviceIndex = oldestIdx;
-        }
-        memset(&devices[deviceIndex], 0, sizeof(SafeDevice));
-        strncpy(devices[deviceIndex].address, address, sizeof(devices[deviceIndex].address) - 1);
-        devices[deviceIndex].firstSeenThisSession = millis();
-        devices[deviceIndex].rssiThreshold = DEFAULT_RSSI_THRESHOLD;
-        strcpy(devices[deviceIndex].manufacturer, "Unbekannt"); // Initialize as unknown
+    trackPresence(deviceIndex, device.isActive(), wasPresent);
+}
+
+bool DeviceManager::getKnownTuning(const char* address, PresenceTuning& out) const {
+    MacKey key;
+    int knownIndex = parseMacKey(address, key) ? findKnown(key) : -1;
+    out = knownIndex >= 0 ? knownTuning[knownIndex] : defaultPresenceTuning();
+    return knownIndex >= 0;
+}
+
+void DeviceManager::updateNearby(DeviceHot& device, int rssi, const PresenceTuning& tuning, bool restart) {
+    // EMA in Festkomma (dBm * 256): filtered += (sample - filtered) / 2^shift
+    int32_t sample = rssi * 256;
+    int32_t filtered = restart ? sample : device.rssiFiltered + ((sample - device.rssiFiltered) >> tuning.filterShift);
+    device.rssiFiltered = (int16_t)filtered;
+    
+    uint8_t flags = device.flags;
+    if (restart) flags &= ~(DEVICE_FLAG_NEARBY | DEVICE_FLAG_PENDING);
+    flags = (flags & DEVICE_FLAG_NEARBY) ? (flags | DEVICE_FLAG_WAS_NEARBY) : (flags & ~DEVICE_FLAG_WAS_NEARBY);
+    
+    // Hysterese: Eintritt ab Grenzwert + enterMargin, Austritt erst unter Grenzwert - exitMargin
+    bool nearby = flags & DEVICE_FLAG_NEARBY;
+    bool wantsChange = nearby ? filtered < (device.rssiThreshold - tuning.exitMargin) * 256
+                              : filtered >= (device.rssiThreshold + tuning.enterMargin) * 256;
+    if (!wantsChange) {
+        device.flags = flags & ~DEVICE_FLAG_PENDING;
+        return;
     }
     
-    if (deviceIndex >= 0) {
-        // Update device data
-        
-        // Name immer aktualisieren wenn ein neuer Name vorhanden ist
-        // Dies erlaubt Beacon-Namensaktualisierungen in Echtzeit
-        if (name && strlen(name) > 0) {
-            strncpy(devices[deviceIndex].name, name, sizeof(devices[deviceIndex].name) - 1);
-            devices[deviceIndex].name[sizeof(devices[deviceIndex].name) - 1] = '\0';
+    // Mindestdauer: Bedingung muss seit pendingSince ununterbrochen gelten. pendingSince hat
+    // nur 8 Bit, läge beim letzten Advertisement aber höchstens PRESENCE_MAX_DWELL_MS zurück
+    // (sonst wäre dort umgeschaltet worden); die Zeit seitdem kommt ungekürzt aus lastSeen
+    uint32_t nowTick = (uint32_t)millis() >> PRESENCE_TICK_SHIFT;
+    uint32_t elapsedTicks = 0;
+    if (flags & DEVICE_FLAG_PENDING) {
+        uint32_t lastTick = device.lastSeen >> PRESENCE_TICK_SHIFT;
+        elapsedTicks = (uint8_t)((uint8_t)lastTick - device.pendingSince) + (nowTick - lastTick);
+    } else {
+        flags |= DEVICE_FLAG_PENDING;
+        device.pendingSince = (uint8_t)nowTick;
+    }
+    uint32_t dwellMs = nearby ? tuning.exitDwellMs : tuning.enterDwellMs;
+    uint32_t dwellTicks = (dwellMs + (1u << PRESENCE_TICK_SHIFT) - 1) >> PRESENCE_TICK_SHIFT;
+    if (elapsedTicks >= dwellTicks) {
+        flags ^= DEVICE_FLAG_NEARBY;
+        flags &= ~DEVICE_FLAG_PENDING;
+    }
+    device.flags = flags;
+}
+
+void DeviceManager::setPresenceListener(PresenceListener listener, void* context) {
+    presenceListener = listener;
+    presenceListenerContext = context;
+}
+
+void DeviceManager::trackPresence(int deviceIndex, bool wasActive, bool wasPresent, bool fromAdvertisement) {
+    // Zähler und Auslöser nur bei Zustandswechseln anpassen
+    const DeviceHot& device = hot[deviceIndex];
+    bool active = device.isActive();
+    bool present = device.isPresent();
+    
+    if (active != wasActive) {
+        activeCount += active ? 1 : -1;
+    }
+    if (present == wasPresent) return;
+    
+    int previousTrigger = presenceTrigger;
+    if (present) {
+        presentCount++;
+        if (presenceTrigger < 0) {
+            presenceTrigger = deviceIndex;
         }
-        
-        devices[deviceIndex].rssi = rssi;
-        devices[deviceIndex].lastSeen = millis();
-        devices[deviceIndex].isActive = true;
-        devices[deviceIndex].isKnown = isKnownDevice(address);
-        
-        // Set comment and threshold for known devices
-        if (devices[deviceIndex].isKnown) {
-            for (int i = 0; i < knownCount; i++) {
-                if (strcmp(knownMACs[i], address) == 0) {
-                    strncpy(devices[deviceIndex].comment, knownComments[i], sizeof(devices[deviceIndex].comment) - 1);
-                    devices[deviceIndex].rssiThreshold = knownRSSIThresholds[i];
+    } else {
+        presentCount--;
+        if (presenceTrigger == deviceIndex) {
+            // Auslöser ist weg - nächstes anwesendes Gerät suchen (nur wenn es eins gibt)
+            presenceTrigger = -1;
+            for (int i = 0; presentCount > 0 && i < deviceCount; i++) {
+                if (i != deviceIndex && hot[i].isPresent()) {
+                    presenceTrigger = i;
                     break;
                 }
             }
         }
-        
-        // Update isNearby status
-        devices[deviceIndex].wasNearbyLastTime = devices[deviceIndex].isNearby;
-        devices[deviceIndex].isNearby = (rssi >= devices[deviceIndex].rssiThreshold);
-        
-        // Format lastSeen time
-        unsigned long timeDiff = (millis() - devices[deviceIndex].lastSeen) / 1000;
-        if (timeDiff < 60) {
-            snprintf(devices[deviceIndex].lastSeenFormatted, sizeof(devices[deviceIndex].lastSeenFormatted), "vor %lus", timeDiff);
-        } else {
-            snprintf(devices[deviceIndex].lastSeenFormatted, sizeof(devices[deviceIndex].lastSeenFormatted), "vor %lum", timeDiff / 60);
-        }
+    }
+    
+    if (presenceTrigger != previousTrigger && presenceListener) {
+        presenceListener(presenceTrigger, fromAdvertisement, presenceListenerContext);
     }
 }
 
-void DeviceManager::updateManufacturerInfo(const char* address, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const char* payloadHex) {
-    for (int i = 0; i < deviceCount; i++) {
-        if (strcmp(devices[i].address, address) == 0) {
-            // Hersteller nur aktualisieren wenn besser/neuer
-            if (manufacturer && strlen(manufacturer) > 0) {
-                if (strlen(devices[i].manufacturer) == 0 || 
-                    strcmp(devices[i].manufacturer, "Unbekannt") == 0) {
-                    strncpy(devices[i].manufacturer, manufacturer, sizeof(devices[i].manufacturer) - 1);
-                    devices[i].manufacturer[sizeof(devices[i].manufacturer) - 1] = '\0';
-                }
-            }
-            
-            // Device Type erweitern
-            if (deviceType && strlen(deviceType) > 0 && strlen(devices[i].deviceType) == 0) {
-                strncpy(devices[i].deviceType, deviceType, sizeof(devices[i].deviceType) - 1);
-                devices[i].deviceType[sizeof(devices[i].deviceType) - 1] = '\0';
-            }
-            
-            // Payload-Daten erweitern/aktualisieren (immer neueste nehmen)
-            if (payloadHex && strlen(payloadHex) > 0) {
-                strncpy(devices[i].payloadHex, payloadHex, sizeof(devices[i].payloadHex) - 1);
-                devices[i].payloadHex[sizeof(devices[i].payloadHex) - 1] = '\0';
-            }
-            
-            // Manufacturer ID aktualisieren wenn wir neue Daten haben
-            if (manufacturerId != 0) {
-                devices[i].manufacturerId = manufacturerId;
-            }
+void DeviceManager::lruUnlink(int deviceIndex) {
+    uint16_t prev = lruPrev[deviceIndex];
+    uint16_t next = lruNext[deviceIndex];
+    if (prev != LRU_NONE) lruNext[prev] = next; else lruHead = (next != LRU_NONE) ? next : -1;
+    if (next != LRU_NONE) lruPrev[next] = prev; else lruTail = (prev != LRU_NONE) ? prev : -1;
+    lruPrev[deviceIndex] = LRU_NONE;
+    lruNext[deviceIndex] = LRU_NONE;
+}
+
+void DeviceManager::lruPushFront(int deviceIndex) {
+    lruPrev[deviceIndex] = LRU_NONE;
+    lruNext[deviceIndex] = (lruHead >= 0) ? (uint16_t)lruHead : LRU_NONE;
+    if (lruHead >= 0) lruPrev[lruHead] = (uint16_t)deviceIndex; else lruTail = deviceIndex;
+    lruHead = deviceIndex;
+}
+
+bool DeviceManager::isKnownDevice(const char* address) {
+    MacKey key;
+    return parseMacKey(address, key) && findKnown(key) >= 0;
+}
+
+void DeviceManager::updateDevice(const char* address, const char* name, int rssi) {
+    MacKey key;
+    if (parseMacKey(address, key)) {
+        updateDevice(key, name, rssi);
+    }
+}
+
+int DeviceManager::updateDevice(MacKey key, const char* name, int rssi) {
+    // Ever-seen tracking: HyperLogLog über die binäre MAC-Adresse
+    if (everSeen.add(key)) {
+        everSeenDirty = true;
+        everSeenChanged = true;
+    }
+    
+    // Find existing device or create new one. Die Known-Liste wird nur für bekannte
+    // Geräte durchsucht (Flag im Hot-Record) und für neue Einträge
+    int deviceIndex = index.findDevice(key);
+    int knownIndex = (deviceIndex < 0 || hot[deviceIndex].isKnown()) ? findKnown(key) : -1;
+    
+    if (deviceIndex == -1) {
+        if (deviceCount < capacity) {
+            // Create new device
+            deviceIndex = deviceCount++;
+        } else if (lruTail >= 0) {
+            // LRU-Ersatz: am längsten nicht gesehenes unbekanntes Gerät (Ende der Liste)
+            deviceIndex = lruTail;
+            lruUnlink(deviceIndex);
+            index.setDevice(hot[deviceIndex].key(), DeviceIndex::NO_ENTRY);
+            evictionCount++;
             
-            devices[i].hasManufacturerData = true;
-            break;
+            // Verdrängtes Gerät aus der Anwesenheit austragen (unbekannt, also nur aktiv/inaktiv)
+            bool wasActive = hot[deviceIndex].isActive();
+            hot[deviceIndex].flags = 0;
+            trackPresence(deviceIndex, wasActive, false);
+        } else {
+            // Tabelle nur mit bekannten Geräten belegt - die werden nicht verdrängt
+            droppedCount++;
+            return -1;
         }
+        memset(&hot[deviceIndex], 0, sizeof(DeviceHot));
+        hot[deviceIndex].keyLow = (uint32_t)key;
+        hot[deviceIndex].keyHigh = (uint16_t)(key >> 32);
+        lruPushFront(deviceIndex);
+        applyKnownStatus(deviceIndex, knownIndex);
+        
+        memset(&cold[deviceIndex], 0, sizeof(DeviceCold));
+        cold[deviceIndex].firstSeen = millis();
+        memset(&stats[deviceIndex], 0, sizeof(DeviceStats));
+        markColdDirty(deviceIndex);
+        index.setDevice(key, deviceIndex);
+    }
+    
+    DeviceHot& device = hot[deviceIndex];
+    bool wasActive = device.isActive();
+    bool wasPresent = device.isPresent();
+    if (!device.isKnown() && lruHead != deviceIndex) {
+        lruUnlink(deviceIndex);
+        lruPushFront(deviceIndex);
     }
+    
+    // Name immer aktualisieren wenn ein neuer Name vorhanden ist
+    // Dies erlaubt Beacon-Namensaktualisierungen in Echtzeit.
+    // Cold-Record nur schreiben, wenn sich der Name tatsächlich ändert
+    if (name && name[0] != '\0') {
+        char* storedName = cold[deviceIndex].name;
+        if (strncmp(storedName, name, sizeof(cold[deviceIndex].name) - 1) != 0) {
+            strncpy(storedName, name, sizeof(cold[deviceIndex].name) - 1);
+            storedName[sizeof(cold[deviceIndex].name) - 1] = '\0';
+            markColdDirty(deviceIndex);
+        }
+    }
+    
+    device.rssi = (int8_t)constrain(rssi, -128, 127);
+    // Auch nach einer Abwesenheit unter ABSENCE_TIMEOUT_MAX_MS zählt der Abstand: sendet ein Gerät
+    // seltener als bisher, wächst sein Timeout mit, statt dass es bei jeder Pause wegfällt
+    unsigned long sinceLastSeen = millis() - device.lastSeen;
+    bool hasInterval = stats[deviceIndex].packets > 0 && (wasActive || sinceLastSeen <= ABSENCE_TIMEOUT_MAX_MS);
+    stats[deviceIndex].record(device.rssi, hasInterval, sinceLastSeen);
+    
+    // Geglätteter RSSI und Hysterese; nach Inaktivität beginnt der Filter neu
+    const PresenceTuning& tuning = knownIndex >= 0 ? knownTuning[knownIndex] : defaultTuning;
+    updateNearby(device, device.rssi, tuning, !wasActive);
+    device.flags |= DEVICE_FLAG_ACTIVE;
+    device.lastSeen = millis();
+    
+    // Das Zeitrad wird nicht pro Advertisement umgehängt, nur beim Aktivwerden und wenn
+    // das Timeout vom Standard auf das gemessene Intervall umschaltet (meist deutlich kürzer)
+    if (!wasActive || (hasInterval && stats[deviceIndex].intervals == ABSENCE_MIN_INTERVALS)) {
+        scheduleExpiry(deviceIndex);
+    }
+    
+    // Schwellwert-Übergang wird genau bei diesem Advertisement erkannt
+    trackPresence(deviceIndex, wasActive, wasPresent, true);
+    
+    return deviceIndex;
+}
+
+void DeviceManager::updateManufacturerInfo(const char* address, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const DevicePayload* payload) {
+    MacKey key;
+    if (parseMacKey(address, key)) {
+        updateManufacturerInfo(index.findDevice(key), manufacturer, deviceType, manufacturerId, payload);
+    }
+}
+
+void DeviceManager::updateManufacturerInfo(int deviceIndex, const char* manufacturer, const char* deviceType, uint16_t manufacturerId, const DevicePayload* payload) {
+    if (deviceIndex < 0 || deviceIndex >= deviceCount) return;
+    DeviceCold& details = cold[deviceIndex];
+    bool changed = false;
+    
+    // Hersteller nur setzen solange noch keiner bekannt ist
+    if (manufacturer && manufacturer[0] != '\0' && details.manufacturer[0] == '\0') {
+        strncpy(details.manufacturer, manufacturer, sizeof(details.manufacturer) - 1);
+        details.manufacturer[sizeof(details.manufacturer) - 1] = '\0';
+        changed = true;
+    }
+    
+    // Device Type erweitern
+    if (deviceType && deviceType[0] != '\0' && !details.deviceType) {
+        details.deviceType = deviceType;
+        changed = true;
+    }
+    
+    // Payload-Daten erweitern/aktualisieren (immer neueste nehmen)
+    if (payload && memcmp(&details.payload, payload, sizeof(DevicePayload)) != 0) {
+        details.payload = *payload;
+        changed = true;
+    }
+    
+    // Manufacturer ID aktualisieren wenn wir neue Daten haben
+    if (manufacturerId != 0 && details.manufacturerId != manufacturerId) {
+        details.manufacturerId = manufacturerId;
+        changed = true;
+    }
+    
+    if (changed) {
+        markColdDirty(deviceIndex);
+    }
+    
+    hot[deviceIndex].flags |= DEVICE_FLAG_MANUFACTURER;
 }
 
 void DeviceManager::setDeviceActive(const char* address, bool active) {
-    for (int i = 0; i < deviceCount; i++) {
-        if (strcmp(devices[i].address, address) == 0) {
-            devices[i].isActive = active;
-            break;
+    int deviceIndex = findDevice(address);
+    if (deviceIndex >= 0) {
+        bool wasActive = hot[deviceIndex].isActive();
+        bool wasPresent = hot[deviceIndex].isPresent();
+        if (active) {
+            hot[deviceIndex].flags |= DEVICE_FLAG_ACTIVE;
+            if (!wasActive) scheduleExpiry(deviceIndex);
+        } else {
+            hot[deviceIndex].flags &= ~DEVICE_FLAG_ACTIVE;
         }
+        trackPresence(deviceIndex, wasActive, wasPresent);
     }
 }
 
-void DeviceManager::cleanupOldDevices() {
-    unsigned long currentTime = millis();
+int DeviceManager::findDevice(const char* address) const {
+    MacKey key;
+    if (!parseMacKey(address, key)) return -1;
+    return index.findDevice(key);
+}
+
+// Gerätesicht aus Hot-/Cold-Record, gemeinsam für Live-Tabelle und Snapshot
+void formatDevicePayload(const DevicePayload& payload, const char* name, char* out, size_t outSize) {
+    static const char digits[] = "0123456789abcdef";
+    size_t pos = 0;
+    out[0] = '\0';
     
-    // Rückwärts durch die Liste gehen um beim Löschen keine Indizes zu überspringen
-    for (int i = deviceCount - 1; i >= 0; i--) {
-        if (devices[i].isActive && (currentTime - devices[i].lastSeen) > DEVICE_TIMEOUT_MS) {
-            // Gerät komplett entfernen (falls nicht bekannt)
-            if (!devices[i].isKnown) {
-                // Alle nachfolgenden Geräte nach vorne verschieben
-                for (int j = i; j < deviceCount - 1; j++) {
-                    devices[j] = devices[j + 1];
-                }
-                deviceCount--;
-            } else {
-                // Bekannte Geräte nur als inaktiv markieren
-                devices[i].isActive = false;
-            }
+    if (payload.flags & PAYLOAD_FLAG_MANUFACTURER) {
+        for (size_t i = 0; i < payload.length && pos + 3 < outSize; i++) {
+            if (i > 0) out[pos++] = ' ';
+            out[pos++] = digits[payload.data[i] >> 4];
+            out[pos++] = digits[payload.data[i] & 0x0F];
         }
+        out[pos] = '\0';
+        return;
+    }
+    
+    // Service Data markieren wenn keine Manufacturer Data vorhanden
+    if (payload.flags & PAYLOAD_FLAG_SERVICE_DATA) {
+        snprintf(out, outSize, "ServiceData:YES");
+        return;
+    }
+    
+    // Sonst die übrigen Advertising-Infos zusammenfassen
+    if ((payload.flags & PAYLOAD_FLAG_NAME) && pos < outSize) {
+        pos += snprintf(out + pos, outSize - pos, "N:%s ", name);
+    }
+    if ((payload.flags & PAYLOAD_FLAG_TX_POWER) && pos < outSize) {
+        pos += snprintf(out + pos, outSize - pos, "TX:%ddBm ", payload.txPower);
+    }
+    if ((payload.flags & PAYLOAD_FLAG_APPEARANCE) && pos < outSize) {
+        pos += snprintf(out + pos, outSize - pos, "App:0x%x ", payload.appearance);
+    }
+    if ((payload.flags & PAYLOAD_FLAG_SERVICE_UUIDS) && pos < outSize) {
+        pos += snprintf(out + pos, outSize - pos, "SVC:YES ");
+    }
+    if (pos == 0) {
+        snprintf(out, outSize, "AdvData:NONE");
     }
 }
 
-String DeviceManager::exportDevicesJson() {
-    JsonDocument doc;
-    JsonArray knownArray = doc["knownDevices"].to<JsonArray>();
+void DeviceStats::record(int rssi, bool hasInterval, uint32_t intervalMs) {
+    if (packets == 0 || rssi < rssiMin) rssiMin = (int8_t)rssi;
+    if (packets == 0 || rssi > rssiMax) rssiMax = (int8_t)rssi;
+    if (packets != UINT32_MAX) packets++;
+    if (!hasInterval) return;
     
-    for (int i = 0; i < knownCount; i++) {
-        JsonObject knownObj = knownArray.add<JsonObject>();
-        knownObj["address"] = knownMACs[i];
-        knownObj["comment"] = knownComments[i];
-        knownObj["rssiThreshold"] = knownRSSIThresholds[i];
+    // Länger als das größte Timeout kann ein aktives Gerät nicht schweigen
+    if (intervalMs > ABSENCE_TIMEOUT_MAX_MS) intervalMs = ABSENCE_TIMEOUT_MAX_MS;
+    if (intervals == 0) {
+        intervalMean = intervalMs << 4;
+        intervalVar = 0;
+    } else {
+        // EWMA mit Gewicht 1/8: mean += d/8, var += (d^2 - var)/8 (d = Abweichung vom alten Mittel)
+        int32_t deviation = (int32_t)(intervalMs << 4) - (int32_t)intervalMean;
+        intervalMean = (uint32_t)((int32_t)intervalMean + (deviation >> 3));
+        int64_t deviationMs = deviation / 16;
+        int64_t var = (int64_t)intervalVar + ((deviationMs * deviationMs - (int64_t)intervalVar) >> 3);
+        intervalVar = var > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)var;
     }
+    if (intervals != UINT16_MAX) intervals++;
+}
+
+uint32_t DeviceStats::intervalStdDevMs() const {
+    return (uint32_t)(sqrtf((float)intervalVar) + 0.5f);
+}
+
+uint32_t DeviceStats::absenceTimeoutMs(uint32_t minMs) const {
+    if (intervals < ABSENCE_MIN_INTERVALS) return DEVICE_TIMEOUT_MS;
     
-    String jsonString;
-    serializeJson(doc, jsonString);
-    return jsonString;
+    // N erwartete Advertisements verpasst; die Streuung fängt unregelmäßige Sender ab
+    uint32_t expectedMs = meanIntervalMs() + 2 * intervalStdDevMs();
+    uint32_t timeoutMs = expectedMs * ABSENCE_MISSED_ADVERTS;
+    if (timeoutMs < minMs) return minMs;
+    if (timeoutMs > (uint32_t)ABSENCE_TIMEOUT_MAX_MS) return ABSENCE_TIMEOUT_MAX_MS;
+    return timeoutMs;
 }
 
-bool DeviceManager::importDevicesJson(const String& jsonData) {
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, jsonData);
+static void fillSafeDevice(const DeviceHot& device, const DeviceCold& details, const DeviceStats& stats, uint32_t absenceMinMs, const char* comment, SafeDevice& out) {
+    memset(&out, 0, sizeof(out));
+    formatMacKey(device.key(), out.address);
+    memcpy(out.name, details.name, sizeof(out.name));
+    strncpy(out.comment, comment, sizeof(out.comment) - 1);
+    out.rssi = device.rssi;
+    out.rssiFiltered = device.filteredRssi();
+    out.packets = stats.packets;
+    out.intervalMeanMs = stats.intervals > 0 ? stats.meanIntervalMs() : 0;
+    out.intervalStdDevMs = stats.intervals > 0 ? stats.intervalStdDevMs() : 0;
+    out.absenceTimeoutMs = stats.absenceTimeoutMs(absenceMinMs);
+    out.rssiMin = stats.rssiMin;
+    out.rssiMax = stats.rssiMax;
+    out.lastSeen = device.lastSeen;
+    out.isKnown = device.isKnown();
+    out.isActive = device.isActive();
+    out.firstSeenThisSession = details.firstSeen;
+    out.rssiThreshold = device.rssiThreshold;
+    out.isNearby = device.flags & DEVICE_FLAG_NEARBY;
+    out.wasNearbyLastTime = device.flags & DEVICE_FLAG_WAS_NEARBY;
     
-    if (error) {
-        logOutputChange("", "", "", false, "Import fehlgeschlagen: JSON ungültig");
-        return false;
+    if (details.manufacturer[0] != '\0') {
+        memcpy(out.manufacturer, details.manufacturer, sizeof(out.manufacturer));
+    } else if (details.manufacturerId != 0) {
+        formatCompanyName(details.manufacturerId, out.manufacturer, sizeof(out.manufacturer));
+    } else {
+        strcpy(out.manufacturer, "Unbekannt");
+    }
+    if (details.deviceType) {
+        strncpy(out.deviceType, details.deviceType, sizeof(out.deviceType) - 1);
+    }
+    out.hasManufacturerData = device.flags & DEVICE_FLAG_MANUFACTURER;
+    if (out.hasManufacturerData) {
+        // Text erst hier beim Ausliefern, der Ingest-Pfad speichert nur Bytes
+        formatDevicePayload(details.payload, details.name, out.payloadHex, sizeof(out.payloadHex));
+    }
+    out.manufacturerId = details.manufacturerId;
+}
+
+bool DeviceManager::getDevice(int deviceIndex, SafeDevice& out) const {
+    if (deviceIndex < 0 || deviceIndex >= deviceCount) return false;
+    fillSafeDevice(hot[deviceIndex], cold[deviceIndex], stats[deviceIndex], absenceMinMs, getDeviceComment(deviceIndex), out);
+    return true;
+}
+
+bool DeviceManager::getDevice(const DeviceSnapshot& snapshot, int deviceIndex, SafeDevice& out) const {
+    if (deviceIndex < 0 || deviceIndex >= snapshot.deviceCount) return false;
+    fillSafeDevice(snapshot.hot[deviceIndex], snapshot.cold[deviceIndex], snapshot.stats[deviceIndex], snapshot.absenceMinMs,
+                   getKnownComment(snapshot, deviceIndex), out);
+    return true;
+}
+
+const char* DeviceManager::getKnownComment(const DeviceSnapshot& snapshot, int deviceIndex) const {
+    // Die Known-Liste schreiben nur Web-Handler; aus dem Web-Task ist sie ohne Sperre lesbar.
+    // Hat sie sich seit dem Snapshot verschoben, passt die Adresse nicht mehr.
+    int knownIndex = snapshot.knownIndex[deviceIndex];
+    if (knownIndex < 0 || knownIndex >= knownCount) return "";
+    if (knownKeys[knownIndex] != snapshot.hot[deviceIndex].key()) return "";
+    return knownComments[knownIndex];
+}
+
+void DeviceManager::formatDeviceAddress(int deviceIndex, char* out) const {
+    formatMacKey(hot[deviceIndex].key(), out);
+}
+
+const char* DeviceManager::getDeviceName(int deviceIndex) const {
+    return cold[deviceIndex].name;
+}
+
+const char* DeviceManager::getDeviceComment(int deviceIndex) const {
+    if (!hot[deviceIndex].isKnown()) return "";
+    int knownIndex = findKnown(hot[deviceIndex].key());
+    return knownIndex >= 0 ? knownComments[knownIndex] : "";
+}
+
+void DeviceManager::moveDevice(int from, int to) {
+    // Eintrag umziehen und alle Verweise darauf (Index, LRU-Nachbarn, Zeitrad) nachziehen
+    hot[to] = hot[from];
+    cold[to] = cold[from];
+    stats[to] = stats[from];
+    markColdDirty(to);
+    index.setDevice(hot[to].key(), to);
+    expiry.move(from, to);
+    if (presenceTrigger == from) {
+        presenceTrigger = to;  // gleiches Gerät, kein Listener-Aufruf (siehe PresenceListener)
+    }
+    if (!hot[to].isKnown()) {
+        uint16_t prev = lruPrev[from];
+        uint16_t next = lruNext[from];
+        lruPrev[to] = prev;
+        lruNext[to] = next;
+        if (prev != LRU_NONE) lruNext[prev] = (uint16_t)to; else lruHead = to;
+        if (next != LRU_NONE) lruPrev[next] = (uint16_t)to; else lruTail = to;
+    }
+}
+
+void DeviceManager::removeDeviceAt(int deviceIndex) {
+    index.setDevice(hot[deviceIndex].key(), DeviceIndex::NO_ENTRY);
+    expiry.cancel(deviceIndex);
+    if (!hot[deviceIndex].isKnown()) {
+        lruUnlink(deviceIndex);
     }
     
-    if (!doc["knownDevices"].is<JsonArray>()) {
-        logOutputChange("", "", "", false, "Import fehlgeschlagen: knownDevices fehlt");
-        return false;
+    bool wasActive = hot[deviceIndex].isActive();
+    bool wasPresent = hot[deviceIndex].isPresent();
+    hot[deviceIndex].flags = 0;
+    trackPresence(deviceIndex, wasActive, wasPresent);
+    
+    // Letztes Gerät in die Lücke (ein Umzug statt alle nachfolgenden zu verschieben);
+    // die Reihenfolge der Tabelle hat keine Bedeutung
+    int last = deviceCount - 1;
+    if (deviceIndex != last) {
+        moveDevice(last, deviceIndex);
     }
+    deviceCount--;
+}
+
+void DeviceManager::scheduleExpiry(int deviceIndex) {
+    // Erste Millisekunde, in der das Gerät als weg gilt
+    expiry.schedule(deviceIndex, hot[deviceIndex].lastSeen + stats[deviceIndex].absenceTimeoutMs(absenceMinMs) + 1);
+}
+
+void DeviceManager::setAbsenceMinMs(uint32_t minMs) {
+    if (minMs == absenceMinMs) return;
+    absenceMinMs = minMs;
     
-    JsonArray knownArray = doc["knownDevices"];
-    int importCount = 0;
-    int updateCount = 0;
-    int skippedCount = 0;
-    int startCount = knownCount;
+    // Eingeplante Zeiten gelten für die alte Grenze: kleiner würde zu spät gemeldet,
+    // größer erst beim Auslaufen korrigiert
+    for (int i = 0; i < deviceCount; i++) {
+        if (hot[i].isActive()) scheduleExpiry(i);
+    }
+}
+
+int DeviceManager::cleanupOldDevices() {
+    unsigned long currentTime = millis();
     
-    for (JsonObject knownObj : knownArray) {
-        const char* address = knownObj["address"];
-        const char* comment = knownObj["comment"] | "";
-        int rssiThreshold = knownObj["rssiThreshold"] | DEFAULT_RSSI_THRESHOLD;
-        
-        if (address && strlen(address) > 0) {
-            // Check if device existed before
-            bool existed = false;
-            for (int i = 0; i < startCount; i++) {
-                if (strcmp(knownMACs[i], address) == 0) {
-                    existed = true;
-                    break;
-                }
-            }
-            
-            int result = addKnownDevice(address, comment, rssiThreshold);
-            if (result >= 0) {
-                if (existed) {
-                    updateCount++;
-                } else {
-                    importCount++;
-                }
-            } else {
-                skippedCount++;
-            }
+    // Nur fällige Einträge des Zeitrads ansehen statt die ganze Tabelle
+    int expired = 0;
+    int i;
+    while ((i = expiry.popDue(currentTime)) != ExpiryWheel::NONE) {
+        expiryChecks++;
+        if (i >= deviceCount || !hot[i].isActive()) continue;
+        if (currentTime - hot[i].lastSeen <= stats[i].absenceTimeoutMs(absenceMinMs)) {
+            // Inzwischen wieder gesehen (oder Timeout gewachsen): neu einplanen
+            scheduleExpiry(i);
+            continue;
+        }
+        expired++;
+        // Gerät komplett entfernen (falls nicht bekannt)
+        if (!hot[i].isKnown()) {
+            removeDeviceAt(i);
+        } else {
+            // Bekannte Geräte nur als inaktiv markieren
+            bool wasPresent = hot[i].isPresent();
+            hot[i].flags &= ~DEVICE_FLAG_ACTIVE;
+            trackPresence(i, true, wasPresent);
         }
     }
+    return expired;
+}
+
+// =================== Snapshot für Web-Leser ===================
+
+void DeviceManager::markColdDirty(int deviceIndex) {
+    uint32_t bit = 1u << (deviceIndex & 31);
+    coldDirty[0][deviceIndex >> 5] |= bit;
+    coldDirty[1][deviceIndex >> 5] |= bit;
+}
+
+bool DeviceManager::publishSnapshot() {
+    // Einziger Schreiber (unter Lock). Hält ein Leser noch den freien Puffer,
+    // bleibt der alte Stand gültig und der nächste Batch versucht es erneut.
+    int next = publishedSnapshot.load(std::memory_order_relaxed) ^ 1;
+    if (snapshotReaders[next].load() != 0) {
+        snapshotSkips++;
+        snapshotPending = true;
+        return false;
+    }
     
-    // Einzige Log-Meldung mit Zusammenfassung
-    char logMsg[120];
-    if (importCount > 0 || updateCount > 0) {
-        snprintf(logMsg, sizeof(logMsg), "📥 Import: %d neu, %d aktualisiert%s", 
-                 importCount, updateCount, skippedCount > 0 ? ", einige übersprungen" : "");
-    } else {
-        snprintf(logMsg, sizeof(logMsg), "📥 Import: Keine Änderungen (%d bereits vorhanden)", updateCount + importCount);
+    if (everSeenChanged) {
+        everSeenEstimate = (int)everSeen.estimate();
+        everSeenChanged = false;
     }
-    logOutputChange("", "", "", false, logMsg);
     
-    return (importCount + updateCount + skippedCount) > 0;
+    DeviceSnapshot& snapshot = snapshots[next];
+    snapshot.deviceCount = deviceCount;
+    snapshot.activeCount = activeCount;
+    snapshot.presentCount = presentCount;
+    snapshot.presenceTrigger = presenceTrigger;
+    snapshot.totalEverSeen = everSeenEstimate;
+    snapshot.evictionCount = evictionCount;
+    
+    // Hot-Records und Statistik komplett (je 16 Byte pro Gerät), Cold-Records nur wenn geändert
+    memcpy(snapshot.hot, hot, deviceCount * sizeof(DeviceHot));
+    memcpy(snapshot.stats, stats, deviceCount * sizeof(DeviceStats));
+    uint32_t* dirty = coldDirty[next];
+    for (int word = 0; word * 32 < deviceCount; word++) {
+        uint32_t bits = dirty[word];
+        dirty[word] = 0;  // Zeilen ab deviceCount werden beim Wiederbelegen erneut markiert
+        while (bits) {
+            int i = word * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (i < deviceCount) snapshot.cold[i] = cold[i];
+        }
+    }
+    for (int i = 0; i < deviceCount; i++) {
+        snapshot.knownIndex[i] = hot[i].isKnown() ? (int16_t)findKnown(hot[i].key()) : -1;
+    }
+    snapshot.absenceMinMs = absenceMinMs;
+    snapshot.epoch = ++snapshotEpoch;
+    snapshot.publishedAt = millis();
+    
+    publishedSnapshot.store(next);
+    snapshotPending = false;
+    return true;
+}
+
+int DeviceManager::acquireSnapshot() const {
+    // Leser zuerst anmelden, dann prüfen ob der Puffer noch gültig ist; hat der
+    // Schreiber inzwischen umgeschaltet, wieder abmelden und neu versuchen.
+    // Anmelden und Umschalten sind sequentiell konsistent, damit der Schreiber
+    // einen angemeldeten Leser nie übersieht.
+    while (true) {
+        int slot = publishedSnapshot.load();
+        snapshotReaders[slot].fetch_add(1);
+        if (publishedSnapshot.load() == slot) return slot;
+        snapshotReaders[slot].fetch_sub(1);
+    }
+}
+
+void DeviceManager::releaseSnapshot(int slot) const {
+    snapshotReaders[slot].fetch_sub(1);
+}
+
+int DeviceSnapshot::find(MacKey key) const {
+    for (int i = 0; i < deviceCount; i++) {
+        if (hot[i].keyLow == (uint32_t)key && hot[i].keyHigh == (uint16_t)(key >> 32)) return i;
+    }
+    return -1;
+}
+
+int DeviceSnapshot::find(const char* address) const {
+    MacKey key;
+    return parseMacKey(address, key) ? find(key) : -1;
 }
 
 // Output Log System Implementation
@@ -371,67 +1306,8 @@ void DeviceManager::logOutputChange(const char* deviceAddress, const char* devic
     outputLogCount++;
 }
 
-String DeviceManager::getOutputLogJson() {
-    JsonDocument doc;
-    JsonArray logArray = doc["outputLog"].to<JsonArray>();
-    
-    // Anzahl der Einträge (maximal MAX_OUTPUT_LOG_ENTRIES)
-    int entriesToShow = min(outputLogCount, MAX_OUTPUT_LOG_ENTRIES);
-    
-    // Vom neuesten zum ältesten (rückwärts durch Ringpuffer)
-    for (int i = 0; i < entriesToShow; i++) {
-        int index = (outputLogIndex - i + MAX_OUTPUT_LOG_ENTRIES) % MAX_OUTPUT_LOG_ENTRIES;
-        const OutputLogEntry& entry = outputLog[index];
-        
-        JsonObject logEntry = logArray.add<JsonObject>();
-        logEntry["timestamp"] = entry.timestamp;
-        logEntry["deviceAddress"] = entry.deviceAddress;
-        logEntry["deviceName"] = entry.deviceName;
-        logEntry["comment"] = entry.comment;
-        logEntry["outputState"] = entry.outputState;
-        logEntry["reason"] = entry.reason;
-        
-        // Zeitstempel formatieren (relativ)
-        unsigned long elapsedMs = millis() - entry.timestamp;
-        if (elapsedMs < 60000) {
-            logEntry["timeAgo"] = String(elapsedMs / 1000) + "s";
-        } else if (elapsedMs < 3600000) {
-            logEntry["timeAgo"] = String(elapsedMs / 60000) + "m";
-        } else {
-            logEntry["timeAgo"] = String(elapsedMs / 3600000) + "h";
-        }
-    }
-    
-    doc["totalEntries"] = outputLogCount;
-    doc["maxEntries"] = MAX_OUTPUT_LOG_ENTRIES;
-    
-    String result;
-    serializeJson(doc, result);
-    return result;
-}
-
 void DeviceManager::clearOutputLog() {
     outputLogCount = 0;
     outputLogIndex = 0;
     memset(outputLog, 0, sizeof(outputLog));
 }
-
-int DeviceManager::getActiveCount() const {
-    int count = 0;
-    for (int i = 0; i < deviceCount; i++) {
-        if (devices[i].isActive) {
-            count++;
-        }
-    }
-    return count;
-}
-
-int DeviceManager::getPresentCount() const {
-    int count = 0;
-    for (int i = 0; i < deviceCount; i++) {
-        if (devices[i].isActive && devices[i].isKnown && devices[i].rssi >= devices[i].rssiThreshold) {
-            count++;
-        }
-    }
-    return count;
-}
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+ * @file DeviceManagerJson.cpp
+ * @brief JSON Export/Import und Output-Log Serialisierung des DeviceManagers
+ * 
+ * Eigene Übersetzungseinheit, damit der Geräte-Kern ohne ArduinoJson
+ * auch im Host-Benchmark (bench/) gebaut werden kann.
+ */
+
+#include "DeviceManager.h"
+#include <ArduinoJson.h>
+
+String DeviceManager::exportDevicesJson() {
+    JsonDocument doc;
+    JsonArray knownArray = doc["knownDevices"].to<JsonArray>();
+    
+    for (int i = 0; i < knownCount; i++) {
+        char address[18];
+        formatMacKey(knownKeys[i], address);
+        JsonObject knownObj = knownArray.add<JsonObject>();
+        knownObj["address"] = address;
+        knownObj["comment"] = knownComments[i];
+        knownObj["rssiThreshold"] = (int)knownRSSIThresholds[i];
+        knownObj["enterMargin"] = knownTuning[i].enterMargin;
+        knownObj["exitMargin"] = knownTuning[i].exitMargin;
+        knownObj["filterShift"] = knownTuning[i].filterShift;
+        knownObj["enterDwellMs"] = knownTuning[i].enterDwellMs;
+        knownObj["exitDwellMs"] = knownTuning[i].exitDwellMs;
+    }
+    
+    String jsonString;
+    serializeJson(doc, jsonString);
+    return jsonString;
+}
+
+bool DeviceManager::importDevicesJson(const String& jsonData) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, jsonData);
+    
+    if (error) {
+        logOutputChange("", "", "", false, "Import fehlgeschlagen: JSON ungültig");
+        return false;
+    }
+    
+    if (!doc["knownDevices"].is<JsonArray>()) {
+        logOutputChange("", "", "", false, "Import fehlgeschlagen: knownDevices fehlt");
+        return false;
+    }
+    
+    JsonArray knownArray = doc["knownDevices"];
+    // Alle Geräte sammeln und am Ende einmal schreiben statt pro Gerät
+    beginKnownBatch();
+    int importCount = 0;
+    int updateCount = 0;
+    int skippedCount = 0;
+    
+    for (JsonObject knownObj : knownArray) {
+        const char* address = knownObj["address"];
+        const char* comment = knownObj["comment"] | "";
+        int rssiThreshold = knownObj["rssiThreshold"] | DEFAULT_RSSI_THRESHOLD;
+        
+        if (address && strlen(address) > 0) {
+            // Check if device existed before
+            bool existed = isKnownDevice(address);
+            
+            // Fehlende Glättungsfelder (ältere Exporte) behalten die bisherige Einstellung bzw.
+            // den Standard; Werte als int lesen und begrenzen, bevor sie in die schmalen Felder gehen
+            PresenceTuning tuning;
+            getKnownTuning(address, tuning);
+            constrainPresenceTuning(tuning,
+                                    knownObj["enterMargin"] | (int)tuning.enterMargin,
+                                    knownObj["exitMargin"] | (int)tuning.exitMargin,
+                                    knownObj["filterShift"] | (int)tuning.filterShift,
+                                    knownObj["enterDwellMs"] | (int)tuning.enterDwellMs,
+                                    knownObj["exitDwellMs"] | (int)tuning.exitDwellMs);
+            
+            int result = addKnownDevice(address, comment, rssiThreshold, &tuning);
+            if (result >= 0) {
+                if (existed) {
+                    updateCount++;
+                } else {
+                    importCount++;
+                }
+            } else {
+                skippedCount++;
+            }
+        }
+    }
+    endKnownBatch();
+    
+    // Einzige Log-Meldung mit Zusammenfassung
+    char logMsg[120];
+    if (importCount > 0 || updateCount > 0) {
+        snprintf(logMsg, sizeof(logMsg), "📥 Import: %d neu, %d aktualisiert%s", 
+                 importCount, updateCount, skippedCount > 0 ? ", einige übersprungen" : "");
+    } else {
+        snprintf(logMsg, sizeof(logMsg), "📥 Import: Keine Änderungen (%d bereits vorhanden)", updateCount + importCount);
+    }
+    logOutputChange("", "", "", false, logMsg);
+    
+    return (importCount + updateCount + skippedCount) > 0;
+}
+
+// Output Log System Serialisierung
+String DeviceManager::getOutputLogJson() {
+    JsonDocument doc;
+    JsonArray logArray = doc["outputLog"].to<JsonArray>();
+    
+    // Anzahl der Einträge (maximal MAX_OUTPUT_LOG_ENTRIES)
+    int entriesToShow = min(outputLogCount, MAX_OUTPUT_LOG_ENTRIES);
+    
+    // Vom neuesten zum ältesten (rückwärts durch Ringpuffer)
+    for (int i = 0; i < entriesToShow; i++) {
+        int index = (outputLogIndex - i + MAX_OUTPUT_LOG_ENTRIES) % MAX_OUTPUT_LOG_ENTRIES;
+        const OutputLogEntry& entry = outputLog[index];
+        
+        JsonObject logEntry = logArray.add<JsonObject>();
+        logEntry["timestamp"] = entry.timestamp;
+        logEntry["deviceAddress"] = entry.deviceAddress;
+        logEntry["deviceName"] = entry.deviceName;
+        logEntry["comment"] = entry.comment;
+        logEntry["outputState"] = entry.outputState;
+        logEntry["reason"] = entry.reason;
+        
+        // Zeitstempel formatieren (relativ)
+        unsigned long elapsedMs = millis() - entry.timestamp;
+        if (elapsedMs < 60000) {
+            logEntry["timeAgo"] = String(elapsedMs / 1000) + "s";
+        } else if (elapsedMs < 3600000) {
+            logEntry["timeAgo"] = String(elapsedMs / 60000) + "m";
+        } else {
+            logEntry["timeAgo"] = String(elapsedMs / 3600000) + "h";
+        }
+    }
+    
+    doc["totalEntries"] = outputLogCount;
+    doc["maxEntries"] = MAX_OUTPUT_LOG_ENTRIES;
+    
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
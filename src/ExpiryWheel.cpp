@@ -0,0 +1,120 @@
+/**
+ * @file ExpiryWheel.cpp
+ * @brief Implementation des Zeitrads für Abwesenheits-Timeouts
+ */
+
+#include "ExpiryWheel.h"
+
+static const uint32_t SLOT_MASK = EXPIRY_WHEEL_SLOTS - 1;
+
+ExpiryWheel::ExpiryWheel(int maxEntries) : maxEntries(maxEntries) {
+    slotHead = new int16_t[EXPIRY_WHEEL_SLOTS];
+    next = new int16_t[maxEntries];
+    prev = new int16_t[maxEntries];
+    dueTick = new uint32_t[maxEntries];
+    clear(0);
+}
+
+ExpiryWheel::~ExpiryWheel() {
+    delete[] slotHead;
+    delete[] next;
+    delete[] prev;
+    delete[] dueTick;
+}
+
+void ExpiryWheel::clear(unsigned long now) {
+    for (int i = 0; i < EXPIRY_WHEEL_SLOTS; i++) {
+        slotHead[i] = NONE;
+    }
+    for (int i = 0; i < maxEntries; i++) {
+        next[i] = NONE;
+        prev[i] = NOT_LINKED;
+        dueTick[i] = 0;
+    }
+    scheduledCount = 0;
+    currentTick = 0;
+    cursorTick = 0;
+    tickBase = now;
+}
+
+void ExpiryWheel::advance(unsigned long now) {
+    // Uhr rückwärts (oder Lücke > 24 Tage): Stand behalten, Einträge werden dann eben später fällig
+    int32_t elapsed = (int32_t)(uint32_t)(now - tickBase);
+    if (elapsed <= 0) return;
+    uint32_t ticks = (uint32_t)elapsed >> EXPIRY_TICK_SHIFT;
+    currentTick += ticks;
+    tickBase += (unsigned long)ticks << EXPIRY_TICK_SHIFT;
+}
+
+void ExpiryWheel::link(int entry, uint32_t tick) {
+    uint32_t slot = tick & SLOT_MASK;
+    dueTick[entry] = tick;
+    prev[entry] = NONE;
+    next[entry] = slotHead[slot];
+    if (slotHead[slot] != NONE) prev[slotHead[slot]] = (int16_t)entry;
+    slotHead[slot] = (int16_t)entry;
+    scheduledCount++;
+}
+
+void ExpiryWheel::unlink(int entry) {
+    if (prev[entry] == NONE) {
+        slotHead[dueTick[entry] & SLOT_MASK] = next[entry];
+    } else {
+        next[prev[entry]] = next[entry];
+    }
+    if (next[entry] != NONE) prev[next[entry]] = prev[entry];
+    prev[entry] = NOT_LINKED;
+    next[entry] = NONE;
+    scheduledCount--;
+}
+
+void ExpiryWheel::schedule(int entry, unsigned long dueMs) {
+    if (entry < 0 || entry >= maxEntries) return;
+    if (isScheduled(entry)) unlink(entry);
+
+    // Aufgerundet auf den Tick, damit ein fälliger Eintrag nie vor dueMs ausgegeben wird;
+    // Vergangenes kommt in den aktuellen Tick, zu Fernes an den Rand der Reichweite
+    int32_t offset = (int32_t)(uint32_t)(dueMs - tickBase);
+    if (offset < 0) offset = 0;
+    if ((unsigned long)offset > RANGE_MS) offset = (int32_t)RANGE_MS;
+    uint32_t ticks = ((uint32_t)offset + (1u << EXPIRY_TICK_SHIFT) - 1) >> EXPIRY_TICK_SHIFT;
+    link(entry, currentTick + ticks);
+}
+
+void ExpiryWheel::cancel(int entry) {
+    if (entry >= 0 && entry < maxEntries && isScheduled(entry)) unlink(entry);
+}
+
+void ExpiryWheel::move(int from, int to) {
+    cancel(to);
+    if (!isScheduled(from)) return;
+
+    next[to] = next[from];
+    prev[to] = prev[from];
+    dueTick[to] = dueTick[from];
+    if (prev[to] == NONE) slotHead[dueTick[to] & SLOT_MASK] = (int16_t)to; else next[prev[to]] = (int16_t)to;
+    if (next[to] != NONE) prev[next[to]] = (int16_t)to;
+    prev[from] = NOT_LINKED;
+    next[from] = NONE;
+}
+
+int ExpiryWheel::popDue(unsigned long now) {
+    advance(now);
+
+    // Nach langer Pause jeden Slot höchstens einmal besuchen
+    if (currentTick - cursorTick >= EXPIRY_WHEEL_SLOTS) {
+        cursorTick = currentTick - (EXPIRY_WHEEL_SLOTS - 1);
+    }
+    while (true) {
+        // Ein Slot kann Einträge einer späteren Umdrehung enthalten; die bleiben hängen
+        for (int entry = slotHead[cursorTick & SLOT_MASK]; entry != NONE; entry = next[entry]) {
+            if ((int32_t)(dueTick[entry] - currentTick) <= 0) {
+                unlink(entry);
+                return entry;
+            }
+        }
+        // Der aktuelle Tick bleibt offen, er kann noch neue fällige Einträge bekommen
+        if (cursorTick == currentTick) return NONE;
+        cursorTick++;
+    }
+}
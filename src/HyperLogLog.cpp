@@ -0,0 +1,71 @@
+/**
+ * @file HyperLogLog.cpp
+ * @brief Implementation des HyperLogLog-Schätzers
+ */
+
+#include "HyperLogLog.h"
+#include <math.h>
+
+HyperLogLog::HyperLogLog() {
+    clear();
+}
+
+void HyperLogLog::clear() {
+    memset(registers, 0, sizeof(registers));
+    harmonicSum = HLL_REGISTERS;  // jedes Register trägt 2^-0 bei
+    zeroRegisters = HLL_REGISTERS;
+    cachedEstimate = 0;
+    cacheValid = true;
+}
+
+void HyperLogLog::recount() {
+    harmonicSum = 0.0;
+    zeroRegisters = 0;
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        harmonicSum += ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) zeroRegisters++;
+    }
+}
+
+bool HyperLogLog::add(uint64_t key) {
+    uint64_t hash = mixMacKey(key);
+    uint32_t bucket = (uint32_t)(hash >> (64 - HLL_PRECISION));
+    uint64_t rest = hash << HLL_PRECISION;
+    // Position der ersten 1 in den restlichen 54 Bits (1-basiert)
+    uint8_t rank = rest ? (uint8_t)(__builtin_clzll(rest) + 1) : (uint8_t)(64 - HLL_PRECISION + 1);
+    uint8_t previous = registers[bucket];
+    if (rank <= previous) {
+        return false;
+    }
+    // Summe und Null-Register mitführen, damit estimate() nicht alle Register lesen muss
+    harmonicSum += ldexp(1.0, -rank) - ldexp(1.0, -previous);
+    if (previous == 0) zeroRegisters--;
+    registers[bucket] = rank;
+    cacheValid = false;
+    return true;
+}
+
+uint32_t HyperLogLog::estimate() const {
+    if (cacheValid) {
+        return cachedEstimate;
+    }
+
+    const double m = HLL_REGISTERS;
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / harmonicSum;
+
+    // Kleiner Bereich: Linear Counting ist dort genauer
+    if (estimate <= 2.5 * m && zeroRegisters > 0) {
+        estimate = m * log(m / zeroRegisters);
+    }
+
+    cachedEstimate = (uint32_t)(estimate + 0.5);
+    cacheValid = true;
+    return cachedEstimate;
+}
+
+void HyperLogLog::load(const uint8_t* data) {
+    memcpy(registers, data, sizeof(registers));
+    recount();
+    cacheValid = false;
+}
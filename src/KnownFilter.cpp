@@ -0,0 +1,28 @@
+/**
+ * @file KnownFilter.cpp
+ * @brief Implementation des Bloom-Vorfilters für die Known-Liste
+ */
+
+#include "KnownFilter.h"
+
+KnownFilter::KnownFilter(int maxEntries) {
+    // ~20 Bit pro Eintrag, mindestens 8 Wörter
+    uint32_t wordCount = 8;
+    while (wordCount * 64 < (uint32_t)maxEntries * 20) wordCount <<= 1;
+    words = new uint64_t[wordCount];
+    wordMask = wordCount - 1;
+    clear();
+}
+
+KnownFilter::~KnownFilter() {
+    delete[] words;
+}
+
+void KnownFilter::clear() {
+    memset(words, 0, sizeBytes());
+}
+
+void KnownFilter::add(MacKey key) {
+    uint64_t hash = mixMacKey(key);
+    words[(uint32_t)(hash >> 32) & wordMask] |= bitsFor(hash);
+}
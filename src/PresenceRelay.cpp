@@ -0,0 +1,126 @@
+/**
+ * @file PresenceRelay.cpp
+ * @brief Implementierung des ereignisgesteuerten Relais-Pfads
+ */
+
+#include "PresenceRelay.h"
+#include "DeviceManager.h"
+
+// =================== LatencyHistogram ===================
+
+void LatencyHistogram::clear() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    maxMicros = 0;
+}
+
+void LatencyHistogram::record(uint32_t latencyMicros) {
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && (latencyMicros >> (bucket + 1)) != 0) bucket++;
+    buckets[bucket]++;
+    count++;
+    if (latencyMicros > maxMicros) maxMicros = latencyMicros;
+}
+
+uint32_t LatencyHistogram::percentile(float p) const {
+    if (count == 0) return 0;
+    uint32_t rank = (uint32_t)(p * (count - 1)) + 1;
+    uint32_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = (i < BUCKETS - 1) ? (2u << i) - 1 : maxMicros;
+            return upper < maxMicros ? upper : maxMicros;
+        }
+    }
+    return maxMicros;
+}
+
+// =================== PresenceRelay ===================
+
+PresenceRelay::PresenceRelay()
+    : deviceManager(nullptr), relayPin(RELAY_OUTPUT_PIN), ledPin(LED_BUILTIN_PIN),
+      wakeup(nullptr), wakeupContext(nullptr), outputState(false),
+      switchCount(0), overflowCount(0) {
+    latency.clear();
+}
+
+void PresenceRelay::begin(DeviceManager* devMgr, uint8_t relayOutputPin, uint8_t ledOutputPin) {
+    deviceManager = devMgr;
+    relayPin = relayOutputPin;
+    ledPin = ledOutputPin;
+    outputState.store(digitalRead(relayPin) == HIGH, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    latency.clear();
+    switchCount = 0;
+    overflowCount = 0;
+}
+
+void PresenceRelay::setWakeup(void (*wakeupFunction)(void* context), void* context) {
+    wakeupContext = context;
+    wakeup = wakeupFunction;
+}
+
+bool PresenceRelay::post(int triggerIndex, uint32_t advertMicros) {
+    // Ohne Task gäbe es zwei Verbraucher - dann schaltet loop() wie bisher
+    if (!wakeup) return false;
+
+    PresenceEvent event;
+    event.advertMicros = advertMicros;
+    event.trigger = (int16_t)triggerIndex;
+    event.present = triggerIndex >= 0 ? 1 : 0;
+    event.reserved = 0;
+    bool queued = queue.push(event);
+    if (!queued) overflowCount++;
+
+    // Auch bei voller Warteschlange wecken: der Task übernimmt den aktuellen Stand
+    wakeup(wakeupContext);
+    return queued;
+}
+
+void PresenceRelay::wake() {
+    if (wakeup) {
+        wakeup(wakeupContext);
+    } else {
+        process();
+    }
+}
+
+void PresenceRelay::process() {
+    if (!deviceManager) return;
+
+    // Ereignisse vor dem Zustand lesen: der Zustand ist damit mindestens so neu wie jedes Ereignis
+    PresenceEvent events[RELAY_EVENT_QUEUE_SIZE];
+    int eventCount = 0;
+    while (eventCount < RELAY_EVENT_QUEUE_SIZE && queue.pop(events[eventCount])) {
+        eventCount++;
+    }
+
+    bool on = deviceManager->getPresenceTrigger() >= 0;
+    if (on == getOutputState()) return;
+
+    applyOutput(on);
+    uint32_t now = micros();
+
+    // Latenz nur für Ereignisse, deren Zustand tatsächlich am Ausgang angekommen ist;
+    // die Sperre hält nur die paar Zähler, geschaltet ist schon
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    for (int i = 0; i < eventCount; i++) {
+        if ((events[i].present != 0) == on) {
+            latency.record(now - events[i].advertMicros);
+        }
+    }
+}
+
+LatencyHistogram PresenceRelay::getLatency() const {
+    std::lock_guard<std::mutex> lock(latencyMutex);
+    return latency;
+}
+
+void PresenceRelay::applyOutput(bool on) {
+    // Relais: normale Logik (HIGH = AN), LED: invertiert (LOW = AN)
+    digitalWrite(relayPin, on ? HIGH : LOW);
+    digitalWrite(ledPin, on ? LOW : HIGH);
+    outputState.store(on, std::memory_order_release);
+    switchCount++;
+}
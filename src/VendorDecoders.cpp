@@ -0,0 +1,71 @@
+/**
+ * @file VendorDecoders.cpp
+ * @brief Eingebaute Decoder (Apple, Microsoft) und Registry
+ */
+
+#include "VendorDecoders.h"
+
+static const char* decodeApple(const uint8_t* data, size_t length) {
+    // Continuity-Nachrichten: erstes Byte ist der Nachrichtentyp
+    if (length < 1) return "Apple Device";
+    switch (data[0]) {
+        case 0x02: return "Apple iBeacon";
+        case 0x05: return "Apple AirDrop";
+        case 0x07: return "Apple AirPods";
+        case 0x09: return "Apple Watch";
+        case 0x0A: return "Apple Handoff";
+        case 0x0C: return "Apple Action Tag";
+        case 0x10: return "Apple Nearby";
+        case 0x12: return "Apple Find My";
+        default: return "Apple Device";
+    }
+}
+
+static const char* decodeMicrosoft(const uint8_t* data, size_t length) {
+    if (length < 1) return nullptr;
+    switch (data[0]) {
+        case 0x01: return "Windows Device";      // Connected Devices Platform
+        case 0x03: return "Microsoft Swift Pair";
+        default: return nullptr;
+    }
+}
+
+struct VendorDecoderEntry {
+    uint16_t companyId;
+    VendorDecoder decode;
+};
+
+static VendorDecoderEntry vendorDecoders[MAX_VENDOR_DECODERS] = {
+    { 0x004C, decodeApple },
+    { 0x0006, decodeMicrosoft },
+};
+static int vendorDecoderCount = 2;
+static bool vendorDecodersLocked = false;
+
+void lockVendorDecoders() {
+    vendorDecodersLocked = true;
+}
+
+bool registerVendorDecoder(uint16_t companyId, VendorDecoder decoder) {
+    if (vendorDecodersLocked) return false;  // Ingest-Task liest die Tabelle ohne Sperre
+    for (int i = 0; i < vendorDecoderCount; i++) {
+        if (vendorDecoders[i].companyId == companyId) {
+            vendorDecoders[i].decode = decoder;
+            return true;
+        }
+    }
+    if (vendorDecoderCount >= MAX_VENDOR_DECODERS) return false;
+    vendorDecoders[vendorDecoderCount].companyId = companyId;
+    vendorDecoders[vendorDecoderCount].decode = decoder;
+    vendorDecoderCount++;
+    return true;
+}
+
+const char* decodeVendorPayload(uint16_t companyId, const uint8_t* data, size_t length) {
+    for (int i = 0; i < vendorDecoderCount; i++) {
+        if (vendorDecoders[i].companyId == companyId) {
+            return vendorDecoders[i].decode ? vendorDecoders[i].decode(data, length) : nullptr;
+        }
+    }
+    return nullptr;
+}
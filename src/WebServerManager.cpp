@@ -7,7 +7,7 @@
 
 extern WiFiManager wifiManager;
 
-WebServerManager::WebServerManager() : server(nullptr), setupServer(nullptr), dnsServer(nullptr), deviceManager(nullptr), bluetoothScanner(nullptr), modeManager(nullptr), isRunning(false), setupServerStarted(false), isInSecureMode(false), setupComplete(false) {}
+WebServerManager::WebServerManager() : server(nullptr), setupServer(nullptr), dnsServer(nullptr), deviceManager(nullptr), bluetoothScanner(nullptr), modeManager(nullptr), presenceRelay(nullptr), isRunning(false), setupServerStarted(false), isInSecureMode(false), setupComplete(false) {}
 
 WebServerManager::~WebServerManager() { end(); }
 
@@ -101,18 +101,32 @@ void WebServerManager::setupMainServerRoutes() {
         handleDevicesAPI(request);
     });
     
+    server->on("/api/stats", HTTP_GET, [this](AsyncWebServerRequest *request){
+        handleStatsAPI(request);
+    });
+    
     server->on("/api/output-log", HTTP_GET, [this](AsyncWebServerRequest *request){
-        String logJson = deviceManager->getOutputLogJson();
+        String logJson;
+        {
+            DeviceManager::Lock lock(*deviceManager);
+            logJson = deviceManager->getOutputLogJson();
+        }
         request->send(200, "application/json", logJson);
     });
     
     server->on("/api/output-log/clear", HTTP_POST, [this](AsyncWebServerRequest *request){
-        deviceManager->clearOutputLog();
+        {
+            DeviceManager::Lock lock(*deviceManager);
+            deviceManager->clearOutputLog();
+        }
         sendJSONResponse(request, "success", "Output-Log gelöscht");
     });
     // Test-Endpoint für Output-Log
     server->on("/api/output-log/test", HTTP_POST, [this](AsyncWebServerRequest *request){
-        deviceManager->logOutputChange("", "System", "Test", true, "Test-Logeintrag erstellt");
+        {
+            DeviceManager::Lock lock(*deviceManager);
+            deviceManager->logOutputChange("", "System", "Test", true, "Test-Logeintrag erstellt");
+        }
         sendJSONResponse(request, "success", "Test-Logeintrag erstellt");
     });
     
@@ -157,39 +171,13 @@ void WebServerManager::setupMainServerRoutes() {
     // Loxone API Endpunkte
     server->on("/loxone/presence", HTTP_GET, [this](AsyncWebServerRequest *request){
         // Text: "present" oder "absent"
-        bool present = false;
-        SafeDevice* devices = deviceManager->getDevices();
-        int knownCount = deviceManager->getKnownCount();
-        int* thresholds = deviceManager->getKnownRSSIThresholds();
-        char (*macs)[18] = deviceManager->getKnownMACs();
-        for (int i = 0; i < knownCount; i++) {
-            for (int j = 0; j < deviceManager->getDeviceCount(); j++) {
-                if (strcmp(devices[j].address, macs[i]) == 0 && devices[j].isActive && devices[j].rssi >= thresholds[i]) {
-                    present = true;
-                    break;
-                }
-            }
-            if (present) break;
-        }
+        bool present = deviceManager->getPresentCount() > 0;  // ein Zähler, keine Sperre nötig
         request->send(200, "text/plain", present ? "present" : "absent");
     });
 
     server->on("/loxone/presence_num", HTTP_GET, [this](AsyncWebServerRequest *request){
         // Numeric: 1 = present, 0 = absent
-        bool present = false;
-        SafeDevice* devices = deviceManager->getDevices();
-        int knownCount = deviceManager->getKnownCount();
-        int* thresholds = deviceManager->getKnownRSSIThresholds();
-        char (*macs)[18] = deviceManager->getKnownMACs();
-        for (int i = 0; i < knownCount; i++) {
-            for (int j = 0; j < deviceManager->getDeviceCount(); j++) {
-                if (strcmp(devices[j].address, macs[i]) == 0 && devices[j].isActive && devices[j].rssi >= thresholds[i]) {
-                    present = true;
-                    break;
-                }
-            }
-            if (present) break;
-        }
+        bool present = deviceManager->getPresentCount() > 0;  // ein Zähler, keine Sperre nötig
         request->send(200, "text/plain", present ? "1" : "0");
     });
 
@@ -212,19 +200,13 @@ void WebServerManager::setupMainServerRoutes() {
             return;
         }
         String address = request->getParam("address")->value();
-        SafeDevice* devices = deviceManager->getDevices();
-        int found = -1;
-        for (int i = 0; i < deviceManager->getDeviceCount(); i++) {
-            if (address.equalsIgnoreCase(devices[i].address)) {
-                found = i;
-                break;
-            }
-        }
-        if (found == -1) {
+        DeviceManager::Snapshot snapshot(*deviceManager);
+        int deviceIndex = snapshot->find(address.c_str());
+        if (deviceIndex < 0) {
             request->send(200, "text/plain", "unknown");
             return;
         }
-        bool present = devices[found].isActive && devices[found].isKnown && devices[found].rssi >= devices[found].rssiThreshold;
+        bool present = snapshot->hot[deviceIndex].isPresent();
         request->send(200, "text/plain", present ? "present" : "absent");
     });
 
@@ -235,19 +217,13 @@ void WebServerManager::setupMainServerRoutes() {
             return;
         }
         String address = request->getParam("address")->value();
-        SafeDevice* devices = deviceManager->getDevices();
-        int found = -1;
-        for (int i = 0; i < deviceManager->getDeviceCount(); i++) {
-            if (address.equalsIgnoreCase(devices[i].address)) {
-                found = i;
-                break;
-            }
-        }
-        if (found == -1) {
+        DeviceManager::Snapshot snapshot(*deviceManager);
+        int deviceIndex = snapshot->find(address.c_str());
+        if (deviceIndex < 0) {
             request->send(200, "text/plain", "-1");
             return;
         }
-        bool present = devices[found].isActive && devices[found].isKnown && devices[found].rssi >= devices[found].rssiThreshold;
+        bool present = snapshot->hot[deviceIndex].isPresent();
         request->send(200, "text/plain", present ? "1" : "0");
     });
 }
@@ -274,44 +250,34 @@ void WebServerManager::handleScanNetworks(AsyncWebServerRequest *request) {
     request->send(response);
 }
 
-String WebServerManager::formatRelativeTime(unsigned long seconds) {
+void WebServerManager::formatRelativeTime(unsigned long seconds, char* out, size_t outSize) {
     if (seconds < 60) {
-        return String(seconds) + "s";
+        snprintf(out, outSize, "%lus", seconds);
     } else if (seconds < 3600) {
-        return String(seconds / 60) + "m " + String(seconds % 60) + "s";
+        snprintf(out, outSize, "%lum %lus", seconds / 60, seconds % 60);
     } else {
         unsigned long hours = seconds / 3600;
         unsigned long minutes = (seconds % 3600) / 60;
-        return String(hours) + "h " + String(minutes) + "m";
-    }
-}
-
-void WebServerManager::updateAllDeviceStatus() {
-    // Alle aktiven Geräte durchgehen und Known-Status aktualisieren
-    SafeDevice* devices = deviceManager->getDevices();
-    int deviceCount = deviceManager->getDeviceCount();
-    
-    for (int i = 0; i < deviceCount; i++) {
-        if (devices[i].isActive) {
-            bool wasKnown = devices[i].isKnown;
-            bool isNowKnown = deviceManager->isKnownDevice(devices[i].address);
-            
-            if (wasKnown != isNowKnown) {
-                // Status hat sich geändert - Device vollständig aktualisieren
-                deviceManager->updateDevice(devices[i].address, devices[i].name, devices[i].rssi);
-            }
-        }
+        snprintf(out, outSize, "%luh %lum", hours, minutes);
     }
 }
 
 void WebServerManager::handleStatusAPI(AsyncWebServerRequest *request) {
     JsonDocument doc;
-    unsigned long uptimeSeconds = millis() / 1000;
-    doc["uptime"] = formatRelativeTime(uptimeSeconds);
-    doc["devices_ever"] = deviceManager->getTotalEverSeen();  // Geräte total ever
-    doc["devices"] = deviceManager->getActiveCount();  // Aktiv (current seen)
+    char uptime[24];
+    formatRelativeTime(millis() / 1000, uptime, sizeof(uptime));
+    doc["uptime"] = uptime;
+    {
+        // Zähler aus einem Stand, ohne den Ingest-Task aufzuhalten
+        DeviceManager::Snapshot snapshot(*deviceManager);
+        doc["devices_ever"] = snapshot->totalEverSeen;  // Geräte total ever
+        doc["devices"] = snapshot->activeCount;  // Aktiv (current seen)
+        doc["present"] = snapshot->presentCount;  // Anwesend (seen+near)
+        doc["evictions"] = snapshot->evictionCount;  // Verdrängte unbekannte Geräte (Tabelle voll)
+        doc["snapshot_epoch"] = snapshot->epoch;
+    }
     doc["known"] = deviceManager->getKnownCount();  // Bekannt (saved)
-    doc["present"] = deviceManager->getPresentCount();  // Anwesend (seen+near)
+    doc["ring_drops"] = bluetoothScanner->getRingDropCount();  // Advertisement-Ring voll (Ingest-Task zu langsam)
     doc["wifi_connected"] = wifiManager.isConnected();
     doc["wifi_ssid"] = wifiManager.getSSID();
     doc["wifi_rssi"] = WiFi.isConnected() ? WiFi.RSSI() : 0;
@@ -321,54 +287,100 @@ void WebServerManager::handleStatusAPI(AsyncWebServerRequest *request) {
     doc["wifi_dns"] = WiFi.isConnected() ? WiFi.dnsIP().toString() : "";
     doc["wifi_mode"] = wifiManager.isConnected() ? "Station" : (wifiManager.isInAPMode() ? "Access Point" : "---");
     doc["heap_free"] = ESP.getFreeHeap();
+    doc["heap_min_free"] = ESP.getMinFreeHeap();  // Tiefststand seit Start (Spitzenlast, z.B. dichtes Scan-Fenster)
     
     // Neue Status-Informationen hinzufügen
     doc["scanning"] = bluetoothScanner->isScanning();
     doc["outputActive"] = digitalRead(LED_BUILTIN_PIN) == LOW; // LED AN = LOW wegen invertierter Logik
     
+    // Advertisement bis Relais geschaltet (Relais-Task)
+    if (presenceRelay) {
+        LatencyHistogram latency = presenceRelay->getLatency();  // Kopie, der Relais-Task schreibt weiter
+        JsonObject relay = doc["relay_latency_us"].to<JsonObject>();
+        relay["count"] = latency.count;
+        relay["p50"] = latency.percentile(0.50f);
+        relay["p99"] = latency.percentile(0.99f);
+        relay["max"] = latency.maxMicros;
+        relay["task"] = presenceRelay->hasTask();
+    }
+    
     AsyncResponseStream *response = request->beginResponseStream("application/json");
     response->addHeader("Connection", "close");
     serializeJson(doc, *response);
     request->send(response);
 }
 
+void WebServerManager::handleStatsAPI(AsyncWebServerRequest *request) {
+    // Kompakt: eine Zeile pro Gerät als Array, direkt in den Antwort-Stream (ohne JsonDocument)
+    DeviceManager::Snapshot snapshot(*deviceManager);
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->addHeader("Connection", "close");
+    response->printf("{\"epoch\":%u,\"fields\":[\"address\",\"packets\",\"interval_ms\",\"interval_sd_ms\","
+                     "\"rssi_min\",\"rssi_max\",\"absence_ms\",\"active\"],\"devices\":[", (unsigned)snapshot->epoch);
+    for (int i = 0; i < snapshot->deviceCount; i++) {
+        const DeviceHot& device = snapshot->hot[i];
+        const DeviceStats& stats = snapshot->stats[i];
+        char address[18];
+        formatMacKey(device.key(), address);
+        unsigned mean = stats.intervals > 0 ? (unsigned)stats.meanIntervalMs() : 0;
+        unsigned deviation = stats.intervals > 0 ? (unsigned)stats.intervalStdDevMs() : 0;
+        response->printf("%s[\"%s\",%u,%u,%u,%d,%d,%u,%d]", i > 0 ? "," : "", address, (unsigned)stats.packets,
+                         mean, deviation, stats.rssiMin, stats.rssiMax, (unsigned)stats.absenceTimeoutMs(snapshot->absenceMinMs),
+                         device.isActive() ? 1 : 0);
+    }
+    response->print("]}");
+    request->send(response);
+}
+
 void WebServerManager::handleDevicesAPI(AsyncWebServerRequest *request) {
     JsonDocument doc;
     doc["status"] = "success";
     
+    // Veröffentlichter Stand der Gerätetabelle, ohne Sperre; die Known-Liste
+    // schreiben nur Web-Handler und ist aus diesem Task direkt lesbar
+    DeviceManager::Snapshot snapshot(*deviceManager);
+    
     // Aktive/gefundene Geräte
     JsonArray deviceArray = doc["devices"].to<JsonArray>();
-    SafeDevice* devices = deviceManager->getDevices();
+    SafeDevice entry;  // Cold-Daten werden pro Zeile zusammengesetzt
     unsigned long now = millis();
     
-    for (int i = 0; i < deviceManager->getDeviceCount(); i++) {
+    for (int i = 0; i < snapshot->deviceCount; i++) {
+        if (!deviceManager->getDevice(*snapshot, i, entry)) continue;
         JsonObject device = deviceArray.add<JsonObject>();
-        device["address"] = devices[i].address;
-        device["name"] = devices[i].name;
-        device["rssi"] = devices[i].rssi;
-        device["known"] = devices[i].isKnown;
-        device["active"] = devices[i].isActive;
+        device["address"] = entry.address;
+        device["name"] = entry.name;
+        device["rssi"] = entry.rssi;
+        device["rssiFiltered"] = entry.rssiFiltered;
+        device["known"] = entry.isKnown;
+        device["active"] = entry.isActive;
         
-        // Relative lastSeen Zeit
-        if (devices[i].lastSeen > 0) {
-            unsigned long ageSeconds = (now - devices[i].lastSeen) / 1000;
-            device["lastSeenRelative"] = "vor " + formatRelativeTime(ageSeconds);
+        // Relative lastSeen Zeit (einzige Stelle, an der sie formatiert wird)
+        if (entry.lastSeen > 0) {
+            char relative[28] = "vor ";
+            formatRelativeTime((now - entry.lastSeen) / 1000, relative + 4, sizeof(relative) - 4);
+            device["lastSeenRelative"] = relative;
         } else {
             device["lastSeenRelative"] = "nie";
         }
         
-        device["manufacturer"] = devices[i].manufacturer;
-        device["payloadHex"] = devices[i].payloadHex;
-        device["comment"] = devices[i].comment;
-        device["rssiThreshold"] = devices[i].rssiThreshold;
+        device["manufacturer"] = entry.manufacturer;
+        device["payloadHex"] = entry.payloadHex;
+        device["comment"] = entry.comment;
+        device["rssiThreshold"] = entry.rssiThreshold;
+        device["packets"] = entry.packets;
+        device["intervalMs"] = entry.intervalMeanMs;
+        device["intervalSdMs"] = entry.intervalStdDevMs;
+        device["rssiMin"] = entry.rssiMin;
+        device["rssiMax"] = entry.rssiMax;
+        device["absenceMs"] = entry.absenceTimeoutMs;
         
         // Proximity Status: green (nahe genug), yellow (nah aber nicht nah genug), red (nicht sichtbar)
         String proximityStatus = "red";
-        if (devices[i].isActive) {
-            // Für bekannte Geräte: individueller Schwellwert
-            // Für unbekannte Geräte: Standard-Schwellwert
-            int threshold = devices[i].isKnown ? devices[i].rssiThreshold : DEFAULT_RSSI_THRESHOLD;
-            if (devices[i].rssi >= threshold) {
+        if (entry.isActive) {
+            // Geglätteter RSSI mit Hysterese gegen den Schwellwert (bekannt: individuell,
+            // unbekannt: Standard) - ein einzelnes schwaches Paket schaltet nicht um
+            if (entry.isNearby) {
                 proximityStatus = "green"; // Nahe genug
             } else {
                 proximityStatus = "yellow"; // Nah aber nicht nah genug
@@ -379,15 +391,24 @@ void WebServerManager::handleDevicesAPI(AsyncWebServerRequest *request) {
     
     // Bekannte Geräte (auch wenn nicht anwesend)
     JsonArray knownArray = doc["knownDevices"].to<JsonArray>();
-    char (*knownMACs)[18] = deviceManager->getKnownMACs();
+    const MacKey* knownKeys = deviceManager->getKnownKeys();
     char (*knownComments)[MAX_COMMENT_LENGTH] = deviceManager->getKnownComments();
-    int* knownThresholds = deviceManager->getKnownRSSIThresholds();
+    const int8_t* knownThresholds = deviceManager->getKnownRSSIThresholds();
+    const PresenceTuning* knownTunings = deviceManager->getKnownTunings();
     
     for (int i = 0; i < deviceManager->getKnownCount(); i++) {
+        char address[18];
+        formatMacKey(knownKeys[i], address);
         JsonObject knownDevice = knownArray.add<JsonObject>();
-        knownDevice["address"] = knownMACs[i];
+        knownDevice["address"] = address;
         knownDevice["comment"] = knownComments[i];
-        knownDevice["rssiThreshold"] = knownThresholds[i];
+        knownDevice["rssiThreshold"] = (int)knownThresholds[i];
+        const PresenceTuning& tuning = knownTunings[i];
+        knownDevice["enterMargin"] = tuning.enterMargin;
+        knownDevice["exitMargin"] = tuning.exitMargin;
+        knownDevice["filterShift"] = tuning.filterShift;
+        knownDevice["enterDwellMs"] = tuning.enterDwellMs;
+        knownDevice["exitDwellMs"] = tuning.exitDwellMs;
         
         // Prüfe ob Gerät aktuell anwesend ist (nur wenn im grünen Proximity-Bereich)
         bool present = false;
@@ -395,23 +416,22 @@ void WebServerManager::handleDevicesAPI(AsyncWebServerRequest *request) {
         int currentRSSI = -999;
         String proximityStatus = "red";
         
-        for (int j = 0; j < deviceManager->getDeviceCount(); j++) {
-            if (strcmp(devices[j].address, knownMACs[i]) == 0) {
-                currentName = devices[j].name;
-                currentRSSI = devices[j].rssi;
-                if (devices[j].isActive) {
-                    if (devices[j].rssi >= knownThresholds[i]) {
-                        proximityStatus = "green";
-                        present = true; // ✅ Nur als anwesend gelten wenn nah genug!
-                    } else {
-                        proximityStatus = "yellow";
-                        // present bleibt false - zu weit weg!
-                    }
+        int deviceIndex = snapshot->find(knownKeys[i]);
+        if (deviceIndex >= 0) {
+            const DeviceHot& device = snapshot->hot[deviceIndex];
+            currentName = snapshot->cold[deviceIndex].name;
+            currentRSSI = device.rssi;
+            if (device.isActive()) {
+                if (device.isNearby()) {
+                    proximityStatus = "green";
+                    present = true; // ✅ Nur als anwesend gelten wenn nah genug!
                 } else {
-                    proximityStatus = "red";
-                    // present bleibt false - nicht aktiv
+                    proximityStatus = "yellow";
+                    // present bleibt false - zu weit weg!
                 }
-                break;
+            } else {
+                proximityStatus = "red";
+                // present bleibt false - nicht aktiv
             }
         }
         
@@ -444,6 +464,10 @@ void WebServerManager::handleFactoryReset(AsyncWebServerRequest *request) {
 }
 
 void WebServerManager::handleSystemReboot(AsyncWebServerRequest *request) {
+    // Noch nicht geschriebene Änderungen der Known-Liste vor dem Neustart sichern
+    // (sperrt die Tabelle selbst nur zum Kopieren)
+    deviceManager->flushKnownDevices(true);
+    
     JsonDocument doc;
     doc["status"] = "success";
     doc["message"] = "Neustart wird durchgeführt...";
@@ -486,17 +510,27 @@ void WebServerManager::handleSetKnownDevice(AsyncWebServerRequest *request) {
     String comment = request->hasParam("comment") ? request->getParam("comment")->value() : "";
     int rssiThreshold = request->hasParam("rssiThreshold") ? request->getParam("rssiThreshold")->value().toInt() : -70;
     
+    DeviceManager::Lock lock(*deviceManager);
     bool success = false;
     if (isKnown) {
-        success = deviceManager->addKnownDevice(address.c_str(), comment.c_str(), rssiThreshold) >= 0;
+        // Glättung/Hysterese optional; fehlende Parameter behalten den bisherigen Wert
+        PresenceTuning tuning;
+        deviceManager->getKnownTuning(address.c_str(), tuning);
+        bool tuningGiven = false;
+        if (request->hasParam("enterMargin")) { tuning.enterMargin = constrain(request->getParam("enterMargin")->value().toInt(), -30, 30); tuningGiven = true; }
+        if (request->hasParam("exitMargin")) { tuning.exitMargin = constrain(request->getParam("exitMargin")->value().toInt(), -30, 30); tuningGiven = true; }
+        if (request->hasParam("filterShift")) { tuning.filterShift = constrain(request->getParam("filterShift")->value().toInt(), 0, 6); tuningGiven = true; }
+        if (request->hasParam("enterDwellMs")) { tuning.enterDwellMs = constrain(request->getParam("enterDwellMs")->value().toInt(), 0, PRESENCE_MAX_DWELL_MS); tuningGiven = true; }
+        if (request->hasParam("exitDwellMs")) { tuning.exitDwellMs = constrain(request->getParam("exitDwellMs")->value().toInt(), 0, PRESENCE_MAX_DWELL_MS); tuningGiven = true; }
+        success = deviceManager->addKnownDevice(address.c_str(), comment.c_str(), rssiThreshold, tuningGiven ? &tuning : nullptr) >= 0;
     } else {
         success = deviceManager->removeKnownDevice(address.c_str());
     }
     
     if (success) {
-        deviceManager->saveKnownDevices();
-        // Sofortige Aktualisierung aller Device-Status
-        updateAllDeviceStatus();
+        // Known-Status der Gerätetabelle aktualisiert der DeviceManager selbst; die Änderung
+        // landet nach KNOWN_FLUSH_DELAY_MS als Journal-Eintrag in NVS
+        deviceManager->publishSnapshot();  // Known-Status sofort für Leser sichtbar
         sendJSONResponse(request, "success", isKnown ? "Gerät als bekannt markiert" : "Gerät als unbekannt markiert");
     } else {
         sendJSONResponse(request, "error", "Vorgang fehlgeschlagen");
@@ -504,12 +538,16 @@ void WebServerManager::handleSetKnownDevice(AsyncWebServerRequest *request) {
 }
 
 void WebServerManager::handleExportDevicesFile(AsyncWebServerRequest *request) {
-    String jsonData = deviceManager->exportDevicesJson();
-    
-    // Log Export
-    char logMsg[80];
-    snprintf(logMsg, sizeof(logMsg), "📤 Export: %d Geräte exportiert", deviceManager->getKnownCount());
-    deviceManager->logOutputChange("", "", "", false, logMsg);
+    String jsonData;
+    {
+        DeviceManager::Lock lock(*deviceManager);
+        jsonData = deviceManager->exportDevicesJson();
+        
+        // Log Export
+        char logMsg[80];
+        snprintf(logMsg, sizeof(logMsg), "📤 Export: %d Geräte exportiert", deviceManager->getKnownCount());
+        deviceManager->logOutputChange("", "", "", false, logMsg);
+    }
     
     request->send(200, "application/json", jsonData);
 }
@@ -529,7 +567,13 @@ void WebServerManager::handleImportDevicesFile(AsyncWebServerRequest *request, u
     
     // Verarbeite nur wenn alle Daten empfangen wurden
     if (index + len == total) {
-        bool success = deviceManager->importDevicesJson(*bodyBuffer);
+        bool success;
+        {
+            DeviceManager::Lock lock(*deviceManager);
+            success = deviceManager->importDevicesJson(*bodyBuffer);
+            deviceManager->publishSnapshot();
+        }
+        deviceManager->flushKnownDevices(true);  // ganzer Import als ein Schreibzugriff, außerhalb der Sperre
         
         if (success) {
             sendJSONResponse(request, "success", "Geräte erfolgreich importiert");
@@ -17,6 +17,7 @@
 #include "DeviceModeManager.h"
 #include "BeaconManager.h"
 #include "DeviceManager.h"
+#include "PresenceRelay.h"
 #include "BluetoothScanner.h"
 #include "WiFiManager.h"
 #include "WebServerManager.h"
@@ -28,9 +29,13 @@ DeviceManager deviceManager;
 BluetoothScanner bluetoothScanner;
 WiFiManager wifiManager;
 WebServerManager webServerManager;
+PresenceRelay presenceRelay;
+TaskHandle_t relayTaskHandle = nullptr;
+TaskHandle_t ingestTaskHandle = nullptr;
 
-// Global device array (nur für Scanner-Modus)
-SafeDevice devices[MAX_DEVICES];
+// Global device table (nur für Scanner-Modus): Hot-Records + Cold-Daten
+DeviceHot deviceTable[MAX_DEVICES];
+DeviceCold deviceDetails[MAX_DEVICES];
 
 // Global state
 bool systemInitialized = false;
@@ -45,6 +50,8 @@ void setPresenceOutput(bool devicePresent);
 void setPresenceOutput(bool devicePresent, const char* triggerDevice, const char* triggerName, const char* triggerComment);
 void updateLEDStatus();
 void enterSetupPortal();
+void startRelayTask();
+void startIngestTask();
 
 void setup() {
     // Initialize GPIO (common for both modes)
@@ -140,16 +147,22 @@ void setup() {
     initializeWatchdog();
     
     // Initialize device arrays
-    memset(devices, 0, sizeof(devices));
+    memset(deviceTable, 0, sizeof(deviceTable));
+    memset(deviceDetails, 0, sizeof(deviceDetails));
     
     // Initialize modules
-    deviceManager.begin(devices, MAX_DEVICES);
+    deviceManager.begin(deviceTable, deviceDetails, MAX_DEVICES);
+    presenceRelay.begin(&deviceManager, RELAY_OUTPUT_PIN, LED_BUILTIN_PIN);
+    if (RELAY_EVENT_TASK) {
+        startRelayTask();
+    }
     
     if (!wifiManager.begin()) {
         // WiFi init failed - continue anyway
     }
     
     webServerManager.setModeManager(&modeManager);  // Pass mode manager for config
+    webServerManager.setPresenceRelay(&presenceRelay);
     if (!webServerManager.begin(&deviceManager, &bluetoothScanner)) {
         // Web server init failed
     }
@@ -159,6 +172,9 @@ void setup() {
         if (!bluetoothScanner.begin(&deviceManager)) {
             // BLE init failed
         }
+        if (INGEST_TASK) {
+            startIngestTask();
+        }
     }
     
     systemInitialized = true;
@@ -212,7 +228,14 @@ void loop() {
     // Bluetooth scanning only in secure mode
     if (systemInitialized && wifiManager.isSecure() && bluetoothScanner.isInitialized()) {
         bluetoothScanner.performAutomaticScanCycle();  // Automatischer 2s/8s Zyklus
+        if (!bluetoothScanner.hasIngestTask()) {
+            bluetoothScanner.processPending();  // Fallback: loop() besitzt die Gerätetabelle
+        }
         updateLEDStatus();
+        
+        // NVS-Schreibzugriffe hier statt im Ingest-Task; beide drosseln sich selbst
+        deviceManager.flushKnownDevices();
+        deviceManager.checkpointEverSeen();
     }
     
     delay(100); // Small pause for task switching
@@ -270,41 +293,82 @@ void setPresenceOutput(bool devicePresent, const char* triggerDevice, const char
         );
     }
     
-    // LED: inverted logic (LOW = ON, HIGH = OFF)
-    digitalWrite(LED_BUILTIN_PIN, devicePresent ? LOW : HIGH);
-    
-    // Relay: normal logic (HIGH = ON, LOW = OFF)
-    digitalWrite(RELAY_OUTPUT_PIN, devicePresent ? HIGH : LOW);
+    // LED und Relais schaltet PresenceRelay (Relais-Task oder direkt, falls kein Task läuft).
+    // Advertisement-Wechsel sind dort meist schon angekommen; hier landen Timeouts und Known-Liste.
+    if (presenceRelay.getOutputState() != devicePresent) {
+        presenceRelay.wake();
+    }
 }
 
 void updateLEDStatus() {
     if (!ledInitialized) return;
     
-    bool anyKnownPresent = false;
-    SafeDevice* devices = deviceManager.getDevices();
-    int deviceCount = deviceManager.getDeviceCount();
+    // Namen und Kommentar des Auslösers nur unter der Tabellen-Sperre lesen
+    DeviceManager::Lock lock(deviceManager);
     
     // Finde das Gerät das die Schaltung verursacht
-    const char* triggerDevice = "";
-    const char* triggerName = "";
-    const char* triggerComment = "";
-    
-    // LED nur AN wenn bekanntes Gerät im grünen Proximity-Bereich ist
-    for (int i = 0; i < deviceCount; i++) {
-        if (devices[i].isActive && devices[i].isKnown) {
-            // Prüfe ob Gerät nah genug ist (grüner Proximity)
-            if (devices[i].rssi >= devices[i].rssiThreshold) {
-                anyKnownPresent = true;
-                triggerDevice = devices[i].address;
-                triggerName = devices[i].name;
-                triggerComment = devices[i].comment;
-                break;  // Erstes gefundenes Gerät verwenden
-            }
-        }
+    int trigger = deviceManager.getPresenceTrigger();  // O(1), wird bei jedem Advertisement nachgeführt
+    bool anyKnownPresent = (trigger >= 0);
+    
+    char triggerAddress[18] = "";
+    if (anyKnownPresent) {
+        deviceManager.formatDeviceAddress(trigger, triggerAddress);
     }
     
     knownDevicesPresent = anyKnownPresent;
-    setPresenceOutput(anyKnownPresent, triggerDevice, triggerName, triggerComment);
+    setPresenceOutput(anyKnownPresent,
+                      triggerAddress,
+                      anyKnownPresent ? deviceManager.getDeviceName(trigger) : "",
+                      anyKnownPresent ? deviceManager.getDeviceComment(trigger) : "");
+}
+
+// Relais-Task: wartet auf ein Anwesenheitsereignis und schaltet sofort
+void relayTask(void* parameter) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        presenceRelay.process();
+    }
+}
+
+void wakeRelayTask(void* context) {
+    xTaskNotifyGive(relayTaskHandle);
+}
+
+// Läuft im Ingest-Task, sobald sich das auslösende Gerät ändert
+void onPresenceChanged(int triggerIndex, bool fromAdvertisement, void* context) {
+    // Timeouts und Known-Liste kommen nicht hierher, sondern über updateLEDStatus() im
+    // nächsten loop()-Durchlauf (bis zu 100 ms später)
+    if (fromAdvertisement) {
+        // einziger Erzeuger der Warteschlange; Latenz ab Empfang im BLE-Callback
+        presenceRelay.post(triggerIndex, bluetoothScanner.getCurrentAdvertMicros());
+    }
+}
+
+void startRelayTask() {
+    if (xTaskCreate(relayTask, "relay", RELAY_TASK_STACK_SIZE, nullptr, RELAY_TASK_PRIORITY, &relayTaskHandle) != pdPASS) {
+        return;  // Fallback: updateLEDStatus() schaltet wie bisher aus loop()
+    }
+    presenceRelay.setWakeup(wakeRelayTask);
+    deviceManager.setPresenceListener(onPresenceChanged);
+}
+
+// Ingest-Task: besitzt die Gerätetabelle und leert den Advertisement-Ring des BLE-Callbacks
+void ingestTask(void* parameter) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(INGEST_IDLE_MS));
+        bluetoothScanner.processPending();
+    }
+}
+
+void wakeIngestTask(void* context) {
+    xTaskNotifyGive(ingestTaskHandle);
+}
+
+void startIngestTask() {
+    if (xTaskCreate(ingestTask, "ingest", INGEST_TASK_STACK_SIZE, nullptr, INGEST_TASK_PRIORITY, &ingestTaskHandle) != pdPASS) {
+        return;  // Fallback: loop() leert den Ring
+    }
+    bluetoothScanner.setIngestWakeup(wakeIngestTask);
 }
 
 void enterSetupPortal() {